@@ -0,0 +1,87 @@
+#include "BenchSupport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> g_allocations{0};
+
+void* countedAlloc(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+} // namespace
+
+// 전역 할당 함수 교체: 호출 횟수만 세고 실제 할당은 malloc에 맡깁니다.
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace bench {
+
+std::uint64_t allocationCount() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+LatencySummary summarize(std::vector<std::int64_t> samplesNs) {
+    LatencySummary summary;
+    summary.count = samplesNs.size();
+    if (samplesNs.empty()) {
+        return summary;
+    }
+    std::sort(samplesNs.begin(), samplesNs.end());
+    auto rank = [&](double p) {
+        std::size_t index = static_cast<std::size_t>(std::ceil(p * samplesNs.size()));
+        index = std::min(std::max<std::size_t>(index, 1), samplesNs.size()) - 1;
+        return samplesNs[index] / 1000.0;
+    };
+    summary.p50Us = rank(0.50);
+    summary.p99Us = rank(0.99);
+    summary.p999Us = rank(0.999);
+    summary.maxUs = samplesNs.back() / 1000.0;
+    return summary;
+}
+
+std::string option(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+    const std::string flag = "--" + name;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == flag) {
+            return "1";
+        }
+        if (arg.compare(0, flag.size() + 1, flag + "=") == 0) {
+            return arg.substr(flag.size() + 1);
+        }
+    }
+    return defaultValue;
+}
+
+} // namespace bench
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 벤치마크 실행 파일이 공통으로 쓰는 측정 도구입니다.
+ * BenchSupport.cpp는 전역 operator new/delete를 교체해 힙 할당 횟수를 세므로,
+ * 벤치마크 실행 파일마다 정확히 한 번만 링크해야 합니다.
+ */
+namespace bench {
+
+/**
+ * @brief 프로세스 시작 이후 operator new가 호출된 총 횟수를 반환합니다. (모든 스레드 합계)
+ * 측정 구간 앞뒤의 차이로 구간 내 할당 횟수를 구합니다.
+ */
+std::uint64_t allocationCount();
+
+/**
+ * @brief 지연 시간 표본의 요약 통계 (마이크로초 단위).
+ */
+struct LatencySummary {
+    std::size_t count = 0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double p999Us = 0.0;
+    double maxUs = 0.0;
+};
+
+/**
+ * @brief 나노초 단위 지연 시간 표본에서 백분위수를 계산합니다. (nearest-rank 방식)
+ * @param samplesNs 지연 시간 표본. 정렬을 위해 값으로 받습니다.
+ */
+LatencySummary summarize(std::vector<std::int64_t> samplesNs);
+
+/**
+ * @brief "--name=value" 형식의 명령행 인자를 찾아 값을 반환합니다. 없으면 기본값을 반환합니다.
+ * "--name"만 주어지면 "1"을 반환하므로 on/off 옵션에도 사용할 수 있습니다.
+ */
+std::string option(int argc, char* argv[], const std::string& name, const std::string& defaultValue);
+
+} // namespace bench
@@ -0,0 +1,121 @@
+// DistanceKernel / DistanceService 마이크로벤치마크
+//
+// 자판기 수를 8대부터 10만 대까지 늘리며 다음을 측정합니다.
+//  - 거리 제곱 커널(scalar, sse4.1, avx2)의 원소당 시간
+//  - 공간 색인 조회 findNearestWithStock의 호출당 시간 (색인에는 재고 있는 자판기가 절반)
+//  - 응답 목록을 한 번 훑는 findNearestAvailableVendingMachine의 호출당 시간
+// 이 CPU가 지원하지 않는 커널은 "-"로 표시합니다.
+//
+// 사용법: distance_bench.out [--queries=2000] [--seed=7]
+
+#include "BenchSupport.hpp"
+
+#include "domain/vendingMachine.h"
+#include "service/DistanceKernel.hpp"
+#include "service/DistanceService.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using service::DistanceKernel;
+
+// 컴파일러가 측정 대상 호출을 없애지 못하도록 결과를 여기에 누적합니다.
+volatile std::uint64_t g_sink = 0;
+
+template <typename Op>
+double nsPerCall(std::size_t iterations, Op&& op) {
+    std::uint64_t sink = 0;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink += op(i);
+    }
+    const auto elapsed = Clock::now() - start;
+    g_sink = g_sink + sink;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+void formatNs(char* buf, std::size_t size, bool supported, double ns) {
+    if (!supported) {
+        std::snprintf(buf, size, "-");
+        return;
+    }
+    std::snprintf(buf, size, "%.3f", ns);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t queries = std::stoul(bench::option(argc, argv, "queries", "2000"));
+    const unsigned seed = static_cast<unsigned>(std::stoul(bench::option(argc, argv, "seed", "7")));
+    if (queries == 0) {
+        std::fprintf(stderr, "오류: queries는 1 이상이어야 합니다.\n");
+        return 1;
+    }
+
+    std::printf("active kernel: %s\n", DistanceKernel::isaName(DistanceKernel::activeIsa()));
+    std::printf("%8s %14s %14s %14s %16s %16s\n",
+                "machines", "scalar(ns/el)", "sse4.1(ns/el)", "avx2(ns/el)", "index(ns/query)", "list(ns/query)");
+
+    const DistanceKernel::Isa isas[] = {DistanceKernel::Isa::SCALAR, DistanceKernel::Isa::SSE41, DistanceKernel::Isa::AVX2};
+    for (std::size_t n : {std::size_t{8}, std::size_t{64}, std::size_t{1000}, std::size_t{10000}, std::size_t{100000}}) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> coord(0, service::DistanceService::COORD_LIMIT - 1);
+
+        std::vector<std::int32_t> xs(n);
+        std::vector<std::int32_t> ys(n);
+        std::vector<std::uint32_t> out(n);
+        std::vector<service::OtherVendingMachineInfo> list;
+        list.reserve(n);
+        service::DistanceService index;
+        for (std::size_t i = 0; i < n; ++i) {
+            xs[i] = coord(rng);
+            ys[i] = coord(rng);
+            const std::string id = "T" + std::to_string(i + 2);
+            const bool hasStock = (i % 2) == 0;
+            list.push_back({id, xs[i], ys[i], hasStock});
+            index.upsertMachine(id, xs[i], ys[i]);
+            index.setStock(id, "01", hasStock);
+        }
+        std::vector<std::pair<int, int>> points(queries);
+        for (auto& p : points) {
+            p = {coord(rng), coord(rng)};
+        }
+
+        // 커널은 원소 수와 관계없이 비슷한 총 작업량이 되도록 반복 횟수를 정합니다.
+        const std::size_t kernelIterations = std::max<std::size_t>(queries * 1000 / n, 10);
+        char kernelNs[3][32];
+        for (int k = 0; k < 3; ++k) {
+            const bool supported = DistanceKernel::isSupported(isas[k]);
+            double ns = 0.0;
+            if (supported) {
+                ns = nsPerCall(kernelIterations, [&](std::size_t i) {
+                    const auto& p = points[i % points.size()];
+                    DistanceKernel::squaredDistances(isas[k], xs.data(), ys.data(), n, p.first, p.second, out.data());
+                    return out[i % n];
+                }) / n;
+            }
+            formatNs(kernelNs[k], sizeof(kernelNs[k]), supported, ns);
+        }
+
+        const double indexNs = nsPerCall(queries, [&](std::size_t i) {
+            const auto& p = points[i];
+            return index.findNearestWithStock(p.first, p.second, "01", 1).size();
+        });
+        const std::size_t listQueries = std::max<std::size_t>(queries * 1000 / n, 1);
+        const double listNs = nsPerCall(std::min(listQueries, queries), [&](std::size_t i) {
+            const auto& p = points[i];
+            return index.findNearestAvailableVendingMachine(p.first, p.second, list).has_value() ? 1u : 0u;
+        });
+
+        std::printf("%8zu %14s %14s %14s %16.1f %16.1f\n", n, kernelNs[0], kernelNs[1], kernelNs[2], indexNs, listNs);
+    }
+    return 0;
+}
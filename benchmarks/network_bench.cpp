@@ -0,0 +1,279 @@
+// MessageSender/MessageReceiver 왕복 벤치마크
+//
+// 루프백에 수신기 N개를 띄우고 MessageSender와 MessageService로 메시지를 보내,
+// 전송 시작부터 (브로드캐스트는 마지막 수신기가) 메시지를 받을 때까지의 지연 시간과
+// 처리량, 메시지당 힙 할당 횟수(송신과 수신 양쪽 합계)를 측정합니다.
+//
+// 사용법: network_bench.out [--receivers=4] [--messages=20000] [--rate=0] [--threads=2]
+//                          [--port=24100] [--binary]
+//   --rate=0 은 속도 제한 없이 최대한 빨리 보냅니다.
+
+#include "BenchSupport.hpp"
+
+#include "network/MessageReceiver.hpp"
+#include "network/MessageSender.hpp"
+#include "network/message.hpp"
+#include "service/ErrorService.hpp"
+#include "service/MessageService.hpp"
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief 한 측정 회차의 전송/수신 시각을 기록합니다.
+ * 메시지의 item_code에 "회차:순번"을 실어 보내고, 모든 대상이 받은 시각을 완료 시각으로 봅니다.
+ * 수신 핸들러는 여러 I/O 스레드에서 동시에 호출되므로 모든 칸은 원자적으로 갱신하며,
+ * 이전 회차의 메시지가 늦게 도착해도 안전하도록 배열은 처음 한 번만 할당합니다.
+ */
+class Probe {
+public:
+    explicit Probe(std::size_t capacity)
+        : capacity_(capacity),
+          sentNs_(new std::atomic<std::int64_t>[capacity]),
+          doneNs_(new std::atomic<std::int64_t>[capacity]),
+          arrivals_(new std::atomic<std::uint32_t>[capacity]) {}
+
+    void reset(int round, std::size_t messages, std::size_t fanout) {
+        round_.store(-1);
+        messages_.store(std::min(messages, capacity_));
+        fanout_.store(static_cast<std::uint32_t>(fanout));
+        for (std::size_t i = 0; i < messages_.load(); ++i) {
+            sentNs_[i].store(0);
+            doneNs_[i].store(0);
+            arrivals_[i].store(0);
+        }
+        completed_.store(0);
+        round_.store(round);
+    }
+
+    static std::string tag(int round, std::size_t seq) {
+        return std::to_string(round) + ":" + std::to_string(seq);
+    }
+
+    void markSent(std::size_t seq) { sentNs_[seq].store(nowNs(), std::memory_order_release); }
+
+    void arrive(const std::string& tag) {
+        const std::int64_t at = nowNs();
+        int round = 0;
+        std::size_t seq = 0;
+        const char* begin = tag.data();
+        const char* end = begin + tag.size();
+        auto r = std::from_chars(begin, end, round);
+        if (r.ec != std::errc() || r.ptr == end || *r.ptr != ':') {
+            return;
+        }
+        if (std::from_chars(r.ptr + 1, end, seq).ec != std::errc()) {
+            return;
+        }
+        if (round != round_.load(std::memory_order_acquire) || seq >= messages_.load()) {
+            return; // 이전 회차(워밍업 등)에서 늦게 도착한 메시지
+        }
+        if (arrivals_[seq].fetch_add(1, std::memory_order_acq_rel) + 1 == fanout_.load()) {
+            doneNs_[seq].store(at, std::memory_order_release);
+            completed_.fetch_add(1, std::memory_order_acq_rel);
+        }
+    }
+
+    bool waitAll(std::chrono::milliseconds timeout) const {
+        const auto deadline = Clock::now() + timeout;
+        while (completed_.load(std::memory_order_acquire) < messages_.load()) {
+            if (Clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return true;
+    }
+
+    // 완료된 메시지의 지연 시간 표본과 첫 전송~마지막 완료 구간(ns)을 반환합니다.
+    std::vector<std::int64_t> latencies(std::int64_t& spanNs) const {
+        const std::size_t messages = messages_.load();
+        std::vector<std::int64_t> samples;
+        samples.reserve(messages);
+        std::int64_t first = 0;
+        std::int64_t last = 0;
+        for (std::size_t i = 0; i < messages; ++i) {
+            const std::int64_t sent = sentNs_[i].load();
+            const std::int64_t done = doneNs_[i].load();
+            if (first == 0 || (sent != 0 && sent < first)) {
+                first = sent;
+            }
+            if (done == 0) {
+                continue;
+            }
+            last = std::max(last, done);
+            samples.push_back(done - sent);
+        }
+        spanNs = last > first ? last - first : 0;
+        return samples;
+    }
+
+private:
+    const std::size_t capacity_;
+    std::atomic<int> round_{-1};
+    std::atomic<std::size_t> messages_{0};
+    std::atomic<std::uint32_t> fanout_{1};
+    std::unique_ptr<std::atomic<std::int64_t>[]> sentNs_;
+    std::unique_ptr<std::atomic<std::int64_t>[]> doneNs_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> arrivals_;
+    std::atomic<std::size_t> completed_{0};
+};
+
+struct Scenario {
+    const char* name;
+    std::size_t fanout;                          // 메시지 하나를 받아야 하는 수신기 수
+    std::function<void(const std::string&)> send; // 태그를 실은 메시지 하나를 보냄
+};
+
+struct RunConfig {
+    std::size_t messages = 20000;
+    double rate = 0.0; // 초당 메시지 수, 0이면 제한 없음
+};
+
+void runScenario(const Scenario& scenario, const RunConfig& config, Probe& probe, int& round, bool report) {
+    probe.reset(++round, config.messages, scenario.fanout);
+
+    const auto period = config.rate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config.rate))
+        : Clock::duration::zero();
+    const auto start = Clock::now();
+    const std::uint64_t allocsBefore = bench::allocationCount();
+
+    for (std::size_t i = 0; i < config.messages; ++i) {
+        if (period != Clock::duration::zero()) {
+            std::this_thread::sleep_until(start + period * static_cast<Clock::rep>(i));
+        }
+        const std::string tag = Probe::tag(round, i);
+        probe.markSent(i);
+        scenario.send(tag);
+    }
+    const bool finished = probe.waitAll(std::chrono::seconds(30));
+    const std::uint64_t allocs = bench::allocationCount() - allocsBefore;
+
+    if (!report) {
+        return;
+    }
+    std::int64_t spanNs = 0;
+    const bench::LatencySummary s = bench::summarize(probe.latencies(spanNs));
+    const double seconds = spanNs / 1e9;
+    std::printf("%-18s %8zu %10.1f %10.1f %10.1f %10.1f %12.0f %11.1f%s\n",
+                scenario.name, s.count, s.p50Us, s.p99Us, s.p999Us, s.maxUs,
+                seconds > 0.0 ? s.count / seconds : 0.0,
+                static_cast<double>(allocs) / config.messages,
+                finished ? "" : "  (시간 초과: 일부 메시지 유실)");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t receiverCount = std::stoul(bench::option(argc, argv, "receivers", "4"));
+    const std::size_t threadCount = std::stoul(bench::option(argc, argv, "threads", "2"));
+    const unsigned short basePort = static_cast<unsigned short>(std::stoul(bench::option(argc, argv, "port", "24100")));
+    const bool binary = bench::option(argc, argv, "binary", "0") == "1";
+    RunConfig config;
+    config.messages = std::stoul(bench::option(argc, argv, "messages", "20000"));
+    config.rate = std::stod(bench::option(argc, argv, "rate", "0"));
+
+    if (receiverCount == 0 || threadCount == 0 || config.messages == 0) {
+        std::cerr << "오류: receivers, threads, messages는 1 이상이어야 합니다." << std::endl;
+        return 1;
+    }
+
+    boost::asio::io_context io;
+    auto workGuard = boost::asio::make_work_guard(io);
+    Probe probe(config.messages);
+
+    // 수신 측: 포트 basePort ~ basePort+N-1 에서 대기하는 자판기 N대
+    std::vector<std::unique_ptr<network::MessageReceiver>> receivers;
+    std::vector<std::string> endpoints;
+    std::unordered_map<std::string, std::string> idMap;
+    for (std::size_t i = 0; i < receiverCount; ++i) {
+        const unsigned short port = static_cast<unsigned short>(basePort + i);
+        auto receiver = std::make_unique<network::MessageReceiver>(io, port);
+        receiver->subscribe(network::Message::Type::REQ_STOCK, [&probe](const network::Message& msg) {
+            probe.arrive(msg.contentAs<network::StockRequest>()->item_code);
+        });
+        receiver->subscribe(network::Message::Type::RESP_STOCK, [&probe](const network::Message& msg) {
+            probe.arrive(msg.contentAs<network::StockResponse>()->item_code);
+        });
+        receiver->start();
+        receivers.push_back(std::move(receiver));
+
+        const std::string endpoint = "127.0.0.1:" + std::to_string(port);
+        endpoints.push_back(endpoint);
+        idMap["R" + std::to_string(i + 1)] = endpoint;
+    }
+
+    // 송신 측 자판기. MessageService 구성에 필요한 자체 수신기는 시작하지 않습니다.
+    network::MessageSender sender(io, endpoints, idMap);
+    sender.setBinaryProtocol(binary);
+    network::MessageReceiver selfReceiver(io, static_cast<unsigned short>(basePort + receiverCount));
+    service::ErrorService errorService;
+    service::MessageService messageService(sender, selfReceiver, errorService, "B0", 0, 0);
+
+    std::vector<std::thread> ioThreads;
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        ioThreads.emplace_back([&io]() { io.run(); });
+    }
+
+    const std::vector<Scenario> scenarios = {
+        {"sender-unicast", 1, [&sender](const std::string& tag) {
+            network::Message msg;
+            msg.src_id = "B0";
+            msg.dst_id = "R1";
+            msg.setContent(network::StockRequest{tag, 1});
+            sender.send(msg);
+        }},
+        {"service-unicast", 1, [&messageService](const std::string& tag) {
+            messageService.sendStockResponse("R1", tag, 10);
+        }},
+        {"service-broadcast", receiverCount, [&messageService](const std::string& tag) {
+            // 수신기가 응답하지 않으므로 응답 대기 등록은 바로 취소해 InFlightRequestTable이 차지 않게 함
+            messageService.cancelRequest(messageService.sendStockRequestBroadcast(
+                tag, service::MessageService::DEFAULT_STOCK_RESPONSE_TIMEOUT, {}));
+        }},
+    };
+
+    std::printf("수신기 %zu대, I/O 스레드 %zu개, 메시지 %zu개, 속도 %s, 형식 %s\n\n",
+                receiverCount, threadCount, config.messages,
+                config.rate > 0.0 ? (std::to_string(static_cast<long>(config.rate)) + " msg/s").c_str() : "제한 없음",
+                binary ? "바이너리" : "JSON");
+    std::printf("%-18s %8s %10s %10s %10s %10s %12s %11s\n",
+                "scenario", "msgs", "p50(us)", "p99(us)", "p999(us)", "max(us)", "msgs/s", "allocs/msg");
+
+    int round = 0;
+    RunConfig warmup;
+    warmup.messages = std::min<std::size_t>(config.messages, 200);
+    for (const auto& scenario : scenarios) {
+        runScenario(scenario, warmup, probe, round, false); // 연결 수립과 협상을 측정에서 제외
+        runScenario(scenario, config, probe, round, true);
+    }
+
+    workGuard.reset();
+    io.stop();
+    for (auto& t : ioThreads) {
+        t.join();
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// MessageSerializer / BinaryCodec 마이크로벤치마크
+//
+// 메시지 타입마다 toJson/fromJson, 재사용 버퍼에 쓰는 encodeFrame, 바이너리 encode/decode의
+// 호출당 시간, 메시지 크기, 호출당 힙 할당 횟수를 측정합니다. 긴 문자열, 이스케이프가 많은 문자열,
+// 알 수 없는 키가 많이 붙은 msg_content 같은 비정상적으로 큰 입력도 함께 측정합니다.
+//
+// 사용법: serializer_bench.out [--iterations=200000]
+//   큰 입력은 측정 시간이 비슷해지도록 메시지 크기에 비례해 반복 횟수를 줄입니다.
+
+#include "BenchSupport.hpp"
+
+#include "network/BinaryCodec.hpp"
+#include "network/MessageSerializer.hpp"
+#include "network/message.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Measurement {
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+};
+
+// 컴파일러가 측정 대상 호출을 없애지 못하도록 결과 크기를 여기에 누적합니다.
+volatile std::size_t g_sink = 0;
+
+Measurement measure(std::size_t iterations, const std::function<std::size_t()>& op) {
+    const std::uint64_t allocsBefore = bench::allocationCount();
+    const auto start = Clock::now();
+    std::size_t sink = 0;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink += op();
+    }
+    const auto elapsed = Clock::now() - start;
+    const std::uint64_t allocs = bench::allocationCount() - allocsBefore;
+    g_sink = g_sink + sink;
+
+    Measurement m;
+    m.nsPerOp = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    m.allocsPerOp = static_cast<double>(allocs) / iterations;
+    return m;
+}
+
+/**
+ * @brief 측정할 입력 하나. json이 비어 있지 않으면 그 문자열을 디코딩만 측정합니다.
+ */
+struct Case {
+    std::string name;
+    network::Message msg;
+    std::string json;
+};
+
+template <typename Content>
+network::Message makeMessage(Content content) {
+    network::Message msg;
+    msg.src_id = "T6";
+    msg.dst_id = "T3";
+    msg.setContent(std::move(content));
+    return msg;
+}
+
+std::vector<Case> buildCases() {
+    std::vector<Case> cases;
+    cases.push_back({"req_stock", makeMessage(network::StockRequest{"07", 1}), {}});
+    cases.push_back({"resp_stock", makeMessage(network::StockResponse{"07", 12, 35, 78}), {}});
+    cases.push_back({"req_prepay", makeMessage(network::PrepayRequest{"07", 1, "A1b2C"}), {}});
+    cases.push_back({"resp_prepay", makeMessage(network::PrepayResponse{"07", 1, true}), {}});
+
+    // 비정상 입력 1: 4 KiB 문자열 필드
+    const std::string longText(4096, 'x');
+    cases.push_back({"large_strings", makeMessage(network::PrepayRequest{longText, 1, longText}), {}});
+
+    // 비정상 입력 2: 이스케이프가 필요한 문자로만 이루어진 1 KiB 문자열
+    std::string escaped;
+    for (int i = 0; i < 256; ++i) {
+        escaped += "\"\\\n\t";
+    }
+    cases.push_back({"escaped_strings", makeMessage(network::PrepayRequest{escaped, 1, escaped}), {}});
+
+    // 비정상 입력 3: msg_content에 알 수 없는 키 1000개 (디코더는 건너뛰어야 함)
+    std::string json = R"({"msg_type":0,"src_id":"T6","dst_id":"T3","msg_content":{"item_code":"07","item_num":"1")";
+    for (int i = 0; i < 1000; ++i) {
+        json += ",\"extra_" + std::to_string(i) + "\":\"value_" + std::to_string(i) + "\"";
+    }
+    json += "}}";
+    cases.push_back({"unknown_keys_1000", network::Message{}, json});
+    return cases;
+}
+
+// 측정하지 않은 항목(nullptr)은 "-"로 출력합니다.
+void printRow(const std::string& name, const char* codec, std::size_t bytes,
+              const Measurement* encode, const Measurement* decode) {
+    char encodeNs[16] = "-";
+    char encodeAllocs[16] = "-";
+    char decodeNs[16] = "-";
+    char decodeAllocs[16] = "-";
+    char decodeMBps[16] = "-";
+    if (encode != nullptr) {
+        std::snprintf(encodeNs, sizeof(encodeNs), "%.1f", encode->nsPerOp);
+        std::snprintf(encodeAllocs, sizeof(encodeAllocs), "%.2f", encode->allocsPerOp);
+    }
+    if (decode != nullptr) {
+        std::snprintf(decodeNs, sizeof(decodeNs), "%.1f", decode->nsPerOp);
+        std::snprintf(decodeAllocs, sizeof(decodeAllocs), "%.2f", decode->allocsPerOp);
+        std::snprintf(decodeMBps, sizeof(decodeMBps), "%.1f", decode->nsPerOp > 0.0 ? bytes / decode->nsPerOp * 1e3 : 0.0);
+    }
+    std::printf("%-18s %-6s %8zu %12s %10s %12s %10s %10s\n",
+                name.c_str(), codec, bytes, encodeNs, encodeAllocs, decodeNs, decodeAllocs, decodeMBps);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::size_t baseIterations = std::stoul(bench::option(argc, argv, "iterations", "200000"));
+    if (baseIterations == 0) {
+        std::fprintf(stderr, "오류: iterations는 1 이상이어야 합니다.\n");
+        return 1;
+    }
+
+    std::printf("%-18s %-6s %8s %12s %10s %12s %10s %10s\n",
+                "case", "codec", "bytes", "enc(ns/op)", "enc alloc", "dec(ns/op)", "dec alloc", "dec MB/s");
+
+    for (const Case& c : buildCases()) {
+        const bool decodeOnly = !c.json.empty();
+        const std::string json = decodeOnly ? c.json : network::MessageSerializer::toJson(c.msg);
+        const std::size_t iterations = std::max<std::size_t>(baseIterations / std::max<std::size_t>(json.size() / 128, 1), 100);
+
+        Measurement encode;
+        if (!decodeOnly) {
+            encode = measure(iterations, [&]() { return network::MessageSerializer::toJson(c.msg).size(); });
+        }
+        const Measurement decode = measure(iterations, [&]() {
+            return network::MessageSerializer::fromJson(json.data(), json.size()).src_id.size();
+        });
+        printRow(c.name, "json", json.size(), decodeOnly ? nullptr : &encode, &decode);
+
+        if (decodeOnly) {
+            continue;
+        }
+        // 전송 경로와 같이 개행까지 포함한 프레임을 재사용 버퍼에 씁니다.
+        std::string frameBuffer;
+        const Measurement frameEncode = measure(iterations, [&]() {
+            network::MessageSerializer::encodeFrame(c.msg, frameBuffer);
+            return frameBuffer.size();
+        });
+        printRow(c.name, "frame", frameBuffer.size(), &frameEncode, nullptr);
+
+        std::string frame;
+        try {
+            frame = network::BinaryCodec::encode(c.msg);
+        } catch (const std::exception&) {
+            continue; // 바이너리 형식의 문자열 길이 제한(255바이트)을 넘는 입력
+        }
+        const std::size_t prefix = network::BinaryCodec::LENGTH_PREFIX_SIZE;
+        const Measurement binEncode = measure(iterations, [&]() { return network::BinaryCodec::encode(c.msg).size(); });
+        const Measurement binDecode = measure(iterations, [&]() {
+            return network::BinaryCodec::decode(frame.data() + prefix, frame.size() - prefix).src_id.size();
+        });
+        printRow(c.name, "binary", frame.size(), &binEncode, &binDecode);
+    }
+    return 0;
+}
@@ -1,28 +1,58 @@
 #ifndef DRINK_H
 #define DRINK_H
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace domain {
 // 모든 음료의 가격은 1000원으로 통일
-const int DEFAULT_DRINK_PRICE = 1000;
+constexpr int DEFAULT_DRINK_PRICE = 1000;
 
+// 음료 정보. 코드와 이름은 복사하지 않고 카탈로그(drinkCatalog.h)의 문자열 리터럴을 가리킴.
+// 임시 std::string 등을 넘겨 뷰가 해제된 메모리를 가리키지 않도록 생성자는 문자 배열(리터럴)만 받음
 class Drink {
 private:
-    std::string drinkCode_attribute; // 음료 코드 (예: "01")
-    std::string name_attribute;      // 음료 이름 (예: "콜라")
-    int price_attribute;             // 음료 가격
+    std::string_view drinkCode_attribute; // 음료 코드 (예: "01")
+    std::string_view name_attribute;      // 음료 이름 (예: "콜라")
+    int price_attribute;                  // 음료 가격
 
 public:
-    Drink(const std::string& code = "", const std::string& name = "", int price = DEFAULT_DRINK_PRICE)
-        : drinkCode_attribute(code), name_attribute(name), price_attribute(price) {}
+    constexpr Drink() : price_attribute(DEFAULT_DRINK_PRICE) {}
+
+    template <std::size_t CodeSize, std::size_t NameSize>
+    constexpr Drink(const char (&code)[CodeSize], const char (&name)[NameSize], int price = DEFAULT_DRINK_PRICE)
+        : drinkCode_attribute(code, CodeSize - 1), name_attribute(name, NameSize - 1), price_attribute(price) {}
 
     // Getters
-    std::string getDrinkCode() const { return drinkCode_attribute; }
-    std::string getName() const { return name_attribute; }
-    int getPrice() const { return price_attribute; }
+    std::string getDrinkCode() const { return std::string(drinkCode_attribute); }
+    std::string getName() const { return std::string(name_attribute); }
+    constexpr int getPrice() const { return price_attribute; }
+
+    // 복사 없이 읽는 Getters
+    constexpr std::string_view drinkCodeView() const { return drinkCode_attribute; }
+    constexpr std::string_view nameView() const { return name_attribute; }
+};
+
+// 연속된 음료 목록을 복사 없이 가리키는 뷰 (C++17에는 std::span이 없음)
+class DrinkSpan {
+private:
+    const Drink* data_ = nullptr;
+    std::size_t size_ = 0;
+
+public:
+    constexpr DrinkSpan() = default;
+    constexpr DrinkSpan(const Drink* data, std::size_t size) : data_(data), size_(size) {}
 
+    constexpr const Drink* begin() const { return data_; }
+    constexpr const Drink* end() const { return data_ + size_; }
+    constexpr std::size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+    constexpr const Drink& operator[](std::size_t i) const { return data_[i]; }
 
+    // 목록을 따로 보관해야 하는 호출자용 복사
+    operator std::vector<Drink>() const { return std::vector<Drink>(begin(), end()); }
 };
 } // namespace domain
 
@@ -0,0 +1,98 @@
+#ifndef DRINK_CATALOG_H
+#define DRINK_CATALOG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "domain/drink.h"
+
+namespace domain {
+
+// 시스템에 정의된 20종 음료. 컴파일 시간 상수이므로 시작 비용과 힙 사용이 없음
+inline constexpr std::array<Drink, 20> DRINK_CATALOG = {{
+    // 가격 1000원 기준
+    Drink("01", "콜라", 1000),
+    Drink("02", "사이다", 1000),
+    Drink("03", "녹차", 1000),
+    Drink("04", "홍차", 1000),
+    Drink("05", "밀크티", 1000),
+    Drink("06", "탄산수", 1000),
+    Drink("07", "보리차", 1000),
+    Drink("08", "캔커피", 1000),
+    Drink("09", "물", 1000),
+    Drink("10", "에너지드링크", 1000),
+    Drink("11", "유자차", 1000),
+    Drink("12", "식혜", 1000),
+    Drink("13", "아이스티", 1000),
+    Drink("14", "딸기주스", 1000),
+    Drink("15", "오렌지주스", 1000),
+    Drink("16", "포도주스", 1000),
+    Drink("17", "이온음료", 1000),
+    Drink("18", "아메리카노", 1000),
+    Drink("19", "핫초코", 1000),
+    Drink("20", "카페라떼", 1000)
+}};
+
+// 두 자리 음료 코드 "00"~"99"의 수
+inline constexpr std::size_t DRINK_CODE_SPACE = 100;
+
+// 두 자리 숫자 코드를 0~99로 변환. 형식이 맞지 않으면 -1
+constexpr int drinkCodeSlot(std::string_view code) {
+    if (code.size() != 2 || code[0] < '0' || code[0] > '9' || code[1] < '0' || code[1] > '9') {
+        return -1;
+    }
+    return (code[0] - '0') * 10 + (code[1] - '0');
+}
+
+namespace detail {
+    // 코드 슬롯 -> DRINK_CATALOG 인덱스 표 (없으면 -1)
+    constexpr std::array<std::int8_t, DRINK_CODE_SPACE> buildDrinkIndex() {
+        std::array<std::int8_t, DRINK_CODE_SPACE> index{};
+        for (auto& entry : index) {
+            entry = -1;
+        }
+        for (std::size_t i = 0; i < DRINK_CATALOG.size(); ++i) {
+            index[static_cast<std::size_t>(drinkCodeSlot(DRINK_CATALOG[i].drinkCodeView()))] = static_cast<std::int8_t>(i);
+        }
+        return index;
+    }
+
+    constexpr bool drinkCodesWellFormed() {
+        for (const Drink& drink : DRINK_CATALOG) {
+            if (drinkCodeSlot(drink.drinkCodeView()) < 0 || drink.nameView().empty() || drink.getPrice() <= 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool drinkCodesUnique() {
+        for (std::size_t i = 0; i < DRINK_CATALOG.size(); ++i) {
+            for (std::size_t j = i + 1; j < DRINK_CATALOG.size(); ++j) {
+                if (DRINK_CATALOG[i].drinkCodeView() == DRINK_CATALOG[j].drinkCodeView()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+} // namespace detail
+
+static_assert(detail::drinkCodesWellFormed(), "음료 카탈로그에 형식이 잘못된 코드, 빈 이름 또는 0 이하의 가격이 있습니다.");
+static_assert(detail::drinkCodesUnique(), "음료 카탈로그에 중복된 음료 코드가 있습니다.");
+static_assert(DRINK_CATALOG.size() < 128, "카탈로그 인덱스는 int8_t에 들어가야 합니다.");
+
+inline constexpr std::array<std::int8_t, DRINK_CODE_SPACE> DRINK_INDEX_BY_CODE = detail::buildDrinkIndex();
+
+// 음료 코드의 카탈로그 인덱스. 없거나 형식이 맞지 않으면 -1
+// 코드가 리터럴이면 컴파일 시간에 계산됨 (예: constexpr int cola = drinkCatalogIndex("01");)
+constexpr int drinkCatalogIndex(std::string_view code) {
+    const int slot = drinkCodeSlot(code);
+    return slot < 0 ? -1 : DRINK_INDEX_BY_CODE[static_cast<std::size_t>(slot)];
+}
+
+} // namespace domain
+
+#endif // DRINK_CATALOG_H
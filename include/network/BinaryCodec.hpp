@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "network/message.hpp" // network::Message 구조체 사용을 위해 포함
+
+namespace network {
+
+/**
+ * @brief 연결에서 사용하는 메시지 인코딩 방식입니다.
+ * JSON은 표준 프로토콜(개행 구분 JSON)이며, BINARY는 연결 단위 협상에 성공한 경우에만 사용합니다.
+ */
+enum class WireFormat {
+    JSON,
+    BINARY
+};
+
+/**
+ * @brief network::Message 객체를 길이 접두사가 붙은 바이너리 프레임으로 변환하는 코덱입니다.
+ * 우리 팀 자판기끼리 주고받는 작은 재고 메시지의 크기와 파싱 비용을 줄이기 위한 것으로,
+ * 송신 측이 연결 직후 PREAMBLE을 보내고 수신 측이 같은 바이트열로 응답(ack)한 연결에서만 사용합니다.
+ * ack를 받지 못하면 송신 측은 새 연결에서 JSON으로 전송합니다. 버전이 다른 수신 측은 자기 PREAMBLE로 응답한 뒤
+ * 연결을 닫으며, 이렇게 거절한 자판기만 JSON 전용으로 기억합니다.
+ *
+ * 프레임 형식 (정수는 모두 big-endian, str8은 u8 길이 + 바이트열):
+ *  - u32 본문 길이
+ *  - u8 msg_type, str8 src_id, str8 dst_id, str8 corr_id (없으면 길이 0)
+ *  - msg_type별 고정 순서의 필드: str8 item_code, i32 item_num, 이어서
+ *    RESP_STOCK은 i32 coor_x, i32 coor_y / REQ_PREPAY는 str8 cert_code / RESP_PREPAY는 u8 availability
+ * 모든 메소드는 정적(static)으로 제공됩니다.
+ */
+class BinaryCodec {
+public:
+    /**
+     * @brief 협상 요청/응답 바이트열 길이입니다.
+     */
+    static constexpr std::size_t PREAMBLE_SIZE = 5;
+
+    /**
+     * @brief 협상 요청/응답 바이트열. 첫 바이트가 0이고 개행 문자가 없으므로 JSON 프레임과 구분됩니다.
+     * 마지막 바이트는 프레임 형식 버전으로, 버전이 다른 피어와는 협상이 실패해 JSON을 사용합니다.
+     */
+    static constexpr char PREAMBLE[PREAMBLE_SIZE] = {'\0', 'V', 'M', 'B', '\x03'};
+
+    /**
+     * @brief 프레임 앞의 길이 접두사 크기입니다.
+     */
+    static constexpr std::size_t LENGTH_PREFIX_SIZE = 4;
+
+    /**
+     * @brief network::Message 객체를 길이 접두사를 포함한 바이너리 프레임으로 변환합니다.
+     * @param msg 인코딩할 network::Message 객체.
+     * @return 길이 접두사를 포함한 프레임.
+     * @throws std::length_error ID나 문자열 필드가 255바이트를 넘는 경우.
+     * @throws std::invalid_argument msg_type과 msg_content의 종류가 다른 경우.
+     */
+    static std::string encode(const Message& msg);
+
+    /**
+     * @brief encode()와 같은 프레임을 out에 씁니다. out의 기존 내용은 지우지만 할당된 용량은 재사용합니다.
+     * @param msg 인코딩할 network::Message 객체.
+     * @param out 프레임을 받을 버퍼.
+     * @throws std::length_error ID나 문자열 필드가 255바이트를 넘는 경우 (out의 내용은 정의되지 않음).
+     * @throws std::invalid_argument msg_type과 msg_content의 종류가 다른 경우.
+     */
+    static void encodeFrame(const Message& msg, std::string& out);
+
+    /**
+     * @brief 길이 접두사를 제외한 프레임 본문을 network::Message 객체로 변환합니다.
+     * @param body 본문의 시작 위치.
+     * @param length 본문의 바이트 길이.
+     * @return 디코딩된 network::Message 객체.
+     * @throws std::runtime_error 본문이 잘렸거나 형식이 잘못된 경우.
+     */
+    static Message decode(const char* body, std::size_t length);
+
+    /**
+     * @brief 길이 접두사(LENGTH_PREFIX_SIZE 바이트)를 읽어 본문 길이를 반환합니다.
+     * @param prefix 길이 접두사의 시작 위치.
+     * @return 본문 길이.
+     */
+    static std::uint32_t readLength(const char* prefix);
+};
+
+} // namespace network
@@ -5,12 +5,16 @@
 #include <unordered_map>    
 #include <type_traits>      
 #include <memory>           
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 
 #include <boost/asio/io_context.hpp> 
 #include <boost/asio/ip/tcp.hpp>     // Boost.Asio TCP 관련 타입
 
 #include "network/message.hpp"         
 #include "network/MessageSerializer.hpp" 
+#include "network/BinaryCodec.hpp"
 
 namespace network {
 
@@ -28,11 +32,33 @@ struct EnumClassHash {
     }
 };
 
+/**
+ * @brief MessageReceiver가 자원 사용을 제한하기 위한 설정값입니다.
+ * 자판기 수가 늘어나거나 오동작하는 피어가 있어도 메모리와 지연 시간이 예측 가능하도록 합니다.
+ */
+struct ReceiverLimits {
+    std::size_t maxConnections = 64;          ///< 동시에 유지할 최대 연결 수. 초과 연결은 즉시 닫음
+    std::size_t maxFrameSize = 64 * 1024;     ///< 프레임 하나의 최대 바이트 수. 초과 시 프레임을 버리고 연결을 닫음
+    std::chrono::milliseconds readDeadline{5000};  ///< 시작된 프레임을 다 받을 때까지 기다리는 최대 시간
+    std::chrono::milliseconds idleTimeout{300000}; ///< 프레임 사이에 아무 데이터도 없을 때 연결을 유지하는 최대 시간
+};
+
+/**
+ * @brief MessageReceiver의 부하 차단 통계 (누적값).
+ */
+struct ReceiverStats {
+    std::uint64_t activeConnections = 0;   ///< 현재 열려 있는 연결 수
+    std::uint64_t shedConnections = 0;     ///< 최대 연결 수 초과로 거부한 연결 수
+    std::uint64_t timedOutConnections = 0; ///< 읽기 기한 또는 유휴 시간 초과로 닫은 연결 수
+    std::uint64_t droppedFrames = 0;       ///< 크기 초과 또는 형식 오류로 버린 프레임 수
+};
+
 /**
  * @brief 들어오는 TCP 연결을 처리하고 수신된 메시지를 가공합니다.
  * 지정된 포트에서 수신 대기하고, 연결을 수락하며, 비동기적으로 데이터를 읽습니다.
- * 수신된 JSON 데이터를 network::Message 객체로 역직렬화하고,
+ * 수신된 JSON 데이터(또는 협상된 연결의 바이너리 프레임)를 network::Message 객체로 역직렬화하고,
  * 메시지 유형에 따라 등록된 핸들러로 전달합니다.
+ * ReceiverLimits로 연결 수, 프레임 크기, 읽기 기한, 유휴 시간을 제한하며, 제한에 걸린 연결/프레임은 버리고 통계에 기록합니다.
  */
 class MessageReceiver {
     // 테스트 목적으로 private 멤버에 접근해야 할 경우를 위한 friend 선언
@@ -50,12 +76,15 @@ public:
      * 지정된 포트에서 수신 대기하도록 acceptor를 초기화합니다.
      * @param io Boost.Asio io_context 객체에 대한 참조. 비동기 I/O 작업 스케줄링에 사용됩니다.
      * @param port 수신기가 들어오는 연결을 수신 대기할 포트 번호입니다.
+     * @param limits 연결 수, 프레임 크기, 타임아웃 제한 (기본값 사용 가능).
      */
-    MessageReceiver(boost::asio::io_context& io, unsigned short port);
+    MessageReceiver(boost::asio::io_context& io, unsigned short port, ReceiverLimits limits = ReceiverLimits{});
 
     /**
      * @brief 특정 메시지 타입에 대한 핸들러 함수를 구독(등록)합니다.
      * 해당 타입의 메시지가 수신되면 등록된 핸들러가 호출됩니다.
+     * 핸들러는 여러 연결에서 동시에 호출될 수 있으므로, 공유 상태를 다룬다면 직접 직렬화해야 합니다.
+     * start() 이전에만 호출해야 합니다.
      * @param type 구독할 network::Message::Type.
      * @param handler 해당 'type'의 메시지가 수신되었을 때 호출될 Handler 함수.
      */
@@ -68,25 +97,47 @@ public:
      */
     void start();
 
+    /**
+     * @brief 현재까지의 부하 차단 통계를 반환합니다. 어느 스레드에서 호출해도 안전합니다.
+     * @return 통계 스냅샷.
+     */
+    ReceiverStats stats() const;
+
 private:
+    /**
+     * @brief 연결 하나를 담당하는 수신 세션입니다. (MessageReceiver.cpp에 정의)
+     * 연결이 유지되는 동안 같은 수신 버퍼를 재사용하며, 한 번의 읽기로 들어온
+     * 모든 완성된 프레임('\n' 단위 또는 길이 접두사 단위)을 처리한 뒤에 다음 읽기를 시작합니다.
+     * 첫 바이트가 BinaryCodec::PREAMBLE로 시작하면 ack를 보내고 바이너리 형식으로 전환합니다.
+     */
+    class Session;
+
     /**
      * @brief 새로운 들어오는 TCP 연결을 비동기적으로 수락합니다.
-     * 연결이 성공적으로 이루어지면, doRead()를 호출하여 소켓으로부터 데이터 읽기를 시작합니다.
+     * 연결이 성공적으로 이루어지면, 해당 소켓을 담당하는 Session을 만들어 읽기를 시작합니다.
+     * 각 연결의 소켓은 전용 strand에 묶이므로 세션 핸들러는 여러 I/O 스레드에서도 순서대로 실행됩니다.
      * 그 후, 다음 연결을 수락하도록 자신을 다시 스케줄링합니다.
      */
     void doAccept();
 
     /**
-     * @brief 주어진 TCP 소켓으로부터 개행 문자를 만날 때까지 비동기적으로 데이터를 읽습니다.
-     * 수신된 데이터는 JSON에서 Message 객체로 역직렬화된 후, 적절한 핸들러가 호출됩니다.
-     * 메시지 처리 후 (또는 오류 발생 시), 동일한 소켓에서 다음 메시지를 읽도록 자신을 다시 스케줄링합니다.
-     * @param sock 데이터를 읽어올 TCP 소켓에 대한 std::shared_ptr.
+     * @brief 수신된 프레임 하나를 Message 객체로 역직렬화한 뒤, 메시지 타입에 맞는 핸들러를 호출합니다.
+     * 파싱 실패나 핸들러 예외는 이 프레임만 버리고(droppedFrames 증가) 연결은 유지합니다.
+     * @param format 프레임의 인코딩 방식.
+     * @param data 프레임의 시작 위치 (개행 문자 또는 길이 접두사 제외).
+     * @param length 프레임의 바이트 길이.
      */
-    void doRead(std::shared_ptr<boost::asio::ip::tcp::socket> sock);
+    void dispatch(WireFormat format, const char* data, std::size_t length);
 
     boost::asio::io_context& io_context_; ///< Boost.Asio io_context에 대한 참조.
     unsigned short port_;                 ///< 이 수신기가 수신 대기하는 포트 번호.
     boost::asio::ip::tcp::acceptor acceptor_; ///< 들어오는 TCP 연결을 위한 Boost.Asio acceptor.
+    const ReceiverLimits limits_;         ///< 자원 사용 제한
+
+    std::atomic<std::uint64_t> active_connections_{0};
+    std::atomic<std::uint64_t> shed_connections_{0};
+    std::atomic<std::uint64_t> timed_out_connections_{0};
+    std::atomic<std::uint64_t> dropped_frames_{0};
     
     // 메시지 타입으로 키가 지정된 핸들러들을 저장합니다. Message::Type에 EnumClassHash를 사용합니다.
     std::unordered_map<Message::Type, Handler, EnumClassHash> handlers_;
@@ -3,9 +3,14 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
 #include <boost/asio/io_context.hpp> // Boost.Asio 사용
 #include <boost/asio/ip/tcp.hpp>     // TCP 소켓 통신을 위한 Boost.Asio 헤더
 #include "network/message.hpp"         // network::Message 구조체 사용
+#include "network/PeerConnection.hpp"  // 엔드포인트별 영속 연결
 
 namespace network {
 
@@ -13,38 +18,82 @@ namespace network {
  * @brief 네트워크를 통해 network::Message 객체를 다른 자판기로 전송하는 클래스입니다.
  * 메시지를 특정 대상(유니캐스트) 또는 모든 등록된 다른 자판기(브로드캐스트)에 전송할 수 있습니다.
  * Boost.Asio를 사용하여 TCP 소켓 통신을 수행합니다.
+ * 엔드포인트마다 PeerConnection 하나를 만들어 두고 모든 전송에 재사용합니다. 연결 유지, 끊김 감지, 재연결은
+ * PeerConnection이 맡으며, MessageSender는 직렬화와 대상별 분배만 합니다.
+ * 모든 전송은 비동기로 이루어지며, 브로드캐스트는 모든 대상에게 동시에 전송됩니다.
  */
 class MessageSender {
 public:
+    /**
+     * @brief 대상 하나에 대한 전송 결과를 알리는 콜백 타입입니다.
+     * 엔드포인트 문자열과 오류 코드(성공 시 비어 있음)를 받으며, io_context 스레드에서 호출됩니다.
+     */
+    using PeerHandler = std::function<void(const std::string& endpoint, const boost::system::error_code& ec)>;
+
+    /**
+     * @brief 한 번의 send() 호출에 포함된 모든 대상의 전송이 끝났을 때 호출되는 콜백 타입입니다.
+     * 성공한 대상 수와 실패한 대상 수를 받습니다.
+     */
+    using CompletionHandler = std::function<void(std::size_t succeeded, std::size_t failed)>;
+
     /**
      * @brief MessageSender 생성자.
      * @param io Boost.Asio io_context 객체에 대한 참조. 비동기 작업 스케줄링에 사용됩니다.
      * @param endpoints 브로드캐스트 시 메시지를 전송할 모든 다른 자판기들의 엔드포인트(host:port 문자열) 목록.
      * @param id_map 유니캐스트 시 사용될 자판기 ID와 해당 자판기의 엔드포인트 문자열을 매핑하는 맵.
+     * 모든 엔드포인트는 여기서 파싱되고 주소 해석이 비동기로 시작됩니다.
+     * @throw std::invalid_argument 엔드포인트 형식이 "host:port"가 아닌 경우.
      */
     MessageSender(boost::asio::io_context& io,
                   const std::vector<std::string>& endpoints, // 브로드캐스트용 엔드포인트 목록
                   const std::unordered_map<std::string, std::string>& id_map); // 유니캐스트용 ID-엔드포인트 맵
 
     /**
-     * @brief 주어진 network::Message 객체를 전송합니다.
-     * 메시지의 dst_id가 "0"이면 브로드캐스트하고, 그렇지 않으면 해당 ID의 자판기에 유니캐스트합니다.
+     * @brief 주어진 network::Message 객체를 비동기로 전송합니다. 호출 즉시 반환합니다.
+     * 메시지의 dst_id가 "0"이면 모든 대상에게 동시에 브로드캐스트하고, 그렇지 않으면 해당 ID의 자판기에 유니캐스트합니다.
+     * 브로드캐스트 전체 소요 시간은 대상 수의 합이 아니라 가장 느린 대상 하나로 제한됩니다.
      * @param msg 전송할 network::Message 객체.
+     * @param onPeer 대상별 전송 완료/실패 시 호출될 콜백 (선택).
+     * @param onComplete 모든 대상의 전송이 끝났을 때 한 번 호출될 콜백 (선택). 대상이 없으면 즉시 (0, 0)으로 호출됩니다.
+     */
+    void send(const Message& msg, PeerHandler onPeer = {}, CompletionHandler onComplete = {});
+
+    /**
+     * @brief 모든 연결의 이후 연결 시도에 적용할 연결 제한 시간을 설정합니다. (기본 2초)
+     * 응답 없는 자판기 하나가 브로드캐스트 완료를 3초 재고 조회 대기 시간 이상 붙잡지 않도록 합니다.
+     * @param timeout 연결 시도 제한 시간.
      */
-    void send(const Message& msg);
+    void setConnectTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 다른 자판기와의 바이너리 전송 협상 사용 여부를 설정합니다. (기본값: 사용 안 함)
+     * 켜면 각 연결이 BinaryCodec 협상을 시도하고, 응답하지 않는 표준 피어에게는 자동으로 JSON을 사용합니다.
+     * @param enabled true이면 협상을 시도합니다.
+     */
+    void setBinaryProtocol(bool enabled);
+
+    /**
+     * @brief 브로드캐스트(dst_id "0") 시 메시지를 받는 자판기 수를 반환합니다.
+     * @return 생성 시 전달된 엔드포인트 목록의 크기.
+     */
+    std::size_t broadcastTargetCount() const;
 
 private:
     /**
-     * @brief 특정 엔드포인트로 메시지를 전송하는 내부 헬퍼 함수입니다.
-     * @param endpoint 메시지를 전송할 대상의 엔드포인트 문자열 (형식: "host:port").
-     * @param msg 전송할 network::Message 객체.
-     * @throws std::exception TCP 연결 또는 전송 실패 시.
+     * @brief 엔드포인트에 해당하는 PeerConnection을 반환합니다. 없으면 새로 만듭니다.
+     * @param endpoint 대상 엔드포인트 문자열 (형식: "host:port").
+     * @return 해당 엔드포인트의 PeerConnection.
      */
-    void sendOne(const std::string& endpoint, const Message& msg);
+    std::shared_ptr<PeerConnection> connectionFor(const std::string& endpoint);
 
     boost::asio::io_context& io_context_; // Boost.Asio io_context 참조
     std::vector<std::string> endpoints_;  // 브로드캐스트 대상 엔드포인트 목록
     std::unordered_map<std::string, std::string> id_map_; // 자판기 ID별 엔드포인트 맵
+
+    std::mutex connections_mutex_; // connections_, connect_timeout_, binary_enabled_ 보호
+    std::unordered_map<std::string, std::shared_ptr<PeerConnection>> connections_; // 엔드포인트별 영속 연결
+    std::chrono::milliseconds connect_timeout_{2000};
+    bool binary_enabled_ = false; // 바이너리 전송 협상 사용 여부 (connections_mutex_로 보호)
 };
 
 } // namespace network
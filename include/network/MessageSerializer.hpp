@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include "network/message.hpp" // network::Message 구조체 사용을 위해 포함
 
@@ -15,20 +16,47 @@ class MessageSerializer {
 public:
     /**
      * @brief network::Message 객체를 JSON 형식의 문자열로 변환합니다.
-     * PFR 문서의 표1~4에 정의된 메시지 포맷을 따릅니다.
+     * PFR 문서의 표1~4에 정의된 메시지 포맷을 따릅니다. corr_id는 비어 있지 않을 때만 최상위 키로 추가됩니다.
      * @param msg 직렬화할 network::Message 객체.
      * @return JSON 형식으로 직렬화된 문자열.
+     * @throws std::invalid_argument msg_type과 msg_content의 종류가 다른 경우.
      */
     static std::string toJson(const Message& msg);
 
+    /**
+     * @brief network::Message 객체를 개행 문자로 끝나는 전송용 JSON 프레임으로 변환해 out에 씁니다.
+     * out의 기존 내용은 지우지만 할당된 용량은 그대로 재사용하며, 중간 버퍼 없이 out에 바로 씁니다.
+     * 결과를 그대로 소켓 쓰기 버퍼로 넘길 수 있으므로, 브로드캐스트는 한 번만 직렬화해 모든 대상이 공유합니다.
+     * JSON 연결은 바이너리 프로토콜을 협상하지 않은 표준 피어용이므로 PFR 표준 키만 쓰고 corr_id는 넣지 않습니다.
+     * @param msg 직렬화할 network::Message 객체.
+     * @param out 프레임을 받을 버퍼. 호출자가 소유하며 여러 번 재사용할 수 있습니다.
+     * @throws std::invalid_argument msg_type과 msg_content의 종류가 다른 경우.
+     */
+    static void encodeFrame(const Message& msg, std::string& out);
+
     /**
      * @brief JSON 형식의 문자열을 network::Message 객체로 변환합니다.
      * PFR 문서의 표1~4에 정의된 메시지 포맷을 따릅니다.
+     * DOM을 만들지 않고 RapidJSON SAX 리더로 읽으면서 바로 필드를 채웁니다. 알 수 없는 키는 무시합니다.
+     * 선택 키인 corr_id가 있으면 Message::corr_id에 채웁니다.
      * @param json 역직렬화할 JSON 형식의 문자열.
      * @return 역직렬화된 network::Message 객체.
-     * @throws std::runtime_error (또는 RapidJSON 관련 예외) JSON 파싱 실패 시.
+     * msg_content는 msg_type에 맞는 구조체(StockRequest 등)로 채워지며, 숫자 필드는 이때 한 번만 변환됩니다.
+     * @throws std::runtime_error JSON 문법 오류, 필수 필드(msg_type, src_id, dst_id, msg_content 및
+     *         msg_type별 필수 키) 누락, 알 수 없는 msg_type, 정수가 아닌 숫자 필드 또는 타입이 맞지 않는 값이 있는 경우.
+     *         오류 이유가 메시지에 포함됩니다.
      */
     static Message fromJson(const std::string& json);
+
+    /**
+     * @brief 버퍼의 일부분(JSON 한 프레임)을 network::Message 객체로 변환합니다.
+     * 수신 버퍼에서 잘라낸 프레임을 임시 문자열로 복사하지 않고 바로 파싱할 때 사용합니다.
+     * @param data JSON 데이터의 시작 위치. null 종료 문자열일 필요는 없습니다.
+     * @param length JSON 데이터의 바이트 길이.
+     * @return 역직렬화된 network::Message 객체.
+     * @throws std::runtime_error fromJson(const std::string&)과 같은 조건에서 발생합니다.
+     */
+    static Message fromJson(const char* data, std::size_t length);
 };
 
 } // namespace network
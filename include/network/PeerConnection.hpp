@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <array>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include "network/BinaryCodec.hpp"
+
+namespace network {
+
+/**
+ * @brief 한 메시지를 인코딩 방식별로 미리 직렬화해 둔 전송 단위입니다.
+ * 브로드캐스트 시 모든 연결이 같은 객체를 공유하며, 각 연결은 협상된 형식에 맞는 쪽을 보냅니다.
+ */
+struct OutgoingFrame {
+    std::string json;   ///< 개행 문자를 포함한 JSON 프레임 (항상 존재)
+    std::string binary; ///< 길이 접두사를 포함한 바이너리 프레임 (바이너리 전송을 쓰지 않으면 비어 있음)
+};
+
+/**
+ * @brief 다른 자판기 하나와 유지하는 영속 TCP 연결입니다.
+ * 모든 소켓 작업은 연결 전용 strand 위에서 비동기로 수행되며, 전송 요청은 큐에 쌓여 순서대로 기록됩니다.
+ * 연결이 없으면 첫 전송 시점에 연결하고, 상대가 연결을 닫으면 다음 전송 때 다시 연결합니다.
+ * 주소 해석(resolve) 결과는 캐시해 두고 연결 때마다 재사용합니다. start() 이후 TTL마다 타이머로 백그라운드에서
+ * 다시 해석해 캐시를 갱신하므로 연결 시점에 해석을 기다리지 않습니다. 갱신이 실패하면 기존 결과를 유지하고,
+ * 연결에 실패하면 캐시를 버립니다.
+ * 바이너리 전송이 켜져 있으면 연결 직후 BinaryCodec::PREAMBLE을 보내 협상합니다. 상대가 다른 바이트열로 응답하면
+ * (버전이 다른 피어의 거절) 상대를 JSON 전용으로 기억합니다. 제한 시간 안에 ack가 오지 않거나 전송 오류가 나면
+ * 기다리던 프레임은 새 연결에서 JSON으로 보내되, 판정은 기억하지 않고 그다음 연결에서 다시 협상합니다.
+ * MessageSender가 엔드포인트마다 하나씩 만들어 보관합니다.
+ */
+class PeerConnection : public std::enable_shared_from_this<PeerConnection> {
+public:
+    /**
+     * @brief 전송 한 건의 결과를 알리는 콜백 타입입니다. 성공 시 ec는 비어 있습니다.
+     */
+    using WriteHandler = std::function<void(const boost::system::error_code& ec)>;
+
+    /**
+     * @brief 해석된 주소 캐시의 기본 유효 시간입니다.
+     */
+    static constexpr std::chrono::seconds DEFAULT_RESOLVE_TTL{30};
+
+    /**
+     * @brief 바이너리 협상 응답(ack)을 기다리는 시간입니다.
+     */
+    static constexpr std::chrono::milliseconds NEGOTIATION_TIMEOUT{500};
+
+    /**
+     * @brief PeerConnection 생성자. 엔드포인트 문자열은 여기서 한 번만 파싱하며, 실제 연결은 첫 전송 시점에 맺습니다.
+     * @param io Boost.Asio io_context 객체에 대한 참조.
+     * @param endpoint 대상 엔드포인트 문자열 (형식: "host:port").
+     * @param connectTimeout 연결 시도 제한 시간. 응답 없는 자판기가 전송을 오래 붙잡지 않도록 합니다.
+     * @param resolveTtl 해석된 주소 캐시의 유효 시간.
+     * @throw std::invalid_argument 엔드포인트 형식이 잘못된 경우.
+     */
+    PeerConnection(boost::asio::io_context& io,
+                   const std::string& endpoint,
+                   std::chrono::milliseconds connectTimeout,
+                   std::chrono::milliseconds resolveTtl = DEFAULT_RESOLVE_TTL);
+
+    /**
+     * @brief 주소 해석을 미리 시작하고 TTL마다 다시 해석하는 타이머를 겁니다. 생성 직후 한 번 호출합니다.
+     * (생성자 안에서는 shared_from_this()를 쓸 수 없으므로 별도 함수로 분리)
+     */
+    void start();
+
+    /**
+     * @brief 이후 연결 시도에 적용할 연결 제한 시간을 변경합니다.
+     * @param timeout 연결 시도 제한 시간.
+     */
+    void setConnectTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 이후 연결부터 바이너리 전송 협상을 시도할지 설정합니다. 설정하면 JSON 전용 판정도 초기화됩니다.
+     * @param enabled true이면 협상을 시도합니다.
+     */
+    void setBinaryProtocol(bool enabled);
+
+    /**
+     * @brief 직렬화가 끝난 프레임을 전송 큐에 넣습니다. 어느 스레드에서 호출해도 안전합니다.
+     * @param frame 전송할 프레임. 여러 연결이 같은 버퍼를 공유할 수 있도록 불변 shared_ptr로 받습니다.
+     * @param handler 전송 완료 또는 실패 시 io_context 스레드에서 호출될 콜백 (비어 있어도 됨).
+     */
+    void send(std::shared_ptr<const OutgoingFrame> frame, WriteHandler handler);
+
+    /**
+     * @brief 연결을 닫고 대기 중인 전송을 operation_aborted로 실패 처리합니다. 주소 갱신 타이머도 멈춥니다.
+     */
+    void close();
+
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    struct PendingWrite {
+        std::shared_ptr<const OutgoingFrame> frame;
+        WriteHandler handler;
+        bool retried = false; // 끊어진 연결로 인해 이미 한 번 재전송했는지 여부
+    };
+
+    enum class State { DISCONNECTED, CONNECTING, NEGOTIATING, CONNECTED };
+
+    void doConnect();
+    void connectTo(std::uint64_t generation);
+    void startResolve();
+    void scheduleRefresh();
+    void onResolved(const boost::system::error_code& ec, boost::asio::ip::tcp::resolver::results_type results);
+    void onConnected(const boost::system::error_code& ec, std::uint64_t generation);
+    void negotiate(std::uint64_t generation);
+    void onNegotiated(const boost::system::error_code& ec, std::uint64_t generation);
+    void fallBackToJson(bool refusedByPeer);
+    void startConnected(WireFormat format, std::uint64_t generation);
+    void doWrite();
+    void onWritten(const boost::system::error_code& ec, std::uint64_t generation);
+    void watchForClose(std::uint64_t generation);
+    void resetSocket();
+    void failPending(const boost::system::error_code& ec);
+    static void complete(const PendingWrite& write, const boost::system::error_code& ec);
+
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_; ///< 이 연결의 모든 작업을 직렬화
+    boost::asio::ip::tcp::resolver resolver_;
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::steady_timer connect_timer_;
+    boost::asio::steady_timer refresh_timer_; ///< TTL마다 주소를 다시 해석
+    std::chrono::milliseconds connect_timeout_;
+    std::chrono::milliseconds resolve_ttl_;
+
+    std::string endpoint_; ///< "host:port"
+    std::string host_;
+    std::string port_;
+
+    boost::asio::ip::tcp::resolver::results_type resolved_; ///< 캐시된 해석 결과 (비어 있으면 해석 필요)
+    std::chrono::steady_clock::time_point resolved_at_;     ///< resolved_를 얻은 시각
+    bool resolving_ = false;        ///< 해석 요청이 진행 중인지 여부
+    bool awaiting_resolve_ = false; ///< 현재 연결 시도가 해석 결과를 기다리는 중인지 여부
+
+    std::deque<PendingWrite> queue_; ///< 전송 대기 중인 프레임 (front가 전송 중일 수 있음)
+    State state_ = State::DISCONNECTED;
+    bool writing_ = false;
+    bool peer_closed_ = false;       ///< 전송 중에 상대가 연결을 닫았는지 여부 (쓰기가 성공해도 상대는 읽지 않음)
+    bool connect_timed_out_ = false; ///< 현재 연결 시도가 제한 시간으로 취소되었는지 여부
+    std::uint64_t generation_ = 0;   ///< 소켓을 새로 만들 때마다 증가. 이전 소켓의 늦은 콜백을 걸러냄
+    char probe_byte_ = 0;            ///< 연결 종료 감지용 읽기 버퍼
+
+    bool binary_enabled_ = false;             ///< 바이너리 전송 협상 시도 여부
+    bool json_only_ = false;                  ///< 상대가 협상을 거절해 JSON 전용으로 판정되었는지 여부
+    bool skip_negotiation_once_ = false;      ///< 협상이 응답 없이 끝나 다음 연결 한 번은 바로 JSON으로 보낼지 여부
+    WireFormat format_ = WireFormat::JSON;    ///< 현재 연결에서 사용하는 인코딩 방식
+    std::array<char, BinaryCodec::PREAMBLE_SIZE> ack_{}; ///< 협상 응답 수신 버퍼
+};
+
+} // namespace network
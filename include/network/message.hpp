@@ -1,22 +1,102 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <cstddef>
+#include <type_traits>
+#include <variant>
 
 namespace network {
+
+/**
+ * @brief 자판기 간 메시지 종류 (PFR 표1~4). 값은 JSON의 msg_type 필드와 같습니다.
+ */
+enum class MessageType {
+    REQ_STOCK = 0,
+    RESP_STOCK = 1,
+    REQ_PREPAY = 2,
+    RESP_PREPAY = 3,
+};
+
+// 메시지 종류별 msg_content. 음료 코드(2자리)와 인증 코드(5자리)는 std::string의 내부 버퍼(SSO)에 들어가므로
+// 힙 할당 없이 메시지 안에 그대로 저장됩니다. 수치 필드는 직렬화 단계에서 한 번만 변환합니다.
+
+/**
+ * @brief 재고 조회 요청 (PFR 표1).
+ */
+struct StockRequest {
+    static constexpr MessageType TYPE = MessageType::REQ_STOCK;
+    std::string item_code; // 조회할 음료 코드 (누락 시 빈 문자열)
+    int item_num = 1;
+};
+
+/**
+ * @brief 재고 조회 응답 (PFR 표2).
+ */
+struct StockResponse {
+    static constexpr MessageType TYPE = MessageType::RESP_STOCK;
+    std::string item_code;
+    int item_num = 0; // 응답 자판기의 현재 재고량
+    int coor_x = 0;   // 응답 자판기의 X 좌표
+    int coor_y = 0;   // 응답 자판기의 Y 좌표
+};
+
+/**
+ * @brief 선결제 재고 확보 요청 (PFR 표3).
+ */
+struct PrepayRequest {
+    static constexpr MessageType TYPE = MessageType::REQ_PREPAY;
+    std::string item_code;
+    int item_num = 1;
+    std::string cert_code; // 선결제 인증 코드
+};
+
+/**
+ * @brief 선결제 재고 확보 응답 (PFR 표4).
+ */
+struct PrepayResponse {
+    static constexpr MessageType TYPE = MessageType::RESP_PREPAY;
+    std::string item_code;
+    int item_num = 0;          // 확보된 (또는 요청받은) 수량
+    bool availability = false; // 확보 성공 여부 (JSON에서는 "T"/"F")
+};
+
+/**
+ * @brief msg_content의 타입. 대안(alternative)의 순서는 MessageType 값과 같아야 합니다.
+ */
+using MessagePayload = std::variant<StockRequest, StockResponse, PrepayRequest, PrepayResponse>;
+
 struct Message{
-    enum class Type{
-        REQ_STOCK = 0,
-        RESP_STOCK = 1,
-        REQ_PREPAY = 2,
-        RESP_PREPAY = 3,
-    };
+    using Type = MessageType;
 
     Type msg_type{}; 
     std::string src_id = "T6"; 
     std::string dst_id = "0"; // 0일 때는 브로드캐스트
-    std::unordered_map<std::string, std::string> msg_content; 
+    std::string corr_id;      // 요청-응답 상관관계 ID (선택). 요청에 붙여 보내면 응답이 그대로 돌려줌. 바이너리 프로토콜을 협상한 피어에게만 전송됨
+    MessagePayload msg_content; // msg_type에 해당하는 대안을 담습니다. setContent()로 설정하세요.
+
+    /**
+     * @brief msg_content를 설정하고 msg_type을 그에 맞게 맞춥니다.
+     */
+    template <typename T>
+    void setContent(T content) {
+        msg_type = T::TYPE;
+        msg_content = std::move(content);
+    }
 
+    /**
+     * @brief msg_content가 T이면 그 포인터를, 아니면 nullptr를 반환합니다.
+     */
+    template <typename T>
+    const T* contentAs() const { return std::get_if<T>(&msg_content); }
+
+    template <typename T>
+    T* contentAs() { return std::get_if<T>(&msg_content); }
 };
 
+static_assert(std::variant_size_v<MessagePayload> == 4, "MessagePayload must cover every MessageType");
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(MessageType::REQ_STOCK), MessagePayload>, StockRequest>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(MessageType::RESP_STOCK), MessagePayload>, StockResponse>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(MessageType::REQ_PREPAY), MessagePayload>, PrepayRequest>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<std::size_t>(MessageType::RESP_PREPAY), MessagePayload>, PrepayResponse>);
+
 }
@@ -1,22 +1,31 @@
 #pragma once
 
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include "domain/drink.h" // Drink 클래스 사용
 
 namespace persistence {
 
+/**
+ * @brief 시스템에 정의된 20종 음료 목록(카탈로그)을 제공합니다.
+ * 카탈로그는 컴파일 시간 상수(domain::DRINK_CATALOG)이고, 두 자리 음료 코드("00"~"99")를 그대로 배열 인덱스로 쓰는
+ * 색인도 컴파일 시간에 만들어지므로 코드 조회는 상수 시간이며 힙을 쓰지 않습니다.
+ * 반환하는 참조와 뷰는 프로그램이 끝날 때까지 유효합니다.
+ */
 class DrinkRepository {
 public:
     DrinkRepository() = default; // 기본 생성자 (필요시)
 
     // 특정 음료 코드로 음료 정보를 조회
-    // 현재 오류 처리 범위 정책에 따라, 항상 유효한 drinkCode로 호출된다고 가정
-    domain::Drink findByDrinkCode(const std::string& drinkCode);
+    // 현재 오류 처리 범위 정책에 따라, 항상 유효한 drinkCode로 호출된다고 가정 (없으면 std::runtime_error)
+    const domain::Drink& findByDrinkCode(std::string_view drinkCode) const;
 
-    // 시스템에 정의된 모든 음료 종류의 목록을 반환
-    std::vector<domain::Drink> findAll();
+    // 특정 음료 코드로 음료 정보를 조회. 없으면 nullptr (예외를 던지지 않음)
+    const domain::Drink* tryFindByDrinkCode(std::string_view drinkCode) const;
+
+    // 시스템에 정의된 모든 음료 종류의 목록을 반환 (복사하지 않는 뷰)
+    domain::DrinkSpan findAll() const;
 };
 
-} // namespace persistence
\ No newline at end of file
+} // namespace persistence
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "persistence/WriteAheadLog.hpp"
+#include "persistence/inventoryRepository.h"
+
+namespace domain {
+    class Order;
+    class PrePaymentCode;
+    class VendingMachine;
+}
+
+namespace persistence {
+
+class OrderRepository;
+class PrepayCodeRepository;
+class OvmAddressRepository;
+
+/**
+ * @brief 리포지토리 로그 레코드의 종류 (레코드 본문의 첫 바이트).
+ */
+enum class JournalRecordType : std::uint8_t {
+    INVENTORY_SET = 1, ///< 음료 코드, 수량
+    ORDER_SAVE,        ///< 주문 전체
+    ORDER_STATUS,      ///< updateStatus 인자 (vmid, 음료 코드, 인증 코드, 새 상태). 예전 로그를 읽을 때만 씀
+    PREPAY_SAVE,       ///< 인증 코드, 상태, 연결된 주문
+    PREPAY_STATUS,     ///< 인증 코드, 새 상태
+    OVM_SAVE,          ///< 자판기 ID, 좌표, 포트
+    HOLD_ADD,          ///< 홀드 ID, 음료 코드, 수량, 만료 시각(ms), 홀드 후 재고
+    HOLD_END,          ///< 홀드 ID, 음료 코드, 홀드를 끝낸 후 재고
+    ORDER_STATUS_AT,   ///< 주문 번호, 새 상태
+    ORDER_LOG_LENGTH   ///< 주문 파일의 레코드 수 (스냅샷에만 씀)
+};
+
+/**
+ * @brief 메모리 리포지토리(재고, 주문, 선결제 코드, 다른 자판기 주소)를 WriteAheadLog로 디스크에 유지합니다.
+ * recover()가 마지막 스냅샷과 로그 꼬리를 리포지토리에 다시 적용한 뒤 로그를 연결하므로,
+ * 이후 리포지토리의 모든 변경은 레코드 하나로 로그에 남고, 스냅샷은 리포지토리 전체 상태로 만들어집니다.
+ * 단, 주문 이력은 주문 파일(OrderLog)에 이미 있으므로 스냅샷에는 파일을 동기화한 뒤 그 길이만 남깁니다.
+ * 그래서 스냅샷 크기는 처리한 주문 수와 관계없고, 복원할 때 파일 앞부분을 그 길이만큼 되살린 뒤 로그 꼬리를 적용합니다.
+ * 스냅샷 이후의 상태 변경은 주문 번호로 남기므로, 파일에 이미 반영된 변경을 다시 적용해도 결과가 같습니다.
+ * 로그에 남기 전에 프로세스가 죽은 변경이 스냅샷 이전 주문의 파일 내용에는 남아 있을 수 있습니다.
+ * 레코드 인코딩(…Record 함수)은 리포지토리가 변경을 남길 때 함께 사용합니다.
+ */
+class DurableStore {
+public:
+    /**
+     * @brief DurableStore 생성자.
+     * @param directory 로그와 스냅샷을 둘 디렉터리.
+     * @param orderRepo orderStoragePath(directory)처럼 재시작 후에도 남는 파일에 저장하는 주문 리포지토리.
+     * @param snapshotEvery 이만큼 로그 레코드가 쌓이면 스냅샷을 새로 씀.
+     * @throws std::invalid_argument 주문 리포지토리가 작업용 파일에 저장하는 경우.
+     * @throws std::runtime_error 디렉터리를 열 수 없는 경우.
+     */
+    DurableStore(const std::string& directory,
+                 InventoryRepository& inventoryRepo,
+                 OrderRepository& orderRepo,
+                 PrepayCodeRepository& prepayCodeRepo,
+                 OvmAddressRepository& ovmAddressRepo,
+                 std::size_t snapshotEvery = 1024);
+
+    /**
+     * @brief 로그 연결을 끊습니다. 리포지토리보다 먼저 소멸해야 합니다.
+     */
+    ~DurableStore();
+
+    DurableStore(const DurableStore&) = delete;
+    DurableStore& operator=(const DurableStore&) = delete;
+
+    /**
+     * @brief 스냅샷과 로그를 리포지토리에 적용하고, 이후 변경을 로그에 남기도록 리포지토리에 로그를 연결합니다.
+     * @return 복원한 레코드가 있으면 true (처음 시작이면 false).
+     * @throws std::runtime_error 스냅샷이 손상되었거나 레코드를 해석할 수 없는 경우.
+     */
+    bool recover();
+
+    /**
+     * @brief 현재 상태로 스냅샷을 쓰고 로그를 비웁니다.
+     */
+    void checkpoint();
+
+    /**
+     * @brief 로그 기록이나 스냅샷이 실패했을 때 이유를 받을 함수를 지정합니다 (변경은 이미 반영되었고 기록은 재시도 중).
+     */
+    void setFailureHandler(WriteAheadLog::FailureHandler handler);
+
+    /**
+     * @brief 디렉터리 안의 주문 저장 파일(OrderLog) 경로. OrderRepository를 만들 때 넘깁니다.
+     */
+    static std::string orderStoragePath(const std::string& directory);
+
+    // --- 레코드 인코딩 ---
+    static std::string inventorySetRecord(std::string_view drinkCode, int qty);
+    static std::string orderSaveRecord(const domain::Order& order);
+    static std::string orderStatusRecord(std::size_t index, const std::string& newStatus);
+    static std::string orderLogLengthRecord(std::size_t length);
+    static std::string prepaySaveRecord(const domain::PrePaymentCode& prepayCode);
+    static std::string prepayStatusRecord(const std::string& code, int newStatus);
+    static std::string ovmSaveRecord(const domain::VendingMachine& vm);
+    static std::string holdAddRecord(const InventoryRepository::Hold& hold, int qtyAfter);
+    static std::string holdEndRecord(std::string_view holdId, std::string_view drinkCode, int qtyAfter);
+
+private:
+    void apply(std::string_view record);
+    std::vector<std::string> snapshotRecords() const;
+    void attach(WriteAheadLog* log);
+
+    InventoryRepository& inventoryRepo_;
+    OrderRepository& orderRepo_;
+    PrepayCodeRepository& prepayCodeRepo_;
+    OvmAddressRepository& ovmAddressRepo_;
+    std::unique_ptr<WriteAheadLog> log_;
+};
+
+} // namespace persistence
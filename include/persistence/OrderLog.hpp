@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "domain/order.h"
+
+namespace persistence {
+
+/**
+ * @brief 주문을 고정 크기(32바이트) 레코드로 파일에 이어 붙이고 mmap으로 읽고 고치는 주문 저장소입니다.
+ *
+ * 자판기 ID, 음료 코드, 결제 상태는 종류가 몇 개 되지 않으므로 문자열 표에 한 번만 두고 레코드에는 번호(u16)만 저장합니다.
+ * 인증 코드는 레코드 안에 그대로 저장합니다 (최대 CERT_CODE_CAPACITY자).
+ *
+ * 파일은 SEGMENT_RECORDS개 단위의 구간으로 늘어나며 구간마다 따로 매핑하므로, 늘어나도 기존 레코드의 주소는 바뀌지 않습니다.
+ * 가장 최근 hotSegments개 구간만 프로세스 메모리에 남겨 두고, 그보다 오래된 구간은 새 구간을 열 때 매핑에서 내려놓습니다
+ * (MADV_DONTNEED: 내용은 파일에 남고 다시 접근하면 파일에서 읽힘). 그래서 처리한 주문 수와 관계없이 상주 메모리가 일정합니다.
+ *
+ * 경로를 주면 파일을 비우지 않고 열며, 문자열 표는 옆의 "<경로>.strings" 파일에 새 문자열이 생길 때마다 동기화해 남깁니다.
+ * 그래서 레코드가 가리키는 문자열 번호는 재시작 후에도 같습니다. 열린 직후에는 레코드가 0개이며,
+ * DurableStore가 스냅샷에 남긴 길이로 restore()를 호출해 이전 레코드를 되살립니다 (주문 이력은 스냅샷에 복사하지 않음).
+ * 경로가 비어 있으면 임시 디렉터리($TMPDIR)의 이름 없는 작업용 파일(없으면 메모리 파일)을 쓰며 재시작 후에는 남지 않습니다.
+ * 스레드 안전하지 않으므로 여러 스레드에서 쓰려면 호출하는 쪽(OrderRepository)이 잠가야 합니다.
+ */
+class OrderLog {
+public:
+    /**
+     * @brief 레코드 하나. 파일에 그대로 저장됩니다.
+     */
+    struct Record {
+        std::int32_t qty;
+        std::uint16_t vmid;      ///< 문자열 표 번호
+        std::uint16_t drinkCode; ///< 문자열 표 번호
+        std::uint16_t payStatus; ///< 문자열 표 번호
+        std::uint8_t certLen;
+        char certCode[21];
+    };
+    static_assert(sizeof(Record) == 32, "주문 레코드는 32바이트여야 합니다.");
+
+    static constexpr std::size_t CERT_CODE_CAPACITY = sizeof(Record::certCode);
+    static constexpr std::size_t SEGMENT_RECORDS = 4096; ///< 구간 하나의 레코드 수 (128KiB)
+    static constexpr std::size_t DEFAULT_HOT_SEGMENTS = 2;
+
+    /**
+     * @brief 주문 파일을 열거나 만듭니다. 기존 레코드는 restore() 전까지 보이지 않습니다.
+     * @param path 파일 경로 (없는 상위 디렉터리는 만듦). 비어 있으면 임시 디렉터리에 이름 없는 파일을 만들어 쓰고, 만들 수 없으면 메모리 파일을 씁니다.
+     * @param hotSegments 메모리에 남겨 둘 최근 구간 수 (1 이상).
+     * @throws std::system_error 파일을 만들거나 매핑할 수 없는 경우.
+     */
+    explicit OrderLog(const std::string& path = "", std::size_t hotSegments = DEFAULT_HOT_SEGMENTS);
+    ~OrderLog();
+
+    OrderLog(const OrderLog&) = delete;
+    OrderLog& operator=(const OrderLog&) = delete;
+
+    /**
+     * @brief 파일 앞부분의 length개 레코드를 다시 보이게 하고, 각 레코드를 순서대로 visit에 넘깁니다 (색인 재구성용).
+     * 열린 직후, 레코드를 추가하기 전에 한 번 호출합니다. 훑는 동안에도 최근 hotSegments개 구간만 메모리에 남습니다.
+     * @throws std::logic_error 이미 레코드를 추가한 경우.
+     * @throws std::runtime_error 파일이 length개 레코드보다 짧거나 레코드가 문자열 표에 없는 번호를 가리키는 경우.
+     */
+    void restore(std::size_t length, const std::function<void(std::size_t, const Record&)>& visit);
+
+    /**
+     * @brief 지금까지 레코드에 쓴 내용을 디스크에 동기화합니다 (스냅샷 전에 호출).
+     * @throws std::system_error 동기화에 실패한 경우.
+     */
+    void sync();
+
+    /**
+     * @brief 재시작 후에도 남는 파일인지 (경로를 주고 열었는지).
+     */
+    bool isDurable() const { return stringsFd_ >= 0; }
+
+    /**
+     * @brief 주문을 맨 뒤에 추가합니다.
+     * @return 추가한 레코드의 번호.
+     * @throws std::length_error 인증 코드가 CERT_CODE_CAPACITY자보다 긴 경우.
+     */
+    std::size_t append(const domain::Order& order);
+
+    /**
+     * @brief 번호의 레코드를 주문 전체로 덮어씁니다.
+     * @throws std::length_error 인증 코드가 CERT_CODE_CAPACITY자보다 긴 경우.
+     */
+    void overwrite(std::size_t index, const domain::Order& order);
+
+    /**
+     * @brief 번호의 레코드의 결제 상태만 바꿉니다.
+     */
+    void setPayStatus(std::size_t index, std::string_view payStatus);
+
+    /**
+     * @brief 번호의 레코드를 domain::Order로 만들어 반환합니다.
+     */
+    domain::Order at(std::size_t index) const;
+
+    /**
+     * @brief 번호의 레코드 (문자열 필드는 lookupString/stringAt으로 변환).
+     */
+    const Record& record(std::size_t index) const {
+        return segments_[index / SEGMENT_RECORDS][index % SEGMENT_RECORDS];
+    }
+
+    static std::string_view certCodeOf(const Record& record) {
+        return std::string_view(record.certCode, record.certLen);
+    }
+
+    /**
+     * @brief 문자열 표에서 문자열의 번호를 찾습니다. 한 번도 저장된 적 없는 문자열이면 std::nullopt.
+     */
+    std::optional<std::uint16_t> lookupString(std::string_view value) const;
+
+    /**
+     * @brief 문자열 표 번호의 문자열.
+     */
+    const std::string& stringAt(std::uint16_t id) const { return strings_[id]; }
+
+    /**
+     * @brief 저장된 레코드 수.
+     */
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief 매핑에서 내려놓지 않고 남겨 둔 구간 수 (최대 hotSegments).
+     */
+    std::size_t residentSegments() const;
+
+private:
+    std::uint16_t intern(std::string_view value);
+    void fill(Record& record, const domain::Order& order);
+    void addSegment();
+    void loadStrings();
+
+    int fd_ = -1;
+    int stringsFd_ = -1;              ///< 문자열 표 파일 (작업용 파일이면 -1)
+    std::size_t fileBytes_ = 0;       ///< 주문 파일 길이
+    std::size_t hotSegments_;
+    std::vector<Record*> segments_;
+    std::size_t size_ = 0;
+    std::size_t evictedSegments_ = 0; ///< 앞에서부터 매핑에서 내려놓은 구간 수
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, std::uint16_t> stringIds_;
+};
+
+} // namespace persistence
@@ -1,22 +1,67 @@
 #ifndef ORDER_REPOSITORY_H
 #define ORDER_REPOSITORY_H
 
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "domain/order.h" 
+#include "persistence/OrderLog.hpp"
 
 namespace persistence {
 
+class WriteAheadLog;
+
+// 주문은 메모리 벡터 대신 OrderLog(mmap한 고정 크기 레코드 파일)에 저장되어, 최근 구간만 메모리에 남음.
+// 인증 코드 해시 색인과 (자판기, 음료)별 PENDING 주문 색인을 메모리에 두므로 조회와 갱신이 주문 수와 관계없이 레코드를 훑지 않음.
+// 선결제 요청은 io_context 스레드에서 저장되므로 저장소와 색인은 내부 뮤텍스로 보호함
 class OrderRepository {
 public:
-    OrderRepository() = default;
+    // storagePath가 비어 있으면 임시 디렉터리의 이름 없는 파일(없으면 메모리 파일)을 씀 (자판기는 데이터 디렉터리의 파일을 넘김)
+    explicit OrderRepository(const std::string& storagePath = "",
+                             std::size_t hotSegments = OrderLog::DEFAULT_HOT_SEGMENTS)
+        : orders_(storagePath, hotSegments) {}
 
     domain::Order findByCertCode(const std::string& certCode); // 선결제 주문 조회용
     void save(const domain::Order& order); // 주문 정보 저장/업데이트
     // 주문 상태 업데이트
     bool updateStatus(const std::string& vmid, const std::string& drinkCode, const std::string& certCode, const std::string& newStatus);
+    std::vector<domain::Order> findAll() const; // 저장된 순서의 전체 주문
+    std::size_t size() const;
+    // 번호의 주문 상태를 바꿈 (로그 재적용용: 같은 레코드를 두 번 적용해도 결과가 같음)
+    bool updateStatusAt(std::size_t index, const std::string& newStatus);
+    // 주문 파일 앞부분의 length건을 되살리고 색인을 다시 만듦 (스냅샷 복원용, 주문을 저장하기 전에 호출)
+    void restoreStorage(std::size_t length);
+    void syncStorage();                 // 주문 파일을 디스크에 동기화 (스냅샷 직전)
+    bool hasDurableStorage() const { return orders_.isDurable(); } // 재시작 후에도 남는 파일에 저장하는지
+    const OrderLog& storage() const { return orders_; } // 다른 스레드가 저장하지 않을 때만 사용 (테스트용)
+    void attachLog(WriteAheadLog* log) { log_ = log; } // 이후 변경을 남길 로그 (DurableStore가 연결)
 private:
-    std::vector<domain::Order> orders_; // 메모리 내 주문 저장소
+    void saveInMemory(const domain::Order& order);
+    // 상태를 바꾼 주문의 번호 (찾지 못하면 std::nullopt)
+    std::optional<std::size_t> updateStatusInMemory(const std::string& vmid, const std::string& drinkCode, const std::string& certCode, const std::string& newStatus);
+    void setStatusAt(std::size_t index, const std::string& newStatus);
+    std::optional<std::size_t> indexOfCertCode(const std::string& certCode) const;
+    bool isPending(const OrderLog::Record& record);
+    // 레코드가 PENDING이면 (자판기, 음료) 색인에 넣거나 뺌
+    void trackPending(std::size_t index, const OrderLog::Record& record);
+    void untrackPending(std::size_t index, const OrderLog::Record& record);
+
+    static std::uint32_t machineDrinkKey(std::uint16_t vmid, std::uint16_t drinkCode) {
+        return (static_cast<std::uint32_t>(vmid) << 16) | drinkCode;
+    }
+
+    mutable std::mutex mtx_;            // 아래 저장소와 색인 보호 (로그가 연결되면 로그 뮤텍스 다음에 잡음)
+    OrderLog orders_;                   // 주문 저장소
+    std::unordered_map<std::string, std::size_t> byCertCode_;  // 인증 코드 -> 레코드 번호 (인증 코드가 있는 주문만)
+    std::optional<std::size_t> firstWithoutCertCode_;          // 인증 코드 없는 가장 오래된 주문
+    std::unordered_map<std::uint32_t, std::set<std::size_t>> pendingByMachineDrink_; // (자판기, 음료) -> PENDING 주문 번호 (오래된 순)
+    std::optional<std::uint16_t> pendingId_;                   // 문자열 표의 "PENDING" 번호 (처음 저장된 뒤 고정)
+    WriteAheadLog* log_ = nullptr;      // 연결된 로그 (없으면 메모리에만 반영)
 };
 
 } // namespace persistence
@@ -9,6 +9,8 @@
 
 namespace persistence {
 
+class WriteAheadLog;
+
 class OvmAddressRepository {
 public:
     OvmAddressRepository() = default;
@@ -16,8 +18,10 @@ public:
     domain::VendingMachine findById(const std::string& vmId) const;
     std::vector<domain::VendingMachine> findAll() const;
     void save(const domain::VendingMachine& vm);
+    void attachLog(WriteAheadLog* log) { log_ = log; } // 이후 변경을 남길 로그 (DurableStore가 연결)
 private:
     std::map<std::string, domain::VendingMachine> vms_;
+    WriteAheadLog* log_ = nullptr;
 };
 
 } // namespace persistence
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace persistence {
+
+/**
+ * @brief 로그 레코드 본문을 만드는 도우미. 정수는 호스트 바이트 순서, 문자열은 길이(u32) + 바이트로 씁니다.
+ */
+class RecordWriter {
+public:
+    RecordWriter& u8(std::uint8_t value);
+    RecordWriter& i32(std::int32_t value);
+    RecordWriter& i64(std::int64_t value);
+    RecordWriter& str(std::string_view value);
+
+    const std::string& bytes() const { return bytes_; }
+    std::string take() { return std::move(bytes_); }
+
+private:
+    std::string bytes_;
+};
+
+/**
+ * @brief RecordWriter로 만든 레코드 본문을 읽는 도우미.
+ * @throws std::runtime_error 본문이 예상보다 짧은 경우.
+ */
+class RecordReader {
+public:
+    explicit RecordReader(std::string_view bytes) : bytes_(bytes) {}
+
+    std::uint8_t u8();
+    std::int32_t i32();
+    std::int64_t i64();
+    std::string str();
+
+private:
+    void need(std::size_t size) const;
+
+    std::string_view bytes_;
+    std::size_t pos_ = 0;
+};
+
+/**
+ * @brief 리포지토리 변경 내역을 디렉터리 하나에 append-only 로그(wal.log)와 스냅샷(snapshot.bin)으로 남깁니다.
+ *
+ * 레코드는 [길이 u32][CRC32 u32][로그 순번 u64 + 본문] 형식이며, 시작 시 replay는 스냅샷의 레코드를 먼저, 이어서 로그의 레코드를 순서대로
+ * 넘겨줍니다. 쓰다 만 꼬리나 체크섬이 맞지 않는 레코드를 만나면 거기서 멈추고 로그를 그 앞까지 잘라냅니다.
+ *
+ * commit은 메모리 변경(apply)과 레코드 대기열 추가를 한 뮤텍스 안에서 하므로 로그 순서가 곧 변경 순서입니다.
+ * 디스크 기록은 그룹 커밋으로 합니다: 기록 중이 아닌 스레드 하나가 그때까지 쌓인 레코드를 한 번의 write와 fdatasync로
+ * 내보내고, 그동안 들어온 레코드는 다음 묶음이 됩니다. commit은 자기 레코드가 디스크에 닿은 뒤 반환합니다.
+ * 묶음 기록이 실패하면 다음 묶음을 쓰기 전에 로그를 마지막으로 디스크에 닿은 길이로 잘라낸 뒤 다시 씁니다.
+ * 메모리 변경은 이미 일어났으므로 commit은 실패를 호출자에게 던지지 않고 FailureHandler로 알리며,
+ * 다음 commit이 없더라도 백그라운드 스레드가 RETRY_INTERVAL마다 남은 레코드를 다시 씁니다.
+ * replay는 순번이 늘어나지 않는 레코드를 이미 적용한 것으로 보고 건너뜁니다.
+ *
+ * 로그 레코드가 snapshotEvery개 쌓이면 snapshotSource가 돌려주는 현재 상태 전체를 새 스냅샷으로 쓰고(임시 파일 → rename)
+ * 로그를 비웁니다. 스냅샷에는 반영된 마지막 로그 순번이 함께 기록되므로, 로그를 비우기 전에 멈춰도 같은 변경이 두 번 적용되지 않습니다.
+ */
+class WriteAheadLog {
+public:
+    /**
+     * @brief 현재 상태 전체를 레코드 목록으로 돌려주는 함수 (스냅샷용).
+     */
+    using SnapshotSource = std::function<std::vector<std::string>()>;
+
+    /**
+     * @brief 디스크 기록이나 자동 스냅샷이 실패했을 때 이유를 받는 함수. 로그 뮤텍스를 잡지 않은 채 호출됩니다.
+     */
+    using FailureHandler = std::function<void(const std::string&)>;
+
+    /// 기록에 실패한 레코드를 백그라운드에서 다시 쓰는 간격
+    static constexpr std::chrono::milliseconds RETRY_INTERVAL{1000};
+
+    /**
+     * @brief 디렉터리를 열고(없으면 만듦) 로그 파일을 이어 쓸 준비를 합니다.
+     * @param directory 로그와 스냅샷을 둘 디렉터리.
+     * @param snapshotEvery 이만큼 로그 레코드가 쌓이면 스냅샷을 새로 씀 (0이면 자동 스냅샷 안 함).
+     * @throws std::runtime_error 디렉터리나 파일을 열 수 없는 경우.
+     */
+    explicit WriteAheadLog(std::string directory, std::size_t snapshotEvery = 1024);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    /**
+     * @brief 스냅샷과 로그의 레코드를 순서대로 handler에 넘깁니다. 로그를 쓰기 전에 한 번 호출합니다.
+     * @return 넘긴 레코드 수.
+     */
+    std::size_t replay(const std::function<void(std::string_view)>& handler);
+
+    /**
+     * @brief 자동 스냅샷에 쓸 상태 공급 함수를 지정합니다.
+     */
+    void setSnapshotSource(SnapshotSource source);
+
+    /**
+     * @brief 기록 실패를 알릴 함수를 지정합니다 (지정하지 않으면 알리지 않고 재시도만 함).
+     */
+    void setFailureHandler(FailureHandler handler);
+
+    /**
+     * @brief apply로 메모리 상태를 바꾸고, 바꿨으면 apply가 돌려준 레코드를 로그에 남긴 뒤 디스크에 닿을 때까지 기다립니다.
+     * 레코드를 대기열에 넣은 뒤의 기록·스냅샷 실패는 던지지 않습니다: FailureHandler로 알리고 백그라운드에서 다시 씁니다.
+     * @param apply 메모리를 바꾸고 그 변경을 나타내는 레코드 본문을 돌려주는 함수. 빈 문자열이면 변경 없음 (레코드를 남기지 않음).
+     * @return 레코드를 남겼으면 true (디스크 기록이 실패해 재시도 중이어도 true).
+     */
+    bool commit(const std::function<std::string()>& apply);
+
+    /**
+     * @brief 지금 상태로 스냅샷을 쓰고 로그를 비웁니다.
+     * @throws std::system_error 스냅샷을 쓸 수 없는 경우.
+     */
+    void checkpoint();
+
+    /**
+     * @brief 마지막 스냅샷 이후 로그에 남긴 레코드 수.
+     */
+    std::size_t recordsSinceSnapshot() const;
+
+private:
+    void enqueueLocked(const std::string& record);
+    void waitDurableLocked(std::unique_lock<std::mutex>& lock, std::uint64_t ticket);
+    void checkpointLocked(std::unique_lock<std::mutex>& lock);
+    void openLogForAppend(bool truncate);
+    void scheduleRetryLocked();
+    void retryLoop();
+    void reportFailure(const std::string& what);
+
+    const std::string directory_;
+    const std::string logPath_;
+    const std::string snapshotPath_;
+    const std::size_t snapshotEvery_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable flushed_;
+    int logFd_ = -1;
+    std::string pending_;            ///< 아직 쓰지 않은 레코드 묶음
+    std::uint64_t nextLsn_ = 1;      ///< 다음 레코드의 로그 순번
+    std::uint64_t enqueued_ = 0;     ///< 대기열에 넣은 레코드 수 (누적)
+    std::uint64_t durable_ = 0;      ///< 디스크에 닿은 레코드 수 (누적)
+    std::uint64_t durableBytes_ = 0; ///< 디스크에 닿은 로그 파일 길이
+    bool truncatePending_ = false;   ///< 실패한 묶음의 일부가 파일에 남았을 수 있어 다음 기록 전에 잘라내야 함
+    bool flushing_ = false;          ///< 다른 스레드가 묶음을 쓰는 중
+    std::size_t sinceSnapshot_ = 0;
+    SnapshotSource snapshotSource_;
+    FailureHandler failureHandler_;
+    std::condition_variable retryWake_;
+    std::thread retryThread_;        ///< 처음 실패할 때 시작하는 재시도 스레드
+    bool stopping_ = false;
+};
+
+} // namespace persistence
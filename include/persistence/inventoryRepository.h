@@ -1,22 +1,66 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <string>
-#include <map>
+#include <string_view>
 #include <optional> // std::optional 사용 가능
+#include <unordered_map>
+#include <vector>
 
 #include "domain/inventory.h"
 
 namespace persistence {
 
+class WriteAheadLog;
+
+/**
+ * @brief 현재 자판기의 음료별 재고를 보관합니다.
+ * 두 자리 음료 코드("00"~"99")를 그대로 인덱스로 쓰는 고정 슬롯 표에 std::atomic<int> 수량을 두므로,
+ * 메인(컨트롤러) 스레드와 네트워크 I/O 스레드가 잠금 없이 동시에 조회·차감할 수 있습니다.
+ * 조회는 원자적 읽기 한 번이고, 차감은 compare-and-swap으로 0 미만이 되지 않게 합니다.
+ * 수량은 domain::Inventory와 같이 0~99로 제한됩니다.
+ * 로그가 연결되어 있으면(attachLog) 수량을 바꿀 때마다 바뀐 수량을 로그에 남기며, 이때 변경은 로그의 잠금 안에서 일어납니다.
+ *
+ * 다른 자판기의 선결제로 잡아둔 수량(홀드)도 함께 보관합니다. 홀드를 잡거나 끝낼 때의 수량 변경과 홀드 기록은
+ * 로그 레코드 하나로 남으므로, 재시작 후에도 홀드와 재고가 어긋나지 않습니다. 만료 처리는 InventoryService가 합니다.
+ */
 class InventoryRepository {
 public:
-    InventoryRepository() = default;
+    /**
+     * @brief 잡아둔 수량 하나. 재시작 후에도 의미가 있도록 만료 시각은 벽시계 기준입니다.
+     */
+    struct Hold {
+        std::string id;        ///< 홀드 ID (선결제 인증 코드)
+        std::string drinkCode; ///< 음료 코드
+        int amount = 0;        ///< 잡아둔 수량
+        std::chrono::system_clock::time_point expiresAt;
+    };
+
+    InventoryRepository();
+
+    InventoryRepository(const InventoryRepository&) = delete;
+    InventoryRepository& operator=(const InventoryRepository&) = delete;
 
+    /**
+     * @brief 음료를 취급 목록에 추가하거나 수량을 덮어씁니다.
+     * @throws std::invalid_argument 음료 코드가 두 자리 숫자가 아닌 경우.
+     */
     void addOrUpdateStock(const domain::Inventory& inventoryItem);
     bool isDrinkHandled(const std::string& drinkCode) const;
     bool hasStock(const std::string& drinkCode) const; // 재고가 1개 이상인지
     bool decreaseStockByOne(const std::string& drinkCode);
 
+    /**
+     * @brief 특정 음료의 현재 수량을 한 번의 원자적 읽기로 반환합니다.
+     * @param drinkCode 조회할 음료 코드.
+     * @return 취급하는 음료이면 수량, 취급하지 않거나 코드 형식이 맞지 않으면 std::nullopt.
+     */
+    std::optional<int> quantityOf(std::string_view drinkCode) const;
+
     /**
      * @brief 특정 음료 코드에 해당하는 Inventory 객체를 반환합니다.
      * 해당 음료를 취급하지 않거나 Inventory 객체를 찾을 수 없는 경우,
@@ -30,15 +74,75 @@ public:
     
     /**
      * @brief 특정 음료의 재고를 지정된 수량만큼 감소시킵니다.
+     * 여러 스레드가 동시에 호출해도 남은 재고보다 많이 차감되지 않습니다.
      * @param drinkCode 재고를 감소시킬 음료의 코드.
      * @param amount 감소시킬 수량.
      * @return 성공 시 true, 실패(해당 음료 없음, 재고 부족 등) 시 false.
      */
     bool decreaseStockByAmount(const std::string& drinkCode, int amount);
 
+    /**
+     * @brief 특정 음료의 재고를 지정된 수량만큼 되돌립니다 (만료·취소된 예약 반환). 최대 99개로 제한됩니다.
+     * @param drinkCode 재고를 늘릴 음료의 코드.
+     * @param amount 늘릴 수량.
+     * @return 성공 시 true, 실패(해당 음료 없음, 0 이하 수량) 시 false.
+     */
+    bool increaseStockByAmount(const std::string& drinkCode, int amount);
+
+    /**
+     * @brief 재고에서 수량을 빼고 홀드로 기록합니다.
+     * @return 성공 시 true, 실패(해당 음료 없음, 재고 부족, 같은 ID의 홀드가 있음) 시 false.
+     */
+    bool holdStock(const Hold& hold);
+
+    /**
+     * @brief 홀드를 끝냅니다.
+     * @param holdId 홀드 ID.
+     * @param returnToStock true면 잡아둔 수량을 재고로 되돌림 (취소·만료), false면 그대로 둠 (확정).
+     * @return 끝낸 홀드. 없으면 std::nullopt.
+     */
+    std::optional<Hold> endHold(const std::string& holdId, bool returnToStock);
+
+    /**
+     * @brief 수량은 바꾸지 않고 홀드 기록만 되살립니다 (로그 재생용).
+     */
+    void restoreHold(const Hold& hold);
+
+    /**
+     * @brief 남아 있는 홀드 전체 (스냅샷과 재시작 후 만료 타이머 복원용).
+     */
+    std::vector<Hold> findAllHolds() const;
+
+    /**
+     * @brief 취급하는 모든 음료의 재고를 음료 코드 순으로 반환합니다 (스냅샷용).
+     */
+    std::vector<domain::Inventory> findAll() const;
+
+    /**
+     * @brief 이후의 수량 변경을 남길 로그를 연결합니다. nullptr이면 로그를 남기지 않습니다 (DurableStore가 호출).
+     */
+    void attachLog(WriteAheadLog* log) { log_ = log; }
 
 private:
-    std::map<std::string, domain::Inventory> stock_;
+    static constexpr std::size_t SLOT_COUNT = 100; ///< 음료 코드 "00"~"99"
+    static constexpr int NOT_HANDLED = -1;         ///< 취급하지 않는 음료의 슬롯 값
+    static constexpr int MAX_QTY = 99;             ///< domain::Inventory의 최대 재고
+
+    // 슬롯의 수량을 바꾸고 바뀐 수량을 로그에 남깁니다 (로그가 없으면 바꾸기만 함).
+    template <typename Mutation>
+    bool mutateSlot(int slot, Mutation mutation);
+
+    // apply가 돌려준 레코드를 로그에 남깁니다 (로그가 없으면 apply만 실행). 빈 레코드는 변경 없음
+    template <typename Apply>
+    bool commitOrApply(Apply apply);
+
+    static bool tryDecrease(std::atomic<int>& qty, int amount);
+    static bool tryIncrease(std::atomic<int>& qty, int amount);
+
+    std::array<std::atomic<int>, SLOT_COUNT> qty_; ///< 음료 코드별 수량 (NOT_HANDLED면 취급 안 함)
+    mutable std::mutex holdsMtx_;                  ///< holds_ 보호 (로그가 연결되면 로그 뮤텍스 다음에 잡음)
+    std::unordered_map<std::string, Hold> holds_;  ///< 홀드 ID -> 홀드
+    WriteAheadLog* log_ = nullptr;
 };
 
-} // namespace persistence
\ No newline at end of file
+} // namespace persistence
@@ -2,14 +2,18 @@
 
 #include <string>
 #include <map>   
+#include <vector>
 
 #include "domain/prepaymentCode.h"
 
 namespace persistence {
 
+class WriteAheadLog;
+
 /**
  * @brief 선결제 인증 코드(PrePaymentCode)의 영속성(저장, 조회, 상태 변경)을 관리하는 리포지토리 클래스입니다.
  * 내부적으로 std::map을 사용하여 메모리 내에 선결제 코드 정보를 저장합니다.
+ * 로그가 연결되어 있으면(attachLog) 저장과 상태 변경을 로그에 남깁니다.
  * 관련된 유스케이스: UC12 (저장), UC14 (조회, 상태 변경), UC15 (저장)
  */
 class PrepayCodeRepository {
@@ -42,9 +46,20 @@ public:
      */
     bool updateStatus(const std::string& code, domain::CodeStatus newStatus);
 
+    /**
+     * @brief 저장된 모든 선결제 정보를 코드 순으로 반환합니다 (스냅샷용).
+     */
+    std::vector<domain::PrePaymentCode> findAll() const;
+
+    /**
+     * @brief 이후의 변경을 남길 로그를 연결합니다. nullptr이면 로그를 남기지 않습니다 (DurableStore가 호출).
+     */
+    void attachLog(WriteAheadLog* log) { log_ = log; }
+
 private:
     // 메모리 내 선결제 코드 저장소. Key: 인증 코드(std::string), Value: PrePaymentCode 객체.
     std::map<std::string, domain::PrePaymentCode> codes_;
+    WriteAheadLog* log_ = nullptr;
 };
 
 } // namespace persistence
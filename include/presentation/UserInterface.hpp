@@ -17,8 +17,8 @@ public:
     void displayMainMenu(const std::vector<std::string>& options);
     int getUserChoice(int maxChoice);
     std::string getUserInputString(const std::string& prompt);
-    void displayDrinkList(const std::vector<domain::Drink>& allDrinks);
-    std::string selectDrink(const std::vector<domain::Drink>& allDrinks);
+    void displayDrinkList(domain::DrinkSpan allDrinks);
+    std::string selectDrink(domain::DrinkSpan allDrinks);
     void displayPaymentPrompt(int amount);
     bool confirmPayment(std::chrono::seconds timeout);
     void displayPaymentProcessing();
@@ -40,7 +40,7 @@ public:
 
 private:
     int getIntegerInput(const std::string& prompt, int minVal, int maxVal);
-    bool isDrinkCodeValid(const std::string& code, const std::vector<domain::Drink>& allDrinks) const;
+    bool isDrinkCodeValid(const std::string& code, domain::DrinkSpan allDrinks) const;
 
 };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace service {
+
+/**
+ * @brief 좌표 배열(구조체 배열이 아닌 X 배열, Y 배열) 전체에 대해 기준점까지의 거리 제곱을 한 번에 계산하는 커널입니다.
+ * x86에서는 실행 중인 CPU가 지원하는 가장 넓은 명령어(AVX2, SSE4.1)를 골라 쓰고, 그 외에는 스칼라 코드로 계산합니다.
+ * 결과는 32비트이므로 좌표와 기준점의 차이가 COORD_BOUND 이내여야 합니다.
+ * DistanceService::findNearestWithStock이 격자 칸마다 호출합니다.
+ */
+class DistanceKernel {
+public:
+    /**
+     * @brief 커널 구현 종류.
+     */
+    enum class Isa {
+        SCALAR, ///< 이식 가능한 스칼라 구현
+        SSE41,  ///< 한 번에 4개 (x86 SSE4.1)
+        AVX2    ///< 한 번에 8개 (x86 AVX2)
+    };
+
+    /**
+     * @brief 좌표와 기준점의 절댓값 상한. 이 범위 안에서는 거리 제곱이 31비트를 넘지 않습니다.
+     */
+    static constexpr std::int32_t COORD_BOUND = 16384;
+
+    /**
+     * @brief 이 CPU에서 사용할 구현 (처음 호출 시 한 번 판별).
+     */
+    static Isa activeIsa();
+
+    /**
+     * @brief 구현 이름 ("scalar", "sse4.1", "avx2").
+     */
+    static const char* isaName(Isa isa);
+
+    /**
+     * @brief out[i] = (xs[i]-qx)^2 + (ys[i]-qy)^2 를 i = 0..n-1 에 대해 계산합니다 (activeIsa() 사용).
+     * @param xs X 좌표 배열.
+     * @param ys Y 좌표 배열.
+     * @param n 좌표 수.
+     * @param qx 기준 X 좌표.
+     * @param qy 기준 Y 좌표.
+     * @param out 결과를 쓸 배열 (n개 이상).
+     */
+    static void squaredDistances(const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                                 std::int32_t qx, std::int32_t qy, std::uint32_t* out);
+
+    /**
+     * @brief 구현을 지정해 계산합니다. 이 CPU가 지원하지 않는 구현을 지정하면 스칼라로 계산합니다 (벤치마크/테스트용).
+     */
+    static void squaredDistances(Isa isa, const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                                 std::int32_t qx, std::int32_t qy, std::uint32_t* out);
+
+    /**
+     * @brief 이 CPU가 해당 구현을 지원하는지 여부.
+     */
+    static bool isSupported(Isa isa);
+};
+
+} // namespace service
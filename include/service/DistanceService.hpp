@@ -2,8 +2,13 @@
 
 #include <string>
 #include <vector>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <optional> // std::optional 사용
-#include <cmath>    // std::sqrt, std::pow 사용
+#include <unordered_map>
 #include <stdexcept> // std::invalid_argument 등 예외 클래스 사용
 
 namespace domain {
@@ -27,19 +32,41 @@ struct OtherVendingMachineInfo {
 /**
  * @brief 자판기 간의 거리를 계산하고, 조건에 맞는 가장 가까운 자판기를 찾는 기능을 제공하는 서비스입니다.
  * 주로 UC10 (가장 가까운 자판기 안내)에서 사용됩니다.
+ *
+ * 응답 목록에서 찾는 findNearestAvailableVendingMachine 외에, 알고 있는 자판기와 음료별 재고 여부를
+ * 좌표 격자(GRID_SIZE x GRID_SIZE 칸)에 유지하는 공간 색인을 제공합니다. 색인 조회는 기준점이 속한 칸부터
+ * 바깥 고리 순서로 칸을 훑고, 남은 칸이 지금까지 찾은 k번째 후보보다 멀어지면 멈추므로
+ * 자판기가 수천 대여도 주변 칸만 확인합니다. 색인 메소드는 내부 뮤텍스로 보호됩니다.
+ * UserProcessController는 재고 응답을 색인에 반영하고, 선결제 대상 후보를 이 색인(findNearestWithStock)에서 고릅니다.
+ * 칸마다 좌표와 재고 여부를 X 배열, Y 배열, 재고 배열로 따로 저장해, 칸 안의 거리 제곱을
+ * DistanceKernel(SIMD)로 한 번에 계산한 뒤 분기 없이 재고 없는 자판기를 걸러 후보를 고릅니다.
+ *
+ * 거리 비교는 모두 정수 거리 제곱으로 하며, 거리가 같으면 ID의 숫자 부분이 작은 자판기를 우선합니다 (PFR R3.2).
+ * ID의 숫자 부분은 한 번만 해석하며, 숫자로 해석할 수 없는 ID는 숫자 ID 뒤에 문자열 순서로 놓입니다.
  */
 class DistanceService {
 public:
+    /**
+     * @brief 좌표 공간(0~99)을 나누는 격자의 한 변 칸 수. 한 칸은 10 x 10 좌표입니다.
+     */
+    static constexpr int GRID_SIZE = 10;
+
+    /**
+     * @brief 좌표 한 변의 크기 (PFR: 좌표는 0~99).
+     */
+    static constexpr int COORD_LIMIT = 100;
+
     /**
      * @brief DistanceService 생성자.
-     * 현재는 특별한 초기화 로직이 없습니다.
+     * 공간 색인은 비어 있는 상태로 시작합니다.
      */
-    DistanceService() = default; 
+    DistanceService() = default;
 
     /**
      * @brief 주어진 다른 자판기 정보 목록 중에서 현재 자판기를 기준으로 가장 가깝고,
      * 재고가 있는 자판기를 찾아 반환합니다. (UC10, PFR R3.2)
      * 거리가 같을 경우 자판기 ID의 숫자 부분이 작은 것을 우선합니다.
+     * 목록을 한 번만 훑으며 정렬하거나 복사하지 않습니다.
      * @param currentVmX 현재 자판기의 X 좌표.
      * @param currentVmY 현재 자판기의 Y 좌표.
      * @param otherVms 다른 자판기들의 정보(ID, 좌표, 재고 유무)를 담은 벡터.
@@ -52,33 +79,127 @@ public:
         const std::vector<OtherVendingMachineInfo>& otherVms
     ) const;
 
+    /**
+     * @brief findNearestAvailableVendingMachine과 같은 순위 기준으로, 재고가 있는 자판기를 가까운 순서로 최대 k대 반환합니다.
+     * 1순위 자판기에 선결제 예약이 실패했을 때 재고 조회를 다시 하지 않고 다음 후보로 넘어가는 데 사용합니다 (UC16).
+     * 전체를 정렬하지 않고 상위 k개만 부분 정렬합니다.
+     * @param currentVmX 현재 자판기의 X 좌표.
+     * @param currentVmY 현재 자판기의 Y 좌표.
+     * @param otherVms 다른 자판기들의 정보(ID, 좌표, 재고 유무)를 담은 벡터.
+     * @param k 최대 개수.
+     * @return 가까운 순서의 자판기 목록. 재고가 있는 자판기가 없으면 빈 벡터.
+     */
+    std::vector<domain::VendingMachine> rankNearestAvailableVendingMachines(
+        int currentVmX,
+        int currentVmY,
+        const std::vector<OtherVendingMachineInfo>& otherVms,
+        std::size_t k
+    ) const;
+
+    // --- 공간 색인 ---
+
+    /**
+     * @brief 자판기를 색인에 추가하거나, 이미 있으면 좌표를 갱신합니다. 기록된 재고 여부는 유지됩니다.
+     * @param vmId 자판기 ID.
+     * @param x X 좌표 (0~99).
+     * @param y Y 좌표 (0~99).
+     * @throws std::invalid_argument 좌표가 범위를 벗어난 경우.
+     */
+    void upsertMachine(const std::string& vmId, int x, int y);
+
+    /**
+     * @brief 자판기를 색인에서 제거합니다. 없으면 아무것도 하지 않습니다.
+     * @param vmId 자판기 ID.
+     */
+    void removeMachine(const std::string& vmId);
+
+    /**
+     * @brief 색인된 자판기의 음료 재고 여부를 기록합니다.
+     * @param vmId 자판기 ID.
+     * @param drinkCode 음료 코드 ("00"~"99").
+     * @param hasStock 재고가 있는지 여부.
+     * @return 색인에 없는 자판기이거나 음료 코드 형식이 맞지 않아 기록하지 못하면 false.
+     */
+    bool setStock(const std::string& vmId, const std::string& drinkCode, bool hasStock);
+
+    /**
+     * @brief 색인에서 음료 재고가 있는 자판기 중 가까운 순서로 최대 k대를 반환합니다.
+     * @param x 기준 X 좌표.
+     * @param y 기준 Y 좌표.
+     * @param drinkCode 음료 코드.
+     * @param k 최대 개수.
+     * @return 가까운 순서(같은 거리는 ID 순)의 자판기 목록. 포트 정보는 비어 있습니다.
+     */
+    std::vector<domain::VendingMachine> findNearestWithStock(int x, int y, const std::string& drinkCode, std::size_t k) const;
+
+    /**
+     * @brief 색인된 자판기 수.
+     */
+    std::size_t indexedMachineCount() const;
+
 private:
     /**
-     * @brief 두 좌표 간의 유클리드 직선 거리를 계산합니다.
-     * @param x1 첫 번째 지점의 X 좌표.
-     * @param y1 첫 번째 지점의 Y 좌표.
-     * @param x2 두 번째 지점의 X 좌표.
-     * @param y2 두 번째 지점의 Y 좌표.
-     * @return 두 지점 간의 거리.
+     * @brief 색인에 저장된 자판기 하나. 좌표와 재고 여부는 속한 칸(GridCell)에 저장됩니다.
+     */
+    struct IndexedMachine {
+        std::string id;
+        int numericId;          ///< ID의 숫자 부분 (숫자로 해석할 수 없으면 -1)
+        int cell;               ///< 속한 칸 번호
+        std::uint32_t cellPos;  ///< 칸 배열 안의 위치
+    };
+
+    /**
+     * @brief 격자 한 칸의 자판기들. 같은 위치의 원소가 한 자판기를 이룹니다 (구조체 배열 대신 배열 구조체).
      */
-    double calculateDistance(int x1, int y1, int x2, int y2) const {
-        // PFR 1.2: "매번 통신을 주고받을 때마다 자판기의 좌표를 받아와 직선 거리를 계산한다."
-        double dx = static_cast<double>(x1) - static_cast<double>(x2);
-        double dy = static_cast<double>(y1) - static_cast<double>(y2);
-        return std::sqrt(std::pow(dx, 2) + std::pow(dy, 2));
+    struct GridCell {
+        std::vector<std::int32_t> xs;
+        std::vector<std::int32_t> ys;
+        std::vector<std::bitset<COORD_LIMIT>> stock; ///< 음료 코드(00~99)별 재고 여부
+        std::vector<std::uint32_t> slots;            ///< machines_ 인덱스
+    };
+
+    /**
+     * @brief 순위 비교에 필요한 값 (거리 제곱과 미리 해석한 ID).
+     */
+    struct RankKey {
+        std::int64_t squaredDistance;
+        int numericId;
+        const std::string* id;
+    };
+
+    static std::int64_t squaredDistance(int x1, int y1, int x2, int y2) {
+        // 거리의 순서만 필요하므로 제곱근을 구하지 않습니다.
+        const std::int64_t dx = static_cast<std::int64_t>(x1) - x2;
+        const std::int64_t dy = static_cast<std::int64_t>(y1) - y2;
+        return dx * dx + dy * dy;
     }
 
     /**
-     * @brief 자판기 ID (예: "T1", "T12")에서 숫자 부분을 추출하여 정수로 반환합니다.
+     * @brief 자판기 ID (예: "T1", "T12")에서 숫자 부분을 추출합니다.
      * ID는 'T' 또는 't'로 시작하고 그 뒤에 숫자가 오는 형식을 가정합니다.
      * (PFR R3.2: "거리가 같다면 id의 숫자가 작은 자판기로 안내한다.")
      * @param vmId 추출할 자판기의 ID 문자열.
-     * @return 추출된 숫자.
-     * @throws std::invalid_argument ID 형식이 올바르지 않거나 숫자 변환에 실패한 경우.
+     * @return 추출된 숫자. 형식이 맞지 않으면 -1 (예외를 던지지 않음).
      */
-    int extractNumericId(const std::string& vmId) const;
-};
+    static int parseNumericId(const std::string& vmId);
 
-} // namespace service
+    /**
+     * @brief a가 b보다 앞 순위이면 true. 거리, ID 숫자(숫자 ID가 먼저), ID 문자열 순으로 비교합니다.
+     */
+    static bool ranksBefore(const RankKey& a, const RankKey& b);
+
+    static int parseDrinkCode(const std::string& drinkCode);
+    static int cellOf(int coord);
 
+    // 칸에 자판기를 넣고 빼며 machines_의 위치 정보를 함께 갱신합니다 (indexMtx_를 잡은 상태에서 호출).
+    void addToCell(std::uint32_t slot, int cell, int x, int y, const std::bitset<COORD_LIMIT>& stock);
+    std::bitset<COORD_LIMIT> removeFromCell(std::uint32_t slot);
 
+    mutable std::mutex indexMtx_;
+    std::vector<IndexedMachine> machines_;
+    std::unordered_map<std::string, std::size_t> slotById_;
+    std::array<GridCell, GRID_SIZE * GRID_SIZE> cells_;
+    mutable std::vector<std::uint32_t> distanceScratch_; ///< 칸 하나의 거리 제곱 계산 결과 (indexMtx_로 보호)
+};
+
+} // namespace service
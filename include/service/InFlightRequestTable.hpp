@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "network/message.hpp"
+
+namespace service {
+
+/**
+ * @brief 응답을 기다리는 요청(REQ_STOCK, REQ_PREPAY)을 상관관계 ID로 추적하는 고정 크기 테이블입니다.
+ * 요청마다 고유한 corr_id를 발급하고, 도착한 응답을 해당 요청의 콜백으로 바로 전달합니다.
+ * 기한이 지난 요청, 이미 끝난 요청, 같은 자판기의 중복 응답은 콜백에 닿기 전에 버립니다.
+ *
+ * corr_id를 돌려주지 않는 표준 피어의 응답은 (응답 타입, item_code, 대상 자판기)가 같은
+ * 가장 최근 요청에 연결합니다 (브로드캐스트 요청은 어느 자판기의 응답이든 받음).
+ *
+ * 슬롯 점유와 조회는 원자적 상태 값에 대한 CAS로 이루어지며 뮤텍스를 쓰지 않습니다.
+ * 다만 lock-free는 아닙니다: 한 슬롯에 응답이 동시에 도착하면 먼저 슬롯을 잡은 스레드가 놓을 때까지
+ * 나머지는 양보(yield)하며 기다리는 짧은 스핀 락처럼 동작합니다. 슬롯을 잡고 하는 일은 필드 확인과 복사뿐이며
+ * 콜백은 슬롯을 놓은 뒤 호출되므로 기다리는 시간은 짧습니다.
+ * 기한이 지난 슬롯은 별도 타이머 없이 조회/등록 시점에 회수됩니다.
+ */
+class InFlightRequestTable {
+public:
+    /**
+     * @brief 요청에 연결된 응답을 받을 콜백 타입입니다. 응답을 수신한 스레드에서 호출됩니다.
+     */
+    using ResponseHandler = std::function<void(const network::Message& response)>;
+
+    /**
+     * @brief 동시에 추적할 수 있는 최대 요청 수입니다.
+     */
+    static constexpr std::size_t CAPACITY = 64;
+
+    /**
+     * @brief route()의 처리 결과입니다.
+     */
+    enum class RouteResult {
+        DELIVERED, ///< 대기 중인 요청의 콜백으로 전달함
+        DUPLICATE, ///< 같은 요청에 같은 자판기가 이미 응답함: 버림
+        STALE,     ///< 기한이 지났거나 이미 끝난 요청에 대한 응답: 버림
+        UNMATCHED  ///< 연결할 요청이 없음 (응답 타입이 아니거나 corr_id 없이 일치하는 요청이 없음): 버림
+    };
+
+    /**
+     * @brief 누적 처리 통계입니다.
+     */
+    struct Stats {
+        std::uint64_t delivered = 0;
+        std::uint64_t duplicates = 0;
+        std::uint64_t stale = 0;
+        std::uint64_t unmatched = 0;
+    };
+
+    InFlightRequestTable();
+
+    /**
+     * @brief 응답을 기다릴 요청을 등록하고 요청에 실을 corr_id를 발급합니다.
+     * @param responseType 기다리는 응답 타입 (RESP_STOCK 또는 RESP_PREPAY).
+     * @param itemCode 요청한 음료 코드 (corr_id 없는 응답을 연결할 때 사용).
+     * @param peerId 요청을 보낸 자판기 ID. 브로드캐스트는 "0".
+     * @param expectedResponses 이 수만큼 서로 다른 자판기가 응답하면 기한 전이라도 요청을 끝냅니다 (0이면 기한까지 유지).
+     * @param timeout 응답을 받아들이는 기간.
+     * @param handler 응답마다 호출될 콜백.
+     * @return 발급된 corr_id. 테이블이 가득 차면 빈 문자열을 반환하며 요청은 등록되지 않습니다.
+     */
+    std::string insert(network::MessageType responseType, const std::string& itemCode, const std::string& peerId,
+                       std::size_t expectedResponses, std::chrono::milliseconds timeout, ResponseHandler handler);
+
+    /**
+     * @brief 수신된 응답을 대기 중인 요청에 연결해 콜백을 호출합니다.
+     * @param response 수신된 응답 메시지.
+     * @return 처리 결과. DELIVERED가 아니면 응답은 버려진 것입니다.
+     */
+    RouteResult route(const network::Message& response);
+
+    /**
+     * @brief 등록된 요청을 기한 전에 끝냅니다. 이후 도착하는 응답은 STALE로 버려집니다.
+     * @param corrId insert()가 발급한 corr_id.
+     */
+    void cancel(const std::string& corrId);
+
+    /**
+     * @brief 현재까지의 처리 통계를 반환합니다.
+     */
+    Stats stats() const;
+
+private:
+    enum SlotState : std::uint8_t {
+        FREE = 0,   ///< 비어 있음
+        CLAIMED,    ///< 한 스레드가 필드를 쓰거나 지우는 중
+        ACTIVE,     ///< 응답 대기 중
+        DELIVERING  ///< 한 스레드가 응답을 처리하는 중
+    };
+
+    struct Slot {
+        std::atomic<std::uint8_t> state{FREE};
+        std::atomic<std::uint64_t> id{0};       ///< 발급된 ID (0은 사용하지 않음)
+        std::atomic<std::uint64_t> matchKey{0}; ///< corr_id 없는 응답을 빠르게 거르기 위한 (타입, 음료, 대상) 해시
+        std::atomic<std::int64_t> deadlineNs{0};
+        // 아래 필드는 CLAIMED 또는 DELIVERING 상태를 가진 스레드만 읽고 씁니다.
+        network::MessageType responseType{};
+        std::string itemCode;
+        std::string peerId;
+        std::size_t expectedResponses = 0;
+        std::vector<std::string> responders;
+        ResponseHandler handler;
+    };
+
+    static std::int64_t nowNs();
+    static std::uint64_t makeMatchKey(network::MessageType type, const std::string& itemCode, const std::string& peerId);
+    static std::string formatId(std::uint64_t id);
+    static bool parseId(const std::string& text, std::uint64_t& id);
+
+    bool tryClaim(Slot& slot, std::int64_t now);
+    Slot* findById(std::uint64_t id);
+    Slot* findByFallback(const network::Message& response);
+    bool acquireForDelivery(Slot& slot, std::uint64_t expectedId);
+    void release(Slot& slot);
+
+    std::array<Slot, CAPACITY> slots_;
+    const std::uint64_t salt_;                  ///< 재시작 전 요청의 응답과 ID가 겹치지 않도록 상위 32비트에 넣는 값
+    std::atomic<std::uint32_t> next_sequence_{1};
+
+    std::atomic<std::uint64_t> delivered_{0};
+    std::atomic<std::uint64_t> duplicates_{0};
+    std::atomic<std::uint64_t> stale_{0};
+    std::atomic<std::uint64_t> unmatched_{0};
+};
+
+} // namespace service
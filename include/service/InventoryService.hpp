@@ -1,10 +1,16 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 #include <utility> 
 
 #include "domain/drink.h" // domain::Drink 객체 사용
+#include "service/StockHoldTable.hpp"
 
 namespace persistence {
     class InventoryRepository;
@@ -20,27 +26,49 @@ namespace service {
  * @brief 자판기의 재고 관련 비즈니스 로직을 처리하는 서비스입니다.
  * 음료 목록 조회, 특정 음료의 재고 및 가격 확인, 재고 차감 등의 기능을 제공합니다.
  * 관련된 유스케이스: UC1, UC2, UC3, UC7, UC15, UC17
+ *
+ * 다른 자판기의 선결제 요청(UC15)은 재고를 바로 없애지 않고 만료 시각이 있는 홀드로 잡아둡니다 (holdStock).
+ * 구매자가 인증 코드로 음료를 받으면 홀드를 확정(commitHold)하고, 나타나지 않으면 만료된 홀드가 재고로 되돌아갑니다.
+ * 홀드한 수량은 리포지토리 재고에서 먼저 빠지므로, 조회되는 재고는 항상 "보유 수량 - 홀드 수량"입니다.
+ * 홀드 자체도 리포지토리(InventoryRepository)에 기록되어 로그로 남고, 재시작 후 restoreHolds()가 만료 타이머를 다시 만듭니다.
+ * 만료 처리는 재고 확인·홀드 시 지나간 타이머 휠 칸만 훑어 한꺼번에 합니다.
  */
 class InventoryService {
 public:
+    using Clock = StockHoldTable::Clock;
+
+    /**
+     * @brief 선결제 홀드의 기본 유지 시간.
+     */
+    static constexpr std::chrono::seconds DEFAULT_HOLD_TTL{600};
+
     /**
      * @brief InventoryService 생성자.
      * @param inventoryRepo 재고 데이터 관리를 위한 InventoryRepository 객체에 대한 참조.
      * @param drinkRepo 음료 기본 정보 관리를 위한 DrinkRepository 객체에 대한 참조.
      * @param errorService 오류 처리를 위한 ErrorService 객체에 대한 참조.
+     * @param holdTtl 선결제 홀드 유지 시간.
      */
     InventoryService(
         persistence::InventoryRepository& inventoryRepo,
         persistence::DrinkRepository& drinkRepo,
-        service::ErrorService& errorService
+        service::ErrorService& errorService,
+        Clock::duration holdTtl = DEFAULT_HOLD_TTL
     );
 
     /**
      * @brief 시스템에 정의된 모든 음료 종류의 목록을 반환합니다. (UC1)
-     * @return 모든 음료의 domain::Drink 객체를 담은 벡터.
-     * 오류 발생 시 빈 벡터를 반환하고 ErrorService를 통해 오류를 보고합니다.
+     * @return 컴파일 시간 카탈로그 전체를 가리키는 뷰 (복사하지 않음).
+     * 오류 발생 시 빈 뷰를 반환하고 ErrorService를 통해 오류를 보고합니다.
      */
-    std::vector<domain::Drink> getAllDrinkTypes();
+    domain::DrinkSpan getAllDrinkTypes();
+
+    /**
+     * @brief 음료 코드로 음료 정보를 상수 시간에 조회합니다. (UC2, UC14)
+     * @param drinkCode 조회할 음료 코드.
+     * @return 음료 정보에 대한 포인터. 메뉴에 없는 코드이면 nullptr (오류 보고는 호출하는 쪽에서 함).
+     */
+    const domain::Drink* findDrinkType(const std::string& drinkCode) const;
 
     /**
      * @brief 특정 음료의 현재 자판기 내 판매 가능 여부, 가격, 실제 재고량을 담는 구조체.
@@ -69,14 +97,71 @@ public:
      * @brief 특정 음료의 재고를 지정된 수량만큼 감소시킵니다. (주로 외부 선결제 요청 처리 시 사용 - UC15)
      * @param drinkCode 재고를 감소시킬 음료의 코드.
      * @param amount 감소시킬 수량.
+     * @return 차감했으면 true. 확인 후 다른 스레드가 먼저 차감해 재고가 모자라면 false.
      * 오류(재고 부족 등) 발생 시 ErrorService를 통해 보고합니다.
      */
-    void decreaseStockByAmount(const std::string& drinkCode, int amount);
+    bool decreaseStockByAmount(const std::string& drinkCode, int amount);
+
+    // --- 선결제 홀드 (UC15, UC14) ---
+
+    /**
+     * @brief 다른 자판기의 선결제 요청에 대해 재고를 홀드합니다. (UC15)
+     * 재고 부족은 오류가 아니므로 ErrorService에 보고하지 않습니다.
+     * @param holdId 홀드 ID (선결제 인증 코드).
+     * @param drinkCode 음료 코드.
+     * @param amount 홀드할 수량.
+     * @param now 기준 시각 (만료 시각 = now + holdTtl).
+     * @return 재고가 충분하고 같은 ID의 홀드가 없어 홀드했으면 true.
+     */
+    bool holdStock(const std::string& holdId, const std::string& drinkCode, int amount, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 홀드를 확정합니다. 홀드된 수량은 이미 재고에서 빠져 있으므로 기록만 지웁니다. (UC14)
+     * @return 확정할 홀드가 있었으면 true. 만료되었거나 없으면 false.
+     */
+    bool commitHold(const std::string& holdId);
+
+    /**
+     * @brief 만료되어 재고로 되돌아간 홀드를 꺼냅니다. 확정이 늦은 구매자에게 잡아뒀던 수량만큼 다시 차감할 때 씁니다.
+     * 만료된 홀드는 만료 후 holdTtl 동안만 기억합니다.
+     * @return 기억하고 있는 만료된 홀드. 없으면 std::nullopt.
+     */
+    std::optional<StockHoldTable::Hold> takeExpiredHold(const std::string& holdId);
+
+    /**
+     * @brief 홀드를 취소하고 수량을 재고로 되돌립니다.
+     * @return 취소할 홀드가 있었으면 true.
+     */
+    bool releaseHold(const std::string& holdId);
+
+    /**
+     * @brief 리포지토리에 남아 있는 홀드(재시작 전에 잡아둔 홀드)의 만료 타이머를 다시 만듭니다. 복원 직후 한 번 호출합니다.
+     * 재시작 중에 만료 시각이 지난 홀드는 다음 만료 처리 때 재고로 돌아갑니다.
+     * @return 다시 만든 홀드 수.
+     */
+    std::size_t restoreHolds(Clock::time_point now = Clock::now());
+
+    /**
+     * @brief now까지 만료된 홀드를 재고로 되돌립니다.
+     * @return 되돌린 홀드 수.
+     */
+    std::size_t reapExpiredHolds(Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 음료별로 홀드되어 있는 수량 (보유 수량 = 조회되는 재고 + 이 값).
+     */
+    int heldStock(const std::string& drinkCode) const;
 
 private:
+    void returnToStock(const StockHoldTable::Hold& hold);
+
     persistence::InventoryRepository& inventoryRepository_; ///< 재고 데이터 접근용 리포지토리
     persistence::DrinkRepository& drinkRepository_;       ///< 음료 기본 정보 접근용 리포지토리
     service::ErrorService& errorService_;                 ///< 오류 처리용 서비스
+    Clock::duration holdTtl_;                             ///< 선결제 홀드 유지 시간
+    StockHoldTable holds_;                                ///< 선결제 홀드와 만료 타이머 휠
+    std::mutex expiredMtx_;
+    std::deque<StockHoldTable::Hold> expiredHolds_;       ///< 만료된 홀드 (만료 순서, 만료 후 holdTtl까지)
 };
 
 } // namespace service
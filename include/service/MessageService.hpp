@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <chrono>
 #include <unordered_map> // std::map에서 변경됨
 
 // --- 필요한 타입들의 전체 정의를 먼저 포함 ---
@@ -10,6 +11,8 @@
 #include "network/MessageSender.hpp"   // network::MessageSender 정의
 #include "network/MessageReceiver.hpp" // network::MessageReceiver 및 network::EnumClassHash 정의
 #include "service/ErrorService.hpp"    // service::ErrorService 정의
+#include "service/InFlightRequestTable.hpp" // 응답 대기 중인 요청 추적
+#include "service/PeerStockCache.hpp"       // 다른 자판기 재고 캐시
 
 namespace service {
 
@@ -20,9 +23,27 @@ using GenericMessageHandler = std::function<void(const network::Message& message
  * @brief 다른 자판기와의 메시지 송수신을 담당하는 서비스입니다.
  * MessageSender와 MessageReceiver를 사용하여 네트워크 통신을 수행하고,
  * 수신된 메시지에 따라 등록된 핸들러(주로 UserProcessController의 메소드)를 호출합니다.
+ * 모든 요청(REQ_STOCK, REQ_PREPAY)에는 corr_id를 붙여 InFlightRequestTable에 등록하고,
+ * 응답(RESP_STOCK, RESP_PREPAY)은 해당 요청의 콜백으로만 전달합니다. 기한이 지났거나 중복된 응답은 여기서 버립니다.
+ * 버려지는 응답을 포함해 수신된 모든 RESP_STOCK/RESP_PREPAY의 재고 정보는 PeerStockCache에 기록합니다.
  */
 class MessageService {
 public:
+    /**
+     * @brief 요청 하나에 대한 응답을 받을 콜백 타입입니다. 응답을 수신한 io_context 스레드에서 호출됩니다.
+     */
+    using ResponseHandler = InFlightRequestTable::ResponseHandler;
+
+    /**
+     * @brief 콜백 없이 보낸 재고 조회 요청의 응답을 받아들이는 기간 (UC9 E2).
+     */
+    static constexpr std::chrono::milliseconds DEFAULT_STOCK_RESPONSE_TIMEOUT{3000};
+
+    /**
+     * @brief 콜백 없이 보낸 선결제 요청의 응답을 받아들이는 기간.
+     */
+    static constexpr std::chrono::milliseconds DEFAULT_PREPAY_RESPONSE_TIMEOUT{10000};
+
     /**
      * @brief MessageService 생성자.
      * @param sender 메시지 송신을 위한 MessageSender 객체에 대한 참조.
@@ -53,27 +74,59 @@ public:
     /**
      * @brief 재고 조회 요청 (REQ_STOCK)을 모든 다른 자판기에 브로드캐스트합니다. (UC8)
      * PFR 표1: 재고 확인 요청 시의 msg format 준수.
+     * 응답은 DEFAULT_STOCK_RESPONSE_TIMEOUT 동안 registerMessageHandler(RESP_STOCK)로 등록된 핸들러에 전달됩니다.
      * @param drinkCode 조회할 음료의 코드.
      */
     void sendStockRequestBroadcast(const std::string& drinkCode);
 
+    /**
+     * @brief 재고 조회 요청 (REQ_STOCK)을 브로드캐스트하고, 이 요청에 대한 응답만 onResponse로 받습니다. (UC8, UC9)
+     * 모든 자판기가 응답하거나 timeout이 지나면 요청이 끝나며, 이후 도착한 응답과 같은 자판기의 중복 응답은 버려집니다.
+     * @param drinkCode 조회할 음료의 코드.
+     * @param timeout 응답을 받아들이는 기간.
+     * @param onResponse RESP_STOCK 응답마다 호출될 콜백.
+     * @return 요청에 붙인 corr_id (cancelRequest에 사용). 전송하지 못했으면 빈 문자열.
+     */
+    std::string sendStockRequestBroadcast(const std::string& drinkCode, std::chrono::milliseconds timeout, ResponseHandler onResponse);
+
     /**
      * @brief 특정 자판기에 선결제 재고 확보 요청 (REQ_PREPAY)을 전송합니다. (UC16)
      * PFR 표3: 선결제 요청 시의 msg format 준수.
      * @param targetVmId 대상 자판기의 ID.
      * @param drinkCode 예약할 음료의 코드.
      * @param authCode 생성된 인증 코드.
+     * 응답은 DEFAULT_PREPAY_RESPONSE_TIMEOUT 동안 registerMessageHandler(RESP_PREPAY)로 등록된 핸들러에 전달됩니다.
      */
     void sendPrepaymentReservationRequest(const std::string& targetVmId, const std::string& drinkCode, const std::string& authCode);
 
+    /**
+     * @brief 특정 자판기에 선결제 재고 확보 요청 (REQ_PREPAY)을 보내고, 그 응답 하나만 onResponse로 받습니다. (UC16)
+     * @param targetVmId 대상 자판기의 ID.
+     * @param drinkCode 예약할 음료의 코드.
+     * @param authCode 생성된 인증 코드.
+     * @param timeout 응답을 받아들이는 기간.
+     * @param onResponse RESP_PREPAY 응답을 받을 콜백.
+     * @return 요청에 붙인 corr_id (cancelRequest에 사용). 전송하지 못했으면 빈 문자열.
+     */
+    std::string sendPrepaymentReservationRequest(const std::string& targetVmId, const std::string& drinkCode, const std::string& authCode,
+                                                 std::chrono::milliseconds timeout, ResponseHandler onResponse);
+
+    /**
+     * @brief 응답을 기다리는 요청을 기한 전에 끝냅니다. 이후 도착하는 응답은 버려집니다.
+     * @param corrId 요청 전송 시 반환된 corr_id.
+     */
+    void cancelRequest(const std::string& corrId);
+
     /**
      * @brief 다른 자판기의 재고 조회 요청(REQ_STOCK)에 대한 응답(RESP_STOCK)을 전송합니다. (UC17)
      * PFR 표2: 재고 확인 응답 시의 msg format 준수.
      * @param destinationVmId 응답을 받을 자판기(요청을 보낸 자판기)의 ID.
      * @param drinkCode 조회 요청받은 음료의 코드.
      * @param currentStock 해당 음료의 현재 재고량 (0~99).
+     * @param corrId 요청에 실려 온 corr_id. 그대로 돌려주어 요청 측이 응답을 연결하게 합니다 (없으면 빈 문자열).
      */
-    void sendStockResponse(const std::string& destinationVmId, const std::string& drinkCode, int currentStock);
+    void sendStockResponse(const std::string& destinationVmId, const std::string& drinkCode, int currentStock,
+                           const std::string& corrId = std::string());
 
     /**
      * @brief 다른 자판기의 선결제 재고 확보 요청(REQ_PREPAY)에 대한 응답(RESP_PREPAY)을 전송합니다. (UC15)
@@ -82,19 +135,28 @@ public:
      * @param drinkCode 요청받은 음료의 코드.
      * @param reservedItemNum 실제로 확보(예약)된 음료의 수량 (성공 시 요청 수량, 실패 시 0).
      * @param available 재고 확보 및 선결제 처리 가능 여부 (T/F).
+     * @param corrId 요청에 실려 온 corr_id (없으면 빈 문자열).
      */
-    void sendPrepaymentReservationResponse(const std::string& destinationVmId, const std::string& drinkCode, int reservedItemNum, bool available);
+    void sendPrepaymentReservationResponse(const std::string& destinationVmId, const std::string& drinkCode, int reservedItemNum, bool available,
+                                           const std::string& corrId = std::string());
 
     // --- 메시지 수신 핸들러 등록 ---
 
     /**
      * @brief 특정 메시지 타입에 대한 처리 핸들러를 등록합니다.
      * UserProcessController 등 외부에서 이 메소드를 호출하여 각 메시지 타입에 대한 콜백 함수를 설정합니다.
+     * 응답 타입(RESP_STOCK, RESP_PREPAY)의 핸들러는 콜백 없이 보낸 요청의 응답만 받습니다.
      * @param type 처리할 메시지의 타입 (network::Message::Type).
      * @param handler 해당 타입의 메시지를 받았을 때 호출될 함수 객체.
      */
     void registerMessageHandler(network::Message::Type type, GenericMessageHandler handler);
 
+    /**
+     * @brief 다른 자판기들이 알려준 재고 캐시를 반환합니다.
+     * 이 서비스가 수신한 RESP_STOCK/RESP_PREPAY로 채워지며, UserProcessController가 브로드캐스트 전에 조회합니다.
+     */
+    PeerStockCache& peerStockCache() { return peerStock_; }
+
 private:
     network::MessageSender& messageSender_;     // 메시지 송신용 객체
     network::MessageReceiver& messageReceiver_; // 메시지 수신용 객체
@@ -103,14 +165,30 @@ private:
     std::string myVmId_;    // 이 자판기의 ID
     int myCoordX_;          // 이 자판기의 X 좌표
     int myCoordY_;          // 이 자판기의 Y 좌표
+    InFlightRequestTable inFlight_; // 응답을 기다리는 요청 (corr_id별)
+    PeerStockCache peerStock_;      // 수신한 응답으로 채우는 다른 자판기 재고
+
+    /**
+     * @brief 콜백 없이 보낸 요청의 응답을 registerMessageHandler로 등록된 핸들러에 넘기는 콜백을 만듭니다.
+     */
+    ResponseHandler forwardToRegisteredHandler();
 
     /**
      * @brief MessageReceiver로부터 모든 타입의 메시지를 받아,
      * 등록된 핸들러 맵(messageHandlers_)을 참조하여 적절한 핸들러를 호출하는 내부 콜백.
+     * 응답 메시지는 inFlight_를 거쳐 요청별 콜백으로 전달되며, 연결할 요청이 없으면 버립니다.
      * @param msg 수신된 network::Message 객체.
      */
     void onMessageReceived(const network::Message& msg);
 
+    /**
+     * @brief 대상별 전송 실패를 ErrorService에 MESSAGE_SEND_FAILED로 보고하는 콜백을 만듭니다.
+     * 전송은 비동기로 이루어지므로 실패는 send() 반환 이후 io_context 스레드에서 보고됩니다.
+     * @param context 오류 메시지 앞에 붙일 설명 (예: "재고 응답 전송 실패").
+     * @return MessageSender::send()에 넘길 대상별 결과 콜백.
+     */
+    network::MessageSender::PeerHandler reportSendFailure(const std::string& context);
+
     // 등록된 메시지 타입별 핸들러들을 저장하는 맵
     // Key: network::Message::Type, Value: GenericMessageHandler, Hash: network::EnumClassHash
     std::unordered_map<network::Message::Type, GenericMessageHandler, network::EnumClassHash> messageHandlers_;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "service/DistanceService.hpp" // service::OtherVendingMachineInfo
+
+namespace service {
+
+/**
+ * @brief 다른 자판기가 알려준 음료 재고를 (자판기 ID, 음료 코드)별로 보관하는 캐시입니다.
+ * MessageService가 수신한 모든 RESP_STOCK과, 재고 변화를 알 수 있는 RESP_PREPAY로 채워집니다.
+ * 일정 기간 안에 받은 값만 조회되므로, 같은 음료를 곧 다시 조회할 때 브로드캐스트 왕복을 기다리지 않아도 됩니다.
+ * 모든 메소드는 내부 뮤텍스로 보호되어 io_context 스레드와 메인 스레드에서 동시에 호출할 수 있습니다.
+ */
+class PeerStockCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 자판기 하나의 음료 하나에 대한 마지막으로 알려진 재고입니다.
+     */
+    struct Entry {
+        std::string vmId;      ///< 자판기 ID
+        int stock = 0;         ///< 재고 수량
+        int coordX = 0;        ///< 자판기 X 좌표
+        int coordY = 0;        ///< 자판기 Y 좌표
+        Clock::time_point updatedAt; ///< 값을 받은 시각
+    };
+
+    /**
+     * @brief RESP_STOCK으로 받은 재고를 기록합니다. 같은 키의 이전 값은 덮어씁니다.
+     * @param vmId 응답한 자판기 ID.
+     * @param drinkCode 음료 코드.
+     * @param stock 재고 수량.
+     * @param coordX 자판기 X 좌표.
+     * @param coordY 자판기 Y 좌표.
+     * @param at 값을 받은 시각.
+     */
+    void update(const std::string& vmId, const std::string& drinkCode, int stock, int coordX, int coordY,
+                Clock::time_point at = Clock::now());
+
+    /**
+     * @brief 선결제 예약 결과(RESP_PREPAY)를 캐시에 반영합니다.
+     * 예약에 성공하면 기록된 재고에서 예약 수량을 빼고, 실패하면 그 자판기의 값은 더 이상 믿을 수 없으므로 지웁니다.
+     * 기록이 없으면 아무것도 하지 않습니다 (좌표를 모르므로 새 항목을 만들지 않음).
+     * @param vmId 응답한 자판기 ID.
+     * @param drinkCode 음료 코드.
+     * @param reservedItemNum 예약된 수량.
+     * @param available 예약 성공 여부.
+     */
+    void applyReservation(const std::string& vmId, const std::string& drinkCode, int reservedItemNum, bool available);
+
+    /**
+     * @brief maxAge 안에 받은 음료 재고 기록을 모두 반환합니다 (재고 없음 기록 포함).
+     * @param drinkCode 음료 코드.
+     * @param maxAge 허용하는 최대 경과 시간.
+     * @param now 기준 시각.
+     * @return 자판기별 재고 정보. hasStock은 재고가 1 이상인지 여부입니다.
+     */
+    std::vector<OtherVendingMachineInfo> freshEntries(const std::string& drinkCode, std::chrono::milliseconds maxAge,
+                                                      Clock::time_point now = Clock::now()) const;
+
+    /**
+     * @brief 모든 기록을 지웁니다.
+     */
+    void clear();
+
+private:
+    Entry* find(const std::string& vmId, const std::string& drinkCode);
+
+    mutable std::mutex mtx_;
+    /// 음료 코드별 자판기 기록. 자판기 수가 적어 음료 하나의 기록은 작은 벡터로 충분합니다.
+    std::unordered_map<std::string, std::vector<Entry>> entriesByDrink_;
+};
+
+} // namespace service
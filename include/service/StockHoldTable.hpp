@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace service {
+
+/**
+ * @brief 만료 시각이 있는 재고 홀드(선결제 예약으로 잡아둔 수량)를 보관합니다.
+ * 홀드는 ID(선결제 인증 코드)로 찾고, 만료 처리는 타이머 휠로 합니다. 휠은 tick 간격의 칸 wheelSlots개로 이루어지며,
+ * 홀드는 만료 tick에 해당하는 칸에 들어가므로 reapExpired는 지난 호출 이후 지나간 칸만 훑어 만료된 홀드를 한꺼번에 꺼냅니다.
+ * 확정·취소된 홀드의 칸 항목은 바로 지우지 않고, 그 칸을 지날 때 버립니다.
+ * 모든 메소드는 내부 뮤텍스로 보호되어 io_context 스레드와 메인 스레드에서 동시에 호출할 수 있습니다.
+ */
+class StockHoldTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief 홀드 하나.
+     */
+    struct Hold {
+        std::string id;        ///< 홀드 ID (선결제 인증 코드)
+        std::string drinkCode; ///< 음료 코드
+        int amount = 0;        ///< 잡아둔 수량
+        Clock::time_point expiresAt; ///< 이 시각이 지나면 만료
+    };
+
+    /**
+     * @brief StockHoldTable 생성자.
+     * @param tick 휠 한 칸의 시간 간격. 만료는 최대 tick만큼 늦게 처리될 수 있습니다.
+     * @param wheelSlots 휠의 칸 수. tick * wheelSlots보다 먼 만료도 처리되지만, 그 사이에 칸을 여러 번 지나게 됩니다.
+     * @param origin 휠의 기준 시각.
+     */
+    explicit StockHoldTable(Clock::duration tick = std::chrono::seconds(1), std::size_t wheelSlots = 1024,
+                            Clock::time_point origin = Clock::now());
+
+    /**
+     * @brief 홀드를 추가합니다.
+     * @return 같은 ID의 홀드가 이미 있으면 false (추가하지 않음).
+     */
+    bool add(const std::string& id, const std::string& drinkCode, int amount, Clock::time_point expiresAt);
+
+    /**
+     * @brief 홀드를 꺼냅니다 (확정 또는 취소).
+     * @return 꺼낸 홀드. 없거나 이미 만료되어 꺼내진 경우 std::nullopt.
+     */
+    std::optional<Hold> remove(const std::string& id);
+
+    /**
+     * @brief now까지 만료된 홀드를 모두 꺼냅니다.
+     * @param now 기준 시각.
+     * @return 만료된 홀드 목록.
+     */
+    std::vector<Hold> reapExpired(Clock::time_point now = Clock::now());
+
+    /**
+     * @brief 음료 코드별로 잡혀 있는 수량의 합.
+     */
+    int heldQuantity(const std::string& drinkCode) const;
+
+    /**
+     * @brief 남아 있는 홀드 수.
+     */
+    std::size_t size() const;
+
+private:
+    /**
+     * @brief 휠 칸에 들어가는 항목. 같은 ID가 다시 쓰였을 때를 구분하기 위해 순번을 함께 둡니다.
+     */
+    struct WheelEntry {
+        std::string id;
+        std::uint64_t sequence;
+    };
+
+    struct Slot {
+        Hold hold;
+        std::uint64_t sequence;
+    };
+
+    std::int64_t tickFloor(Clock::time_point at) const;
+    std::int64_t tickCeil(Clock::time_point at) const;
+
+    const Clock::duration tick_;
+    const Clock::time_point origin_;
+
+    mutable std::mutex mtx_;
+    std::vector<std::vector<WheelEntry>> wheel_;
+    std::int64_t lastReapedTick_;
+    std::uint64_t nextSequence_ = 0;
+    std::unordered_map<std::string, Slot> holds_;
+    std::unordered_map<std::string, int> heldByDrink_;
+};
+
+} // namespace service
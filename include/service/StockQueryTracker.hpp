@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "service/DistanceService.hpp" // service::OtherVendingMachineInfo
+
+namespace service {
+
+/**
+ * @brief 주변 자판기 재고 조회(UC8, UC9)를 언제 끝낼지 정하는 정책입니다.
+ * 어떤 정책이든 모든 자판기가 응답하면 조회를 끝냅니다.
+ */
+enum class StockQueryPolicy {
+    ALL,             ///< 모든 자판기가 응답(재고 유무 무관)할 때까지 기다림
+    FIRST,           ///< 재고가 있다는 첫 응답에서 끝냄
+    QUORUM,          ///< quorum 이상의 자판기가 응답했고 그중 재고가 있는 곳이 있으면 끝냄
+    NEAREST_POSSIBLE ///< 아직 응답하지 않은 자판기가 모두 현재 후보보다 멀어 답이 더 좋아질 수 없으면 끝냄
+};
+
+/**
+ * @brief 좌표를 미리 알고 있는 다른 자판기입니다 (NEAREST_POSSIBLE 판단에 사용).
+ */
+struct PeerLocation {
+    std::string id; ///< 자판기 ID
+    int coordX;     ///< X 좌표
+    int coordY;     ///< Y 좌표
+};
+
+/**
+ * @brief 재고 조회 종료 조건 설정입니다.
+ */
+struct StockQueryOptions {
+    StockQueryPolicy policy = StockQueryPolicy::ALL;
+    std::size_t quorum = 1;               ///< QUORUM 정책에서 필요한 응답 수
+    std::vector<PeerLocation> knownPeers; ///< 좌표를 아는 자판기 목록. 목록에 없는 자판기가 남아 있으면 NEAREST_POSSIBLE은 끝내지 않음
+    /// 이 기간 안에 받은 재고 캐시(PeerStockCache)만으로 정책이 만족되면 브로드캐스트 응답을 기다리지 않음 (0이면 캐시 사용 안 함)
+    std::chrono::milliseconds cacheMaxAge{0};
+};
+
+/**
+ * @brief 재고 조회 한 번의 응답을 모아, 정책에 따라 결과가 더 이상 나아질 수 없는 시점을 알려줍니다.
+ * 재고가 없다는 응답도 "응답한 자판기"로 세므로, 재고 없는 자판기 하나 때문에 타임아웃까지 기다리지 않습니다.
+ * 스레드 안전하지 않으며, 호출하는 쪽(UserProcessController)의 뮤텍스 안에서 사용합니다.
+ */
+class StockQueryTracker {
+public:
+    /**
+     * @brief StockQueryTracker 생성자.
+     * @param options 종료 정책과 알고 있는 자판기 좌표.
+     * @param myX 현재 자판기의 X 좌표.
+     * @param myY 현재 자판기의 Y 좌표.
+     * @param totalPeers 응답할 수 있는 다른 자판기의 총 수.
+     */
+    StockQueryTracker(StockQueryOptions options, int myX, int myY, std::size_t totalPeers);
+
+    /**
+     * @brief 새 조회를 위해 이전 조회의 응답 기록을 지웁니다.
+     */
+    void reset();
+
+    /**
+     * @brief 응답 하나를 기록합니다. 같은 자판기의 두 번째 응답은 무시합니다.
+     * @param response 응답한 자판기의 ID, 좌표, 재고 유무.
+     * @return 처음 받은 응답이면 true.
+     */
+    bool recordResponse(const OtherVendingMachineInfo& response);
+
+    /**
+     * @brief 지금까지의 응답만으로 조회를 끝내도 되는지 반환합니다.
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief 지금까지 응답한 자판기 수 (재고 유무 무관).
+     */
+    std::size_t responseCount() const { return responders_.size(); }
+
+    /**
+     * @brief 응답할 수 있는 다른 자판기의 총 수.
+     */
+    std::size_t totalPeers() const { return totalPeers_; }
+
+    /**
+     * @brief 생성 시 받은 설정.
+     */
+    const StockQueryOptions& options() const { return options_; }
+
+private:
+    std::int64_t squaredDistanceTo(int x, int y) const;
+    bool hasResponded(const std::string& id) const;
+    bool nearestCannotImprove() const;
+
+    StockQueryOptions options_;
+    int myX_;
+    int myY_;
+    std::size_t totalPeers_;
+
+    std::vector<std::string> responders_;
+    bool hasCandidate_ = false;
+    std::int64_t bestSquaredDistance_ = 0; ///< 재고가 있다고 응답한 자판기 중 가장 가까운 곳까지의 거리 제곱
+};
+
+} // namespace service
@@ -7,6 +7,8 @@
 #include <mutex>  // std::mutex, std::lock_guard, std::unique_lock
 #include <memory> // std::shared_ptr (PrePaymentCode가 Order를 가짐)
 #include <condition_variable> // std::condition_variable
+#include <cstdint>
+#include <functional>
 
 #include "domain/drink.h"
 #include "domain/order.h"
@@ -15,9 +17,11 @@
 #include "network/message.hpp"
 #include "service/DistanceService.hpp" // service::OtherVendingMachineInfo
 #include "service/ErrorService.hpp"    // service::ErrorInfo
+#include "service/StockQueryTracker.hpp" // service::StockQueryOptions
 
 #include "boost/asio/io_context.hpp" 
 #include "boost/asio/steady_timer.hpp" // Asio 타이머
+#include "boost/asio/strand.hpp"       // 메시지 핸들러/타이머 직렬화
 
 namespace presentation { class UserInterface; }
 namespace service {
@@ -79,6 +83,7 @@ public:
      * @param myVmX 현재 자판기의 X 좌표.
      * @param myVmY 현재 자판기의 Y 좌표.
      * @param totalOtherVmCount 현재 시스템의 다른 자판기 총 수 (응답 카운트 및 타임아웃 로직에 사용).
+     * @param stockQueryOptions 주변 자판기 재고 조회를 타임아웃 전에 끝낼 조건 (기본: 모든 자판기 응답 시).
      */
     UserProcessController(
         presentation::UserInterface& ui,
@@ -92,7 +97,8 @@ public:
         const std::string& myVmId,
         int myVmX,
         int myVmY,
-        int totalOtherVmCount
+        int totalOtherVmCount,
+        StockQueryOptions stockQueryOptions = StockQueryOptions{}
     );
 
     /**
@@ -112,6 +118,9 @@ private:
     service::DistanceService& distanceService_;
     service::ErrorService& errorService_;
     boost::asio::io_context& ioContext_; ///< 네트워크 I/O 및 타이머를 위한 Asio io_context.
+    /// 메시지 핸들러(onXXXReceived)와 응답 타이머를 직렬화하는 strand.
+    /// io_context를 여러 스레드가 실행해도 이 컨트롤러의 콜백은 한 번에 하나씩만 실행됩니다.
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
 
     // --- 현재 자판기 고유 정보 ---
     std::string myVendingMachineId_; ///< 본 자판기의 ID (예: "T1")
@@ -125,8 +134,12 @@ private:
     bool isCurrentOrderPrepayment_ = false;                 ///< 현재 주문이 선결제인지 여부
     std::optional<domain::Drink> pendingDrinkSelection_;    ///< 사용자가 선택한 음료 정보 (주문 확정 전)
     std::vector<service::OtherVendingMachineInfo> availableOtherVmsForDrink_; ///< 다른 자판기 재고 조회 결과
+    StockQueryTracker stockQuery_;                          ///< 재고 조회 응답 기록 및 조기 종료 판단
     std::optional<domain::VendingMachine> selectedTargetVmForPrepayment_; ///< 선결제 대상 자판기 정보
+    std::vector<domain::VendingMachine> prepaymentAlternatives_; ///< 예약 거절 시 재고 조회 없이 시도할 다음 후보 (가까운 순)
     std::optional<service::ErrorInfo> last_error_info_; ///< 콜백/타이머에서 발생한 오류를 메인 스레드로 전달하기 위함
+    std::string pendingRequestCorrId_;          ///< 응답을 기다리는 요청(REQ_STOCK/REQ_PREPAY)의 corr_id
+    std::uint64_t transactionGeneration_ = 0;   ///< 거래가 초기화될 때마다 증가. 응답 콜백은 요청 당시 값과 비교함
 
     // --- 동기화 객체 ---
     std::mutex mtx_; ///< 공유 데이터(위의 상태 및 데이터 변수들) 접근을 위한 뮤텍스
@@ -134,7 +147,7 @@ private:
     bool cv_data_ready_ = false; ///< 조건 변수 알림을 위한 플래그 (응답/타임아웃 발생 시 true)
 
     // --- 타임아웃 처리용 Asio 타이머 ---
-    boost::asio::steady_timer response_timer_; ///< 네트워크 응답 대기용 타이머
+    boost::asio::steady_timer response_timer_; ///< 네트워크 응답 대기용 타이머 (strand_ 위에서만 조작)
     std::chrono::seconds current_timeout_duration_; ///< 현재 타이머의 대기 시간 (초 단위)
 
 
@@ -154,6 +167,8 @@ private:
     void state_processingPayment();             // UC4, UC5, UC6
     void state_dispensingDrink();               // UC7, UC14
     void state_broadcastingStockRequest();      // UC8
+    // 재고 캐시만으로 조회 정책이 만족되면 availableOtherVmsForDrink_를 채우고 true 반환 (mtx_를 잡은 상태에서 호출)
+    bool answerStockQueryFromCache(const std::string& drinkCode);
     // AWAITING_STOCK_RESPONSES는 processCurrentState에서 cv_.wait_for로 처리
     void state_displayingOtherVmOptions();      // UC10, UC11
     void state_issuingAuthCodeAndRequestingReservation(); // UC16
@@ -169,12 +184,24 @@ private:
 
     // --- MessageService로부터 호출될 콜백 핸들러들 (io_context 스레드에서 실행) ---
     void onReqStockReceived(const network::Message& msg);   // UC17
-    void onRespStockReceived(const network::Message& msg);  // UC9
+    void onRespStockReceived(const network::Message& msg, std::uint64_t generation);  // UC9
     void onReqPrepayReceived(const network::Message& msg);  // UC15
-    void onRespPrepayReceived(const network::Message& msg); // UC16
+    void onRespPrepayReceived(const network::Message& msg, std::uint64_t generation); // UC16
+    // 응답 콜백(onRespXXXReceived)을 현재 거래 세대와 함께 strand_에 올리는 MessageService용 콜백을 만듦
+    using ResponseMethod = void (UserProcessController::*)(const network::Message&, std::uint64_t);
+    std::function<void(const network::Message&)> responseCallback(ResponseMethod method);
 
     void handleStockResponseTimeout();
 
+    /// 선결제 예약 대상 후보 수 (1순위 + 실패 시 재시도할 대안)
+    static constexpr std::size_t PREPAY_CANDIDATE_LIMIT = 3;
+    // 이번 조회에서 재고가 있다고 답한 자판기(responders) 중 가까운 순서로 최대 PREPAY_CANDIDATE_LIMIT대를 고름
+    std::vector<domain::VendingMachine> rankPrepaymentCandidates(
+        const std::string& drinkCode, const std::vector<service::OtherVendingMachineInfo>& responders) const;
+    // 대상이 재고 없음(availability=false)으로 답했을 때 다음 후보로 대상을 바꾸고 요청 상태로 되돌림. 후보가 없으면 false (mtx_를 잡은 상태에서 호출)
+    // 시간 초과에는 쓰지 않음: 늦은 대상이 같은 인증 코드로 재고를 잡았을 수 있어, 다른 자판기에 보내면 코드 하나가 두 곳에서 유효해짐
+    bool retryPrepaymentWithNextCandidate(const std::string& reason);
+
 };
 
 } // namespace service
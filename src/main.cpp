@@ -9,6 +9,7 @@
 #include "persistence/OrderRepository.hpp"
 #include "persistence/OvmAddressRepository.hpp"
 #include "persistence/prepayCodeRepository.h" // .h 또는 .hpp 프로젝트에 맞게 확인
+#include "persistence/DurableStore.hpp"
 
 #include "network/message.hpp"
 #include "network/MessageSender.hpp"
@@ -20,6 +21,7 @@
 #include "service/PrepaymentService.hpp"
 #include "service/OrderService.hpp"
 #include "service/MessageService.hpp"
+#include "service/StockQueryTracker.hpp"
 #include "service/UserProcessController.hpp"
 #include "presentation/UserInterface.hpp"
 
@@ -34,6 +36,8 @@
 #include <algorithm>
 #include <memory>
 #include <set>
+#include <cstdlib>
+#include <chrono>
 
 // --- 전체 시스템에 정의된 자판기 정보 ---
 const std::vector<domain::VendingMachine> ALL_VENDING_MACHINES_IN_SYSTEM = {
@@ -49,6 +53,14 @@ struct VendingMachineConfig {
     int x = 50;
     int y = 50;
     unsigned short port = 12350;
+    bool binaryProtocol = false; // 환경 변수 VM_BINARY_PROTOCOL=1 이면 다른 자판기와 바이너리 전송 협상 시도
+    unsigned int ioThreads = 0;  // io_context를 실행할 스레드 수 (환경 변수 VM_IO_THREADS, 0이면 CPU 코어 수)
+    // 주변 자판기 재고 조회 종료 정책 (환경 변수 VM_STOCK_QUERY_POLICY, VM_STOCK_CACHE_MS). 자판기 좌표는 main에서 채움
+    service::StockQueryOptions stockQuery; // 기본: 모두 응답할 때까지 기다리고 재고 캐시는 쓰지 않음
+    // 다른 자판기의 선결제로 잡아둔 재고를 구매자가 찾아가지 않으면 되돌리기까지의 시간 (환경 변수 VM_PREPAY_HOLD_SEC)
+    std::chrono::seconds prepayHoldTtl = service::InventoryService::DEFAULT_HOLD_TTL;
+    // 재고, 주문, 선결제 코드를 로그와 스냅샷으로 남길 디렉터리 (환경 변수 VM_DATA_DIR, 비어 있으면 메모리에만 보관)
+    std::string dataDir;
 };
 
 
@@ -67,6 +79,16 @@ int main(int argc, char* argv[]) {
         std::cout << "  [자판기ID]       : 지정된 ID의 자판기가 기본 설정으로 실행됩니다." << std::endl;
         std::cout << "  [자판기ID Port]  : 지정된 ID의 자판기가 지정된 포트로 실행됩니다 (좌표는 기본값 사용)." << std::endl;
         std::cout << "  [자판기ID X Y Port]: 지정된 ID의 자판기가 지정된 X, Y 좌표 및 포트로 실행됩니다." << std::endl;
+        std::cout << "\n환경 변수:" << std::endl;
+        std::cout << "  VM_BINARY_PROTOCOL=1 : 같은 바이너리 형식을 지원하는 자판기와는 바이너리로 통신합니다 (기본: JSON만 사용)." << std::endl;
+        std::cout << "  VM_IO_THREADS=N      : 네트워크 I/O를 처리할 스레드 수 (기본: CPU 코어 수)." << std::endl;
+        std::cout << "  VM_STOCK_QUERY_POLICY=all|first|quorum:N|nearest" << std::endl;
+        std::cout << "                       : 주변 자판기 재고 조회를 타임아웃 전에 끝낼 조건 (기본: all)." << std::endl;
+        std::cout << "                         all=모두 응답, first=재고 있는 첫 응답, quorum:N=N곳 응답," << std::endl;
+        std::cout << "                         nearest=남은 자판기가 모두 현재 후보보다 멀 때" << std::endl;
+        std::cout << "  VM_STOCK_CACHE_MS=N  : N밀리초 안에 받은 다른 자판기 재고로 조회를 대신합니다 (기본: 0, 사용 안 함)." << std::endl;
+        std::cout << "  VM_PREPAY_HOLD_SEC=N : 다른 자판기의 선결제로 잡아둔 재고를 N초 안에 찾아가지 않으면 되돌립니다 (기본: 600)." << std::endl;
+        std::cout << "  VM_DATA_DIR=경로     : 재고, 주문, 선결제 코드를 이 디렉터리에 기록하고 재시작 시 복원합니다 (기본: 기록 안 함)." << std::endl;
         std::cout << "\nALL_VENDING_MACHINES_IN_SYSTEM 정의:" << std::endl;
         for(const auto& vm : ALL_VENDING_MACHINES_IN_SYSTEM) {
             std::cout << "  - ID: " << vm.getId() << ", X: " << vm.getLocation().first
@@ -85,14 +107,35 @@ int main(int argc, char* argv[]) {
         auto work_guard = boost::asio::make_work_guard(io_context);
 
         presentation::UserInterface ui;
+        service::ErrorService errorService; // 로그 기록 실패를 알리므로 DurableStore보다 먼저 선언
         persistence::DrinkRepository drinkRepository;
         persistence::InventoryRepository inventoryRepository;
-        persistence::OrderRepository orderRepository;
+        // 주문 파일은 데이터 디렉터리에 둠 (없으면 임시 디렉터리의 이름 없는 파일)
+        persistence::OrderRepository orderRepository(
+            config.dataDir.empty() ? std::string() : persistence::DurableStore::orderStoragePath(config.dataDir));
         persistence::OvmAddressRepository ovmAddressRepository;
         persistence::PrepayCodeRepository prepayCodeRepository;
 
-        setupGeneralInventory(config.id, inventoryRepository);
-        std::cout << "정보: " << config.id << " 자판기의 초기 재고 설정 완료." << std::endl;
+        // 리포지토리보다 먼저 소멸해야 하므로 리포지토리 뒤에 선언
+        std::unique_ptr<persistence::DurableStore> durableStore;
+        bool restored = false;
+        if (!config.dataDir.empty()) {
+            durableStore = std::make_unique<persistence::DurableStore>(
+                config.dataDir, inventoryRepository, orderRepository, prepayCodeRepository, ovmAddressRepository);
+            restored = durableStore->recover();
+            durableStore->setFailureHandler([&errorService](const std::string& what) {
+                // 변경은 이미 반영되었고 기록은 백그라운드에서 재시도하므로 알리기만 함
+                std::cerr << "경고: " << errorService.processOccurredError(service::ErrorType::REPOSITORY_ACCESS_ERROR,
+                    "변경 내역 기록 실패: " + what).userFriendlyMessage << std::endl;
+            });
+        }
+
+        if (restored) {
+            std::cout << "정보: " << config.id << " 자판기의 재고와 주문을 " << config.dataDir << "에서 복원했습니다." << std::endl;
+        } else {
+            setupGeneralInventory(config.id, inventoryRepository);
+            std::cout << "정보: " << config.id << " 자판기의 초기 재고 설정 완료." << std::endl;
+        }
 
         std::vector<std::string> other_vm_endpoints_for_sender;
         std::unordered_map<std::string, std::string> id_to_endpoint_map_for_sender;
@@ -112,6 +155,7 @@ int main(int argc, char* argv[]) {
 
             other_vm_endpoints_for_sender.push_back(endpoint_str);
             id_to_endpoint_map_for_sender[other_vm_def.getId()] = endpoint_str;
+            config.stockQuery.knownPeers.push_back({other_vm_def.getId(), other_vm_def.getLocation().first, other_vm_def.getLocation().second});
             actual_other_vm_count++;
             std::cout << "  + " << other_vm_def.getId() << " (컨테이너명: " << container_name 
                       << ", 포트: " << other_vm_def.getPort() << ", 내부 엔드포인트: " << endpoint_str 
@@ -122,11 +166,17 @@ int main(int argc, char* argv[]) {
         }
 
         network::MessageSender messageSender(io_context, other_vm_endpoints_for_sender, id_to_endpoint_map_for_sender);
+        messageSender.setBinaryProtocol(config.binaryProtocol);
         network::MessageReceiver messageReceiver(io_context, config.port);
 
-        service::ErrorService errorService;
-        service::InventoryService inventoryService(inventoryRepository, drinkRepository, errorService);
+        service::InventoryService inventoryService(inventoryRepository, drinkRepository, errorService, config.prepayHoldTtl);
+        if (restored) {
+            inventoryService.restoreHolds(); // 재시작 전에 다른 자판기의 선결제로 잡아둔 재고의 만료 타이머
+        }
         service::DistanceService distanceService;
+        for (const auto& peer : config.stockQuery.knownPeers) {
+            distanceService.upsertMachine(peer.id, peer.coordX, peer.coordY); // 재고 여부는 RESP_STOCK을 받으며 채워짐
+        }
         service::PrepaymentService prepaymentService(prepayCodeRepository, orderRepository, errorService);
         service::MessageService messageService(messageSender, messageReceiver, errorService, config.id, config.x, config.y);
         service::OrderService orderService(orderRepository, inventoryService, prepaymentService, errorService);
@@ -135,27 +185,32 @@ int main(int argc, char* argv[]) {
             ui, inventoryService, orderService, prepaymentService,
             messageService, distanceService, errorService,
             io_context, config.id, config.x, config.y,
-            actual_other_vm_count
+            actual_other_vm_count, config.stockQuery
         );
 
-        std::thread io_thread([&io_context, vm_id = config.id](){
-            try {
-                std::cout << "정보: " << vm_id << "의 io_context 스레드 시작." << std::endl;
-                io_context.run();
-                std::cout << "정보: " << vm_id << "의 io_context 스레드 정상 종료." << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "오류: " << vm_id << "의 io_context 스레드에서 예외 발생: " << e.what() << std::endl;
-            }
-        });
+        // 같은 io_context를 여러 스레드가 실행합니다. 연결별 세션과 컨트롤러 핸들러는 각자의 strand로 직렬화됩니다.
+        std::vector<std::thread> io_threads;
+        std::cout << "정보: " << config.id << "의 io_context 스레드 " << config.ioThreads << "개 시작." << std::endl;
+        for (unsigned int i = 0; i < config.ioThreads; ++i) {
+            io_threads.emplace_back([&io_context, vm_id = config.id](){
+                try {
+                    io_context.run();
+                } catch (const std::exception& e) {
+                    std::cerr << "오류: " << vm_id << "의 io_context 스레드에서 예외 발생: " << e.what() << std::endl;
+                }
+            });
+        }
 
         controller.run();
 
         std::cout << "정보: " << config.id << " 자판기 메인 루프 종료. 시스템 종료 절차 시작..." << std::endl;
         io_context.stop();
         work_guard.reset();
-        if (io_thread.joinable()) {
-            std::cout << "정보: " << config.id << " io_context 스레드 조인 대기..." << std::endl;
-            io_thread.join();
+        std::cout << "정보: " << config.id << " io_context 스레드 조인 대기..." << std::endl;
+        for (auto& io_thread : io_threads) {
+            if (io_thread.joinable()) {
+                io_thread.join();
+            }
         }
         std::cout << "정보: " << config.id << " io_context 스레드 조인 완료." << std::endl;
 
@@ -218,6 +273,72 @@ VendingMachineConfig parseCommandLineArguments(int argc, char* argv[]) {
         exit(1);
     }
     
+    if (const char* binary = std::getenv("VM_BINARY_PROTOCOL")) {
+        config.binaryProtocol = std::string(binary) == "1";
+    }
+    if (const char* threads = std::getenv("VM_IO_THREADS")) {
+        try {
+            int requested = std::stoi(threads);
+            if (requested < 1) {
+                throw std::out_of_range("1 이상이어야 합니다");
+            }
+            config.ioThreads = static_cast<unsigned int>(requested);
+        } catch (const std::exception& e) {
+            std::cerr << "경고: VM_IO_THREADS 값 '" << threads << "'이(가) 올바르지 않아 기본값을 사용합니다. (" << e.what() << ")" << std::endl;
+        }
+    }
+    if (config.ioThreads == 0) {
+        config.ioThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (const char* policy = std::getenv("VM_STOCK_QUERY_POLICY")) {
+        const std::string value(policy);
+        if (value == "all") {
+            config.stockQuery.policy = service::StockQueryPolicy::ALL;
+        } else if (value == "first") {
+            config.stockQuery.policy = service::StockQueryPolicy::FIRST;
+        } else if (value == "nearest") {
+            config.stockQuery.policy = service::StockQueryPolicy::NEAREST_POSSIBLE;
+        } else if (value.rfind("quorum:", 0) == 0) {
+            try {
+                int quorum = std::stoi(value.substr(7));
+                if (quorum < 1) {
+                    throw std::out_of_range("1 이상이어야 합니다");
+                }
+                config.stockQuery.policy = service::StockQueryPolicy::QUORUM;
+                config.stockQuery.quorum = static_cast<std::size_t>(quorum);
+            } catch (const std::exception& e) {
+                std::cerr << "경고: VM_STOCK_QUERY_POLICY 값 '" << value << "'의 응답 수가 올바르지 않아 기본값을 사용합니다. (" << e.what() << ")" << std::endl;
+            }
+        } else {
+            std::cerr << "경고: VM_STOCK_QUERY_POLICY 값 '" << value << "'을(를) 알 수 없어 기본값(all)을 사용합니다." << std::endl;
+        }
+    }
+    if (const char* cacheMs = std::getenv("VM_STOCK_CACHE_MS")) {
+        try {
+            int requested = std::stoi(cacheMs);
+            if (requested < 0) {
+                throw std::out_of_range("0 이상이어야 합니다");
+            }
+            config.stockQuery.cacheMaxAge = std::chrono::milliseconds(requested);
+        } catch (const std::exception& e) {
+            std::cerr << "경고: VM_STOCK_CACHE_MS 값 '" << cacheMs << "'이(가) 올바르지 않아 기본값을 사용합니다. (" << e.what() << ")" << std::endl;
+        }
+    }
+    if (const char* holdSec = std::getenv("VM_PREPAY_HOLD_SEC")) {
+        try {
+            int requested = std::stoi(holdSec);
+            if (requested <= 0) {
+                throw std::out_of_range("1 이상이어야 합니다");
+            }
+            config.prepayHoldTtl = std::chrono::seconds(requested);
+        } catch (const std::exception& e) {
+            std::cerr << "경고: VM_PREPAY_HOLD_SEC 값 '" << holdSec << "'이(가) 올바르지 않아 기본값을 사용합니다. (" << e.what() << ")" << std::endl;
+        }
+    }
+    if (const char* dataDir = std::getenv("VM_DATA_DIR")) {
+        config.dataDir = dataDir;
+    }
+
     // 최종 파싱된 설정값을 담은 config 객체를 반환합니다.
     return config;
 }
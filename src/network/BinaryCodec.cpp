@@ -0,0 +1,166 @@
+#include "network/BinaryCodec.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+#include <variant>
+
+using namespace network;
+
+namespace {
+    void putU8(std::string& out, std::size_t value) {
+        out.push_back(static_cast<char>(value & 0xFF));
+    }
+
+    void putI32(std::string& out, std::int32_t value) {
+        const auto u = static_cast<std::uint32_t>(value);
+        putU8(out, u >> 24);
+        putU8(out, u >> 16);
+        putU8(out, u >> 8);
+        putU8(out, u);
+    }
+
+    void putShortString(std::string& out, const std::string& value, const char* what) {
+        if (value.size() > 0xFF) {
+            throw std::length_error(std::string(what) + " 길이가 255바이트를 넘습니다.");
+        }
+        putU8(out, value.size());
+        out.append(value);
+    }
+
+    // 본문을 앞에서부터 읽는 커서. 남은 길이를 넘는 읽기는 예외로 처리합니다.
+    class Cursor {
+    public:
+        Cursor(const char* data, std::size_t length) : p_(data), end_(data + length) {}
+
+        std::uint8_t u8() {
+            require(1);
+            return static_cast<std::uint8_t>(*p_++);
+        }
+
+        std::int32_t i32() {
+            std::uint32_t u = 0;
+            for (int i = 0; i < 4; ++i) {
+                u = (u << 8) | u8();
+            }
+            return static_cast<std::int32_t>(u);
+        }
+
+        void shortString(std::string& out) {
+            const std::size_t n = u8();
+            require(n);
+            out.assign(p_, n);
+            p_ += n;
+        }
+
+        bool atEnd() const { return p_ == end_; }
+
+    private:
+        void require(std::size_t n) const {
+            if (static_cast<std::size_t>(end_ - p_) < n) {
+                throw std::runtime_error("바이너리 메시지 본문이 잘렸습니다.");
+            }
+        }
+
+        const char* p_;
+        const char* end_;
+    };
+}
+
+std::string BinaryCodec::encode(const Message& msg)
+{
+    std::string out;
+    encodeFrame(msg, out);
+    return out;
+}
+
+void BinaryCodec::encodeFrame(const Message& msg, std::string& out)
+{
+    if (static_cast<std::size_t>(msg.msg_type) != msg.msg_content.index()) {
+        throw std::invalid_argument("msg_type과 msg_content의 종류가 일치하지 않습니다.");
+    }
+
+    out.assign(LENGTH_PREFIX_SIZE, '\0'); // 길이는 본문을 채운 뒤 기록 (기존 용량은 유지)
+    putU8(out, static_cast<std::size_t>(msg.msg_type));
+    putShortString(out, msg.src_id, "src_id");
+    putShortString(out, msg.dst_id, "dst_id");
+    putShortString(out, msg.corr_id, "corr_id");
+    std::visit([&out](const auto& content) {
+        using T = std::decay_t<decltype(content)>;
+        putShortString(out, content.item_code, "item_code");
+        putI32(out, content.item_num);
+        if constexpr (std::is_same_v<T, StockResponse>) {
+            putI32(out, content.coor_x);
+            putI32(out, content.coor_y);
+        } else if constexpr (std::is_same_v<T, PrepayRequest>) {
+            putShortString(out, content.cert_code, "cert_code");
+        } else if constexpr (std::is_same_v<T, PrepayResponse>) {
+            putU8(out, content.availability ? 1 : 0);
+        }
+    }, msg.msg_content);
+
+    const std::size_t bodySize = out.size() - LENGTH_PREFIX_SIZE;
+    out[0] = static_cast<char>((bodySize >> 24) & 0xFF);
+    out[1] = static_cast<char>((bodySize >> 16) & 0xFF);
+    out[2] = static_cast<char>((bodySize >> 8) & 0xFF);
+    out[3] = static_cast<char>(bodySize & 0xFF);
+}
+
+Message BinaryCodec::decode(const char* body, std::size_t length)
+{
+    Cursor in(body, length);
+    Message m;
+
+    const std::uint8_t type = in.u8();
+    in.shortString(m.src_id);
+    in.shortString(m.dst_id);
+    in.shortString(m.corr_id);
+    switch (type) {
+        case static_cast<std::uint8_t>(Message::Type::REQ_STOCK): {
+            StockRequest c;
+            in.shortString(c.item_code);
+            c.item_num = in.i32();
+            m.setContent(std::move(c));
+            break;
+        }
+        case static_cast<std::uint8_t>(Message::Type::RESP_STOCK): {
+            StockResponse c;
+            in.shortString(c.item_code);
+            c.item_num = in.i32();
+            c.coor_x = in.i32();
+            c.coor_y = in.i32();
+            m.setContent(std::move(c));
+            break;
+        }
+        case static_cast<std::uint8_t>(Message::Type::REQ_PREPAY): {
+            PrepayRequest c;
+            in.shortString(c.item_code);
+            c.item_num = in.i32();
+            in.shortString(c.cert_code);
+            m.setContent(std::move(c));
+            break;
+        }
+        case static_cast<std::uint8_t>(Message::Type::RESP_PREPAY): {
+            PrepayResponse c;
+            in.shortString(c.item_code);
+            c.item_num = in.i32();
+            c.availability = in.u8() != 0;
+            m.setContent(std::move(c));
+            break;
+        }
+        default:
+            throw std::runtime_error("알 수 없는 msg_type: " + std::to_string(type));
+    }
+    if (!in.atEnd()) {
+        throw std::runtime_error("바이너리 메시지 본문 뒤에 남은 데이터가 있습니다.");
+    }
+    return m;
+}
+
+std::uint32_t BinaryCodec::readLength(const char* prefix)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(prefix);
+    return (static_cast<std::uint32_t>(p[0]) << 24) |
+           (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) |
+           static_cast<std::uint32_t>(p[3]);
+}
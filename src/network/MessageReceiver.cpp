@@ -1,16 +1,204 @@
 #include "network/MessageReceiver.hpp"
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/read_until.hpp>    
-#include <boost/asio/streambuf.hpp>    
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/asio/write.hpp>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 using boost::asio::ip::tcp;
 
 namespace network {
-MessageReceiver::MessageReceiver(boost::asio::io_context& io, unsigned short port)
+
+class MessageReceiver::Session : public std::enable_shared_from_this<MessageReceiver::Session> {
+public:
+    Session(MessageReceiver& owner, tcp::socket socket)
+        : owner_(owner), socket_(std::move(socket)), timer_(socket_.get_executor()),
+          buffer_(std::min(INITIAL_BUFFER_SIZE, maxBufferSize())) {
+        ++owner_.active_connections_;
+    }
+
+    ~Session() {
+        --owner_.active_connections_;
+    }
+
+    void start() {
+        armTimer();
+        doRead();
+    }
+
+private:
+    static constexpr std::size_t INITIAL_BUFFER_SIZE = 4096;
+
+    enum class Mode { UNKNOWN, JSON, BINARY, REFUSED };
+
+    // 프레임 하나(최대 크기)와 구분자/길이 접두사를 담을 수 있는 크기까지만 버퍼를 늘립니다.
+    std::size_t maxBufferSize() const {
+        return owner_.limits_.maxFrameSize + BinaryCodec::LENGTH_PREFIX_SIZE + 1;
+    }
+
+    void doRead() {
+        // 아직 완성되지 않은 프레임이 버퍼를 가득 채웠다면 버퍼를 늘립니다.
+        if (used_ == buffer_.size()) {
+            buffer_.resize(std::min(buffer_.size() * 2, maxBufferSize()));
+        }
+        socket_.async_read_some(boost::asio::buffer(buffer_.data() + used_, buffer_.size() - used_),
+            [self = shared_from_this()](const boost::system::error_code& ec, std::size_t n) {
+                if (ec) {
+                    self->timer_.cancel(); // 상대가 연결을 닫았거나 오류 발생: 세션 종료
+                    return;
+                }
+                self->used_ += n;
+                if (!self->drainFrames(n)) {
+                    self->close();
+                    return;
+                }
+                if (self->mode_ == Mode::REFUSED) {
+                    return; // 거절 응답을 다 쓰면 닫음
+                }
+                self->armTimer();
+                self->doRead();
+            });
+    }
+
+    // 미완성 프레임이 있으면 읽기 기한을, 없으면 유휴 시간을 기준으로 타이머를 다시 겁니다.
+    void armTimer() {
+        const auto timeout = used_ > 0 ? owner_.limits_.readDeadline : owner_.limits_.idleTimeout;
+        if (timeout.count() <= 0) {
+            timer_.cancel();
+            return;
+        }
+        timer_.expires_after(timeout);
+        timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            // 다시 걸린 타이머의 이전 대기는 operation_aborted로 끝나거나, 이미 큐에 올라와 있다면 만료 시각으로 걸러냅니다.
+            if (ec || self->timer_.expiry() > std::chrono::steady_clock::now()) {
+                return;
+            }
+            ++self->owner_.timed_out_connections_;
+            self->close();
+        });
+    }
+
+    void close() {
+        boost::system::error_code ignored;
+        socket_.close(ignored);
+        timer_.cancel();
+    }
+
+    // 방금 읽은 바이트(newBytes)를 포함해 버퍼에 쌓인 완성된 프레임을 모두 처리합니다.
+    // 연결을 계속 읽어야 하면 true, 닫아야 하면 false를 반환합니다.
+    bool drainFrames(std::size_t newBytes) {
+        std::size_t consumed = 0;
+        if (mode_ == Mode::UNKNOWN && !negotiate(consumed)) {
+            return false;
+        }
+
+        bool keepReading = true;
+        if (mode_ == Mode::JSON) {
+            consumed = drainJson(consumed, newBytes);
+            if (used_ - consumed > owner_.limits_.maxFrameSize) {
+                // 개행 없이 최대 크기를 넘긴 프레임: 경계를 다시 찾을 수 없으므로 연결을 닫습니다.
+                ++owner_.dropped_frames_;
+                std::cerr << "오류: 수신 프레임이 최대 크기(" << owner_.limits_.maxFrameSize << " 바이트)를 넘어 연결을 닫습니다." << std::endl;
+                return false;
+            }
+        } else if (mode_ == Mode::BINARY) {
+            keepReading = drainBinary(consumed);
+        }
+
+        // 남은 미완성 프레임을 버퍼 앞으로 옮깁니다.
+        if (consumed > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + consumed, used_ - consumed);
+            used_ -= consumed;
+        }
+        return keepReading;
+    }
+
+    // 연결의 첫 바이트로 인코딩 방식을 정합니다. 협상 바이트열이 아직 다 오지 않았으면 UNKNOWN으로 남습니다.
+    bool negotiate(std::size_t& consumed) {
+        if (buffer_[0] != BinaryCodec::PREAMBLE[0]) {
+            mode_ = Mode::JSON; // 표준 피어: JSON 프레임은 '{'로 시작
+            return true;
+        }
+        const std::size_t available = std::min(used_, BinaryCodec::PREAMBLE_SIZE);
+        const std::size_t magicSize = BinaryCodec::PREAMBLE_SIZE - 1; // 마지막 바이트는 버전
+        if (std::memcmp(buffer_.data(), BinaryCodec::PREAMBLE, std::min(available, magicSize)) != 0) {
+            return false; // 알 수 없는 데이터
+        }
+        if (available < BinaryCodec::PREAMBLE_SIZE) {
+            return true;
+        }
+        if (buffer_[magicSize] != BinaryCodec::PREAMBLE[magicSize]) {
+            // 버전이 다른 피어: 우리 협상 바이트열을 ack 자리에 보내 거절을 알리고 닫음 (송신 측은 JSON 전용으로 전환)
+            mode_ = Mode::REFUSED;
+            boost::asio::async_write(socket_, boost::asio::buffer(BinaryCodec::PREAMBLE, BinaryCodec::PREAMBLE_SIZE),
+                [self = shared_from_this()](const boost::system::error_code&, std::size_t) { self->close(); });
+            return true;
+        }
+        mode_ = Mode::BINARY;
+        consumed = BinaryCodec::PREAMBLE_SIZE;
+        boost::asio::async_write(socket_, boost::asio::buffer(BinaryCodec::PREAMBLE, BinaryCodec::PREAMBLE_SIZE),
+            [self = shared_from_this()](const boost::system::error_code&, std::size_t) {});
+        return true;
+    }
+
+    std::size_t drainJson(std::size_t frameStart, std::size_t newBytes) {
+        const char* base = buffer_.data();
+        std::size_t scanFrom = std::max(frameStart, used_ - newBytes); // 이전 읽기에서 이미 검사한 구간은 다시 보지 않음
+        while (const void* nl = std::memchr(base + scanFrom, '\n', used_ - scanFrom)) {
+            const std::size_t frameEnd = static_cast<const char*>(nl) - base;
+            std::size_t length = frameEnd - frameStart;
+            if (length > 0 && base[frameStart + length - 1] == '\r') {
+                --length;
+            }
+            if (length > owner_.limits_.maxFrameSize) {
+                ++owner_.dropped_frames_; // 한 번에 도착한 너무 큰 프레임은 버리고 다음 프레임부터 계속 처리
+            } else if (length > 0) {
+                owner_.dispatch(WireFormat::JSON, base + frameStart, length);
+            }
+            frameStart = frameEnd + 1;
+            scanFrom = frameStart;
+        }
+        return frameStart;
+    }
+
+    bool drainBinary(std::size_t& consumed) {
+        const char* base = buffer_.data();
+        while (used_ - consumed >= BinaryCodec::LENGTH_PREFIX_SIZE) {
+            const std::uint32_t length = BinaryCodec::readLength(base + consumed);
+            if (length > owner_.limits_.maxFrameSize) {
+                ++owner_.dropped_frames_;
+                std::cerr << "오류: 바이너리 프레임 길이 초과 (" << length << " 바이트), 연결을 닫습니다." << std::endl;
+                return false;
+            }
+            const std::size_t frameSize = BinaryCodec::LENGTH_PREFIX_SIZE + length;
+            if (used_ - consumed < frameSize) {
+                // 큰 프레임이 한 번에 들어갈 수 있도록 미리 버퍼를 늘립니다.
+                if (buffer_.size() < frameSize) {
+                    buffer_.resize(frameSize);
+                }
+                break;
+            }
+            owner_.dispatch(WireFormat::BINARY, base + consumed + BinaryCodec::LENGTH_PREFIX_SIZE, length);
+            consumed += frameSize;
+        }
+        return true;
+    }
+
+    MessageReceiver& owner_;
+    tcp::socket socket_;
+    boost::asio::steady_timer timer_; ///< 읽기 기한/유휴 시간 타이머 (소켓과 같은 strand)
+    std::vector<char> buffer_; ///< 연결이 유지되는 동안 재사용하는 수신 버퍼
+    std::size_t used_ = 0;     ///< buffer_에 들어 있는 유효 바이트 수
+    Mode mode_ = Mode::UNKNOWN;
+};
+
+MessageReceiver::MessageReceiver(boost::asio::io_context& io, unsigned short port, ReceiverLimits limits)
     : io_context_(io), port_(port),
-      acceptor_(io, tcp::endpoint(tcp::v4(), port)) {}
+      acceptor_(io, tcp::endpoint(tcp::v4(), port)),
+      limits_(limits) {}
 
 void MessageReceiver::subscribe(Message::Type type, Handler handler) {
     handlers_[type] = std::move(handler);
@@ -22,33 +210,44 @@ void MessageReceiver::start() {
 
 void MessageReceiver::doAccept() {
     // std::cout << " Accepting connections on port " << port_ << std::endl;
-    auto sock = std::make_shared<tcp::socket>(io_context_);
-    acceptor_.async_accept(*sock, [this, sock](boost::system::error_code ec) {
+    // 연결마다 별도의 strand를 주어, io_context를 여러 스레드가 실행해도 한 세션의 핸들러는 순서대로 실행되고
+    // 서로 다른 연결의 프레임은 여러 코어에서 동시에 처리되도록 합니다.
+    acceptor_.async_accept(boost::asio::make_strand(io_context_), [this](boost::system::error_code ec, tcp::socket sock) {
         if (!ec) {
-            doRead(sock);
+            if (active_connections_.load() >= limits_.maxConnections) {
+                // 최대 연결 수 초과: 새 연결을 받지 않고 바로 닫아 기존 연결의 처리 지연을 막습니다.
+                ++shed_connections_;
+                boost::system::error_code ignored;
+                sock.close(ignored);
+            } else {
+                std::make_shared<Session>(*this, std::move(sock))->start();
+            }
         }
         doAccept();
     });
 }
 
-void MessageReceiver::doRead(std::shared_ptr<tcp::socket> sock) {
-    auto buf = std::make_shared<boost::asio::streambuf>();
-    boost::asio::async_read_until(*sock, *buf, '\n',
-        [this, sock, buf](boost::system::error_code ec, std::size_t) {
-            if (!ec) {
-                std::istream is(buf.get());
-                std::string line;
-                std::getline(is, line);
-                try {
-                    auto msg = MessageSerializer::fromJson(line);
-
-                    auto it = handlers_.find(msg.msg_type);
-                    it->second(msg);
-                } catch (const std::exception& e) {
-                    std::cerr << "오류: 메시지 수신 처리 중 예외 발생: " << e.what() << std::endl;
-                }
-                doRead(sock);
-            }
-        });
+ReceiverStats MessageReceiver::stats() const {
+    ReceiverStats s;
+    s.activeConnections = active_connections_.load();
+    s.shedConnections = shed_connections_.load();
+    s.timedOutConnections = timed_out_connections_.load();
+    s.droppedFrames = dropped_frames_.load();
+    return s;
+}
+
+void MessageReceiver::dispatch(WireFormat format, const char* data, std::size_t length) {
+    try {
+        auto msg = format == WireFormat::BINARY ? BinaryCodec::decode(data, length)
+                                                : MessageSerializer::fromJson(data, length);
+
+        auto it = handlers_.find(msg.msg_type);
+        if (it != handlers_.end()) {
+            it->second(msg);
+        }
+    } catch (const std::exception& e) {
+        ++dropped_frames_;
+        std::cerr << "오류: 메시지 수신 처리 중 예외 발생: " << e.what() << std::endl;
+    }
+}
 }
-}
\ No newline at end of file
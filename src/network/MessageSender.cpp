@@ -1,43 +1,149 @@
 #include "network/MessageSender.hpp"
 #include "network/MessageSerializer.hpp"
-#include <boost/asio/connect.hpp>
-#include <boost/asio/write.hpp>
+#include "network/BinaryCodec.hpp"
+#include <stdexcept>
+#include <atomic>
 #include <iostream>
+#include <vector>
 
 using boost::asio::ip::tcp;
 
 namespace network {
+namespace {
+    // 한 번의 send() 호출에 포함된 대상들의 진행 상황. 마지막 대상이 끝나면 완료 콜백을 호출합니다.
+    struct FanOutState {
+        std::atomic<std::size_t> remaining;
+        std::atomic<std::size_t> succeeded{0};
+        std::atomic<std::size_t> failed{0};
+        MessageSender::PeerHandler onPeer;
+        MessageSender::CompletionHandler onComplete;
+
+        FanOutState(std::size_t count, MessageSender::PeerHandler peer, MessageSender::CompletionHandler done)
+            : remaining(count), onPeer(std::move(peer)), onComplete(std::move(done)) {}
+    };
+
+    constexpr std::size_t FRAME_POOL_SIZE = 16;              // 스레드마다 재사용할 프레임 수
+    constexpr std::size_t MAX_POOLED_CAPACITY = 64 * 1024;   // 이보다 커진 버퍼는 재사용하지 않고 놓아 줌
+
+    // 이 스레드가 만든 프레임 중 모든 연결이 쓰기를 마쳐 풀만 참조하는 것을 골라 버퍼 용량째 다시 씁니다.
+    // 프레임과 문자열 버퍼를 전송마다 새로 할당하지 않으며, 남는 프레임이 없으면 새로 만들어 풀에 넣습니다.
+    std::shared_ptr<OutgoingFrame> acquireFrame() {
+        thread_local std::vector<std::shared_ptr<OutgoingFrame>> pool;
+        for (auto& frame : pool) {
+            if (frame.use_count() != 1) {
+                continue; // 아직 전송 중인 연결이 있음
+            }
+            // 다른 스레드가 마지막 참조를 놓기 전의 읽기가 끝난 뒤에 버퍼를 덮어쓰도록 합니다.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (frame->json.capacity() > MAX_POOLED_CAPACITY || frame->binary.capacity() > MAX_POOLED_CAPACITY) {
+                frame = std::make_shared<OutgoingFrame>(); // 큰 메시지 한 번으로 늘어난 버퍼를 계속 붙잡지 않음
+            }
+            frame->binary.clear();
+            return frame;
+        }
+        auto frame = std::make_shared<OutgoingFrame>();
+        if (pool.size() < FRAME_POOL_SIZE) {
+            pool.push_back(frame);
+        }
+        return frame;
+    }
+}
+
 MessageSender::MessageSender(boost::asio::io_context& io,
                              const std::vector<std::string>& endpoints,
                              const std::unordered_map<std::string, std::string>& id_map)
-    : io_context_(io), endpoints_(endpoints), id_map_(id_map) {}
+    : io_context_(io), endpoints_(endpoints), id_map_(id_map) {
+    // 엔드포인트 파싱과 주소 해석을 생성 시점에 미리 해 두어 전송 경로에서 해석을 기다리지 않게 합니다.
+    for (const auto& endpoint : endpoints_) {
+        connectionFor(endpoint);
+    }
+    for (const auto& entry : id_map_) {
+        connectionFor(entry.second);
+    }
+}
 
-void MessageSender::send(const Message& msg) {
+void MessageSender::send(const Message& msg, PeerHandler onPeer, CompletionHandler onComplete) {
+    std::vector<std::string> targets;
     if (msg.dst_id == "0") { // broadcast
-        for (auto& ep : endpoints_) {
-            sendOne(ep, msg);
-
-        }
+        targets = endpoints_;
     } else { // unicast
         auto it = id_map_.find(msg.dst_id);
         if (it != id_map_.end()) {
-            sendOne(it->second, msg);
+            targets.push_back(it->second);
+        }
+    }
+
+    if (targets.empty()) {
+        if (onComplete) {
+            onComplete(0, 0);
         }
+        return;
+    }
+
+    // 한 번만 직렬화해 이 스레드의 재사용 프레임에 바로 쓰고, 모든 대상이 이 버퍼를 그대로 소켓에 씁니다.
+    std::shared_ptr<OutgoingFrame> frame = acquireFrame();
+    MessageSerializer::encodeFrame(msg, frame->json);
+    bool binaryEnabled;
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        binaryEnabled = binary_enabled_;
+    }
+    if (binaryEnabled) {
+        try {
+            BinaryCodec::encodeFrame(msg, frame->binary);
+        } catch (const std::length_error&) {
+            frame->binary.clear(); // 바이너리 형식 한도를 넘는 메시지: JSON 연결로만 전송됩니다.
+        }
+    }
+    auto state = std::make_shared<FanOutState>(targets.size(), std::move(onPeer), std::move(onComplete));
+
+    for (const auto& endpoint : targets) {
+        connectionFor(endpoint)->send(frame,
+            [state, endpoint](const boost::system::error_code& ec) {
+                if (ec) {
+                    ++state->failed;
+                } else {
+                    ++state->succeeded;
+                }
+                if (state->onPeer) {
+                    state->onPeer(endpoint, ec);
+                }
+                if (--state->remaining == 0 && state->onComplete) {
+                    state->onComplete(state->succeeded.load(), state->failed.load());
+                }
+            });
     }
 }
 
-void MessageSender::sendOne(const std::string& endpoint, const Message& msg) {
-    auto pos = endpoint.find(':');
-    std::string host = endpoint.substr(0, pos);
-    unsigned short port = static_cast<unsigned short>(std::stoi(endpoint.substr(pos + 1)));
+void MessageSender::setConnectTimeout(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connect_timeout_ = timeout;
+    for (auto& entry : connections_) {
+        entry.second->setConnectTimeout(timeout);
+    }
+}
 
-    tcp::resolver resolver(io_context_);
-    auto eps = resolver.resolve(host, std::to_string(port));
-    tcp::socket socket(io_context_);
-    boost::asio::connect(socket, eps);
-    
-    std::string data = MessageSerializer::toJson(msg) + "\n";
-    boost::asio::write(socket, boost::asio::buffer(data));
+void MessageSender::setBinaryProtocol(bool enabled) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    binary_enabled_ = enabled;
+    for (auto& entry : connections_) {
+        entry.second->setBinaryProtocol(enabled);
+    }
+}
+
+std::size_t MessageSender::broadcastTargetCount() const {
+    return endpoints_.size();
 }
 
-}
\ No newline at end of file
+std::shared_ptr<PeerConnection> MessageSender::connectionFor(const std::string& endpoint) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    auto& conn = connections_[endpoint];
+    if (!conn) {
+        conn = std::make_shared<PeerConnection>(io_context_, endpoint, connect_timeout_);
+        conn->setBinaryProtocol(binary_enabled_);
+        conn->start();
+    }
+    return conn;
+}
+
+}
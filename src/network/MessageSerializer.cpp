@@ -1,38 +1,388 @@
 #include "network/MessageSerializer.hpp"
 
-#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/error/en.h>
 #include <rapidjson/writer.h>
-#include <rapidjson/stringbuffer.h>
+
+#include <charconv>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <stdexcept>
+#include <string>
 
 using namespace network;
 
+namespace {
+    // msg_content의 표준 키 값을 문자열 그대로 담아 두는 자리. 키 순서가 msg_type보다 먼저 올 수 있으므로
+    // 파싱이 끝난 뒤 msg_type에 맞는 구조체로 옮깁니다. 값이 짧아 모두 SSO 버퍼에 들어갑니다.
+    struct RawContent {
+        std::string item_code;
+        std::string item_num;
+        std::string coor_x;
+        std::string coor_y;
+        std::string cert_code;
+        std::string availability;
+        bool has_item_num = false;
+        bool has_coor_x = false;
+        bool has_coor_y = false;
+        bool has_cert_code = false;
+        bool has_availability = false;
+    };
+
+    int parseInt(const std::string& value, const char* key) {
+        int result = 0;
+        const char* first = value.data();
+        const char* last = first + value.size();
+        auto [ptr, ec] = std::from_chars(first, last, result);
+        if (ec != std::errc() || ptr != last) {
+            throw std::runtime_error(std::string("잘못된 메시지 형식: ") + key + " 값이 정수가 아닙니다 ('" + value + "').");
+        }
+        return result;
+    }
+
+    void require(bool present, const char* key, Message::Type type) {
+        if (!present) {
+            throw std::runtime_error(std::string("잘못된 메시지 형식: msg_type ") + std::to_string(static_cast<int>(type))
+                                     + "에 필요한 " + key + " 필드가 없습니다.");
+        }
+    }
+
+    // RapidJSON Writer의 출력 스트림. 호출자가 넘긴 std::string 뒤에 바로 이어 쓰므로
+    // StringBuffer에서 std::string으로 다시 복사하는 단계가 없습니다.
+    // 스레드마다 Writer를 하나 두고 다시 쓰므로, 쓸 대상 문자열은 bind()로 바꿉니다.
+    class StringOutputStream {
+    public:
+        typedef char Ch;
+        void bind(std::string& out) { out_ = &out; }
+        void Put(Ch c) { out_->push_back(c); }
+        void Flush() {}
+    private:
+        std::string* out_ = nullptr;
+    };
+
+    using JsonWriter = rapidjson::Writer<StringOutputStream>;
+
+    // Writer는 만들 때마다 내부 할당자와 중첩 단계 스택을 새로 할당하므로 스레드별로 하나만 만들어 둡니다.
+    // Reset()은 스택의 용량을 남긴 채 상태만 비웁니다.
+    JsonWriter& threadWriter(std::string& out) {
+        struct State {
+            StringOutputStream stream;
+            JsonWriter writer{stream};
+        };
+        thread_local State state;
+        state.stream.bind(out);
+        state.writer.Reset(state.stream);
+        return state.writer;
+    }
+
+    // 숫자 필드는 PFR 포맷대로 문자열로 씁니다.
+    void writeIntString(JsonWriter& w, int value) {
+        char digits[16];
+        auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+        (void)ec;
+        w.String(digits, static_cast<rapidjson::SizeType>(end - digits));
+    }
+
+    void writeString(JsonWriter& w, const std::string& value) {
+        w.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+    }
+
+    /**
+     * RapidJSON SAX 핸들러. DOM을 만들지 않고 읽는 즉시 Message 필드에 값을 채웁니다.
+     * 최상위 객체의 msg_type/src_id/dst_id/msg_content만 해석하고, 그 밖의 키는 값째로 건너뜁니다.
+     * 형식 오류를 만나면 error_에 이유를 남기고 false를 반환해 파싱을 중단합니다.
+     */
+    class MessageSaxHandler {
+    public:
+        explicit MessageSaxHandler(Message& m) : m_(m) {}
+
+        bool Null() { return scalar("null"); }
+        bool Bool(bool) { return scalar("bool"); }
+        bool Double(double) { return scalar("double"); }
+        bool Int(int i) { return integer(i); }
+        bool Uint(unsigned u) { return integer(u); }
+        bool Int64(std::int64_t i) { return integer(i); }
+        bool Uint64(std::uint64_t u) {
+            return u > static_cast<std::uint64_t>(INT64_MAX) ? scalar("큰 정수") : integer(static_cast<std::int64_t>(u));
+        }
+        bool RawNumber(const char* str, rapidjson::SizeType len, bool copy) { return String(str, len, copy); }
+
+        bool String(const char* str, rapidjson::SizeType len, bool) {
+            if (skip_depth_ > 0) {
+                return true;
+            }
+            switch (field_) {
+                case Field::SRC_ID:  m_.src_id.assign(str, len); seen_src_ = true; break;
+                case Field::DST_ID:  m_.dst_id.assign(str, len); seen_dst_ = true; break;
+                case Field::CORR_ID: m_.corr_id.assign(str, len); break;
+                case Field::CONTENT_VALUE: if (content_slot_) content_slot_->assign(str, len); break;
+                case Field::SKIP:    break;
+                default:             return fail("문자열 값을 사용할 수 없는 위치입니다.");
+            }
+            return valueDone();
+        }
+
+        bool StartObject() {
+            if (skip_depth_ > 0 || field_ == Field::SKIP) {
+                ++skip_depth_;
+                return true;
+            }
+            if (depth_ == 0) {
+                depth_ = 1;
+                return true;
+            }
+            if (field_ == Field::CONTENT) {
+                depth_ = 2;
+                seen_content_ = true;
+                return true;
+            }
+            return fail("중첩 객체를 사용할 수 없는 위치입니다.");
+        }
+
+        bool Key(const char* str, rapidjson::SizeType len, bool) {
+            if (skip_depth_ > 0) {
+                return true;
+            }
+            if (depth_ == 2) {
+                content_slot_ = slotFor(str, len); // 알 수 없는 키는 nullptr: 값을 버림
+                field_ = Field::CONTENT_VALUE;
+                return true;
+            }
+            field_ = keyIs(str, len, "msg_type")    ? Field::MSG_TYPE
+                   : keyIs(str, len, "src_id")      ? Field::SRC_ID
+                   : keyIs(str, len, "dst_id")      ? Field::DST_ID
+                   : keyIs(str, len, "msg_content") ? Field::CONTENT
+                   : keyIs(str, len, "corr_id")     ? Field::CORR_ID
+                   : Field::SKIP;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            if (skip_depth_ > 0) {
+                return --skip_depth_ > 0 || valueDone();
+            }
+            --depth_;
+            if (depth_ == 1) {
+                return valueDone(); // msg_content 객체 끝
+            }
+            return true;
+        }
+
+        bool StartArray() {
+            if (skip_depth_ > 0 || field_ == Field::SKIP) {
+                ++skip_depth_;
+                return true;
+            }
+            return fail("배열을 사용할 수 없는 위치입니다.");
+        }
+
+        bool EndArray(rapidjson::SizeType) {
+            return --skip_depth_ > 0 || valueDone();
+        }
+
+        // 파싱이 끝난 뒤 필수 필드가 모두 있었는지 확인합니다.
+        void checkComplete() const {
+            if (!seen_type_ || !seen_src_ || !seen_dst_) {
+                throw std::runtime_error("잘못된 메시지 형식: msg_type, src_id, dst_id 필드가 모두 필요합니다.");
+            }
+            if (!seen_content_) {
+                throw std::runtime_error("잘못된 메시지 형식: msg_content 필드가 없습니다.");
+            }
+        }
+
+        // 모아 둔 msg_content 값을 msg_type에 맞는 구조체로 옮깁니다. 숫자 변환은 여기서 한 번만 합니다.
+        void buildContent() {
+            switch (m_.msg_type) {
+                case Message::Type::REQ_STOCK: {
+                    StockRequest c;
+                    c.item_code = std::move(raw_.item_code); // 누락 시 빈 문자열: 수신 측에서 UC17 E1로 처리
+                    if (raw_.has_item_num) c.item_num = parseInt(raw_.item_num, "item_num");
+                    m_.setContent(std::move(c));
+                    break;
+                }
+                case Message::Type::RESP_STOCK: {
+                    require(raw_.has_item_num, "item_num", m_.msg_type);
+                    require(raw_.has_coor_x, "coor_x", m_.msg_type);
+                    require(raw_.has_coor_y, "coor_y", m_.msg_type);
+                    StockResponse c;
+                    c.item_code = std::move(raw_.item_code);
+                    c.item_num = parseInt(raw_.item_num, "item_num");
+                    c.coor_x = parseInt(raw_.coor_x, "coor_x");
+                    c.coor_y = parseInt(raw_.coor_y, "coor_y");
+                    m_.setContent(std::move(c));
+                    break;
+                }
+                case Message::Type::REQ_PREPAY: {
+                    require(raw_.has_cert_code, "cert_code", m_.msg_type);
+                    PrepayRequest c;
+                    c.item_code = std::move(raw_.item_code);
+                    if (raw_.has_item_num) c.item_num = parseInt(raw_.item_num, "item_num");
+                    c.cert_code = std::move(raw_.cert_code);
+                    m_.setContent(std::move(c));
+                    break;
+                }
+                case Message::Type::RESP_PREPAY: {
+                    require(raw_.has_availability, "availability", m_.msg_type);
+                    PrepayResponse c;
+                    c.item_code = std::move(raw_.item_code);
+                    if (raw_.has_item_num) c.item_num = parseInt(raw_.item_num, "item_num");
+                    c.availability = raw_.availability == "T";
+                    m_.setContent(std::move(c));
+                    break;
+                }
+            }
+        }
+
+        const std::string& error() const { return error_; }
+
+    private:
+        enum class Field { NONE, MSG_TYPE, SRC_ID, DST_ID, CORR_ID, CONTENT, CONTENT_VALUE, SKIP };
+
+        std::string* slotFor(const char* str, rapidjson::SizeType len) {
+            if (keyIs(str, len, "item_code")) return &raw_.item_code;
+            if (keyIs(str, len, "item_num")) { raw_.has_item_num = true; return &raw_.item_num; }
+            if (keyIs(str, len, "coor_x")) { raw_.has_coor_x = true; return &raw_.coor_x; }
+            if (keyIs(str, len, "coor_y")) { raw_.has_coor_y = true; return &raw_.coor_y; }
+            if (keyIs(str, len, "cert_code")) { raw_.has_cert_code = true; return &raw_.cert_code; }
+            if (keyIs(str, len, "availability")) { raw_.has_availability = true; return &raw_.availability; }
+            return nullptr;
+        }
+
+        static bool keyIs(const char* str, rapidjson::SizeType len, const char* name) {
+            return std::char_traits<char>::length(name) == len && std::char_traits<char>::compare(str, name, len) == 0;
+        }
+
+        bool integer(std::int64_t value) {
+            if (skip_depth_ > 0) {
+                return true;
+            }
+            switch (field_) {
+                case Field::MSG_TYPE:
+                    if (value < static_cast<int>(Message::Type::REQ_STOCK) || value > static_cast<int>(Message::Type::RESP_PREPAY)) {
+                        return fail("알 수 없는 msg_type: " + std::to_string(value));
+                    }
+                    m_.msg_type = static_cast<Message::Type>(value);
+                    seen_type_ = true;
+                    break;
+                case Field::CONTENT_VALUE:
+                    if (content_slot_) {
+                        *content_slot_ = std::to_string(value); // 숫자로 보내는 피어도 허용
+                    }
+                    break;
+                case Field::SKIP:
+                    break;
+                default:
+                    return fail("정수 값을 사용할 수 없는 위치입니다.");
+            }
+            return valueDone();
+        }
+
+        bool scalar(const char* kind) {
+            if (skip_depth_ > 0 || field_ == Field::SKIP) {
+                return valueDone();
+            }
+            return fail(std::string(kind) + " 값을 사용할 수 없는 위치입니다.");
+        }
+
+        // 값 하나를 다 읽었을 때 다음 키를 기다리는 상태로 돌아갑니다.
+        bool valueDone() {
+            if (skip_depth_ == 0) {
+                field_ = Field::NONE;
+            }
+            return true;
+        }
+
+        bool fail(std::string reason) {
+            error_ = std::move(reason);
+            return false;
+        }
+
+        Message& m_;
+        RawContent raw_;
+        Field field_ = Field::NONE;
+        int depth_ = 0;           // 1: 최상위 객체, 2: msg_content 객체
+        int skip_depth_ = 0;      // 건너뛰는 중인 알 수 없는 값의 중첩 깊이
+        std::string* content_slot_ = nullptr;
+        bool seen_type_ = false;
+        bool seen_src_ = false;
+        bool seen_dst_ = false;
+        bool seen_content_ = false;
+        std::string error_;
+    };
+}
+
+namespace {
+    void writeJson(const Message& msg, std::string& out, bool withCorrId)
+    {
+        if (static_cast<std::size_t>(msg.msg_type) != msg.msg_content.index()) {
+            throw std::invalid_argument("msg_type과 msg_content의 종류가 일치하지 않습니다.");
+        }
+
+        JsonWriter& w = threadWriter(out);
+        w.StartObject();
+        w.Key("msg_type"); w.Int(static_cast<int>(msg.msg_type));
+        w.Key("src_id");   writeString(w, msg.src_id);
+        w.Key("dst_id");   writeString(w, msg.dst_id);
+        if (withCorrId && !msg.corr_id.empty()) {
+            w.Key("corr_id"); writeString(w, msg.corr_id);
+        }
+        w.Key("msg_content"); w.StartObject();
+        std::visit([&w](const auto& content) {
+            using T = std::decay_t<decltype(content)>;
+            w.Key("item_code"); writeString(w, content.item_code);
+            w.Key("item_num");  writeIntString(w, content.item_num);
+            if constexpr (std::is_same_v<T, StockResponse>) {
+                w.Key("coor_x"); writeIntString(w, content.coor_x);
+                w.Key("coor_y"); writeIntString(w, content.coor_y);
+            } else if constexpr (std::is_same_v<T, PrepayRequest>) {
+                w.Key("cert_code"); writeString(w, content.cert_code);
+            } else if constexpr (std::is_same_v<T, PrepayResponse>) {
+                w.Key("availability"); w.String(content.availability ? "T" : "F");
+            }
+        }, msg.msg_content);
+        w.EndObject();
+        w.EndObject();
+    }
+}
+
 std::string MessageSerializer::toJson(const Message& msg)
 {
-    rapidjson::StringBuffer buf;
-    rapidjson::Writer<rapidjson::StringBuffer> w(buf);
-    w.StartObject();
-    w.Key("msg_type"); w.Int(static_cast<int>(msg.msg_type));
-    w.Key("src_id");   w.String(msg.src_id.c_str());
-    w.Key("dst_id");   w.String(msg.dst_id.c_str());
-    w.Key("msg_content"); w.StartObject();
-    for (auto& kv : msg.msg_content) {
-        w.Key(kv.first.c_str()); w.String(kv.second.c_str());
-    }
-    w.EndObject();
-    w.EndObject();
-    return buf.GetString();
+    std::string out;
+    out.reserve(128); // 재고 메시지 한 건이 들어가는 크기
+    writeJson(msg, out, true);
+    return out;
+}
+
+void MessageSerializer::encodeFrame(const Message& msg, std::string& out)
+{
+    out.clear(); // 기존 용량은 유지
+    writeJson(msg, out, false); // JSON 연결은 협상하지 않은 표준 피어이므로 표준 키만 보냄
+    out.push_back('\n');
 }
 
 Message MessageSerializer::fromJson(const std::string& s)
 {
-    rapidjson::Document d; d.Parse(s.c_str());
+    return fromJson(s.data(), s.size());
+}
+
+Message MessageSerializer::fromJson(const char* data, std::size_t length)
+{
     Message m;
-    m.msg_type = static_cast<Message::Type>(d["msg_type"].GetInt());
-    m.src_id   = d["src_id"].GetString();
-    m.dst_id   = d["dst_id"].GetString();
-    for (auto& mem : d["msg_content"].GetObject()) {
-        m.msg_content[mem.name.GetString()] = mem.value.GetString();
+    MessageSaxHandler handler(m);
+    rapidjson::MemoryStream stream(data, length);
+    rapidjson::Reader reader;
+    rapidjson::ParseResult result = reader.Parse(stream, handler);
+
+    if (!handler.error().empty()) {
+        throw std::runtime_error("잘못된 메시지 형식: " + handler.error());
     }
+    if (result.IsError()) {
+        throw std::runtime_error(std::string("JSON 파싱 실패 (offset ") + std::to_string(result.Offset()) + "): "
+                                 + rapidjson::GetParseError_En(result.Code()));
+    }
+    handler.checkComplete();
+    handler.buildContent();
     return m;
 }
-
@@ -0,0 +1,353 @@
+#include "network/PeerConnection.hpp"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+using boost::asio::ip::tcp;
+
+namespace network {
+
+PeerConnection::PeerConnection(boost::asio::io_context& io,
+                               const std::string& endpoint,
+                               std::chrono::milliseconds connectTimeout,
+                               std::chrono::milliseconds resolveTtl)
+    : strand_(boost::asio::make_strand(io)),
+      resolver_(strand_),
+      socket_(strand_),
+      connect_timer_(strand_),
+      refresh_timer_(strand_),
+      connect_timeout_(connectTimeout),
+      resolve_ttl_(resolveTtl),
+      endpoint_(endpoint) {
+    auto pos = endpoint.rfind(':');
+    if (pos == std::string::npos || pos == 0 || pos + 1 == endpoint.size()) {
+        throw std::invalid_argument("잘못된 엔드포인트 형식입니다: '" + endpoint + "' (예: host:port)");
+    }
+    host_ = endpoint.substr(0, pos);
+    port_ = endpoint.substr(pos + 1);
+}
+
+void PeerConnection::start() {
+    boost::asio::post(strand_, [self = shared_from_this()]() {
+        self->startResolve();
+        self->scheduleRefresh();
+    });
+}
+
+void PeerConnection::scheduleRefresh() {
+    refresh_timer_.expires_after(resolve_ttl_);
+    // 타이머가 연결의 수명을 늘리지 않도록 약한 참조로 잡습니다.
+    refresh_timer_.async_wait(boost::asio::bind_executor(strand_,
+        [weak = weak_from_this()](const boost::system::error_code& ec) {
+            auto self = weak.lock();
+            if (ec || !self) {
+                return; // close()로 취소됨
+            }
+            self->startResolve();
+            self->scheduleRefresh();
+        }));
+}
+
+void PeerConnection::setConnectTimeout(std::chrono::milliseconds timeout) {
+    boost::asio::post(strand_, [self = shared_from_this(), timeout]() {
+        self->connect_timeout_ = timeout;
+    });
+}
+
+void PeerConnection::setBinaryProtocol(bool enabled) {
+    boost::asio::post(strand_, [self = shared_from_this(), enabled]() {
+        self->binary_enabled_ = enabled;
+        self->json_only_ = false;
+        self->skip_negotiation_once_ = false;
+    });
+}
+
+void PeerConnection::send(std::shared_ptr<const OutgoingFrame> frame, WriteHandler handler) {
+    boost::asio::post(strand_,
+        [self = shared_from_this(), frame = std::move(frame), handler = std::move(handler)]() mutable {
+            self->queue_.push_back(PendingWrite{std::move(frame), std::move(handler)});
+            if (self->state_ == State::DISCONNECTED) {
+                self->doConnect();
+            } else if (self->state_ == State::CONNECTED && !self->writing_) {
+                self->doWrite();
+            }
+        });
+}
+
+void PeerConnection::close() {
+    boost::asio::post(strand_, [self = shared_from_this()]() {
+        self->refresh_timer_.cancel();
+        self->resetSocket();
+        self->failPending(boost::asio::error::operation_aborted);
+    });
+}
+
+void PeerConnection::doConnect() {
+    resetSocket();
+    state_ = State::CONNECTING;
+    connect_timed_out_ = false;
+    const std::uint64_t generation = generation_;
+
+    connect_timer_.expires_after(connect_timeout_);
+    connect_timer_.async_wait(boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec) {
+            if (ec || generation != self->generation_ || self->state_ != State::CONNECTING) {
+                return;
+            }
+            // 제한 시간 안에 연결되지 않으면 진행 중인 resolve/connect를 취소합니다 (결과는 timed_out으로 보고).
+            self->connect_timed_out_ = true;
+            if (self->awaiting_resolve_) {
+                self->resolver_.cancel();
+            }
+            boost::system::error_code ignored;
+            self->socket_.close(ignored);
+        }));
+
+    if (resolved_.empty()) {
+        // 캐시가 없으면 해석이 끝난 뒤 onResolved에서 연결을 이어갑니다.
+        awaiting_resolve_ = true;
+        startResolve();
+        return;
+    }
+    if (std::chrono::steady_clock::now() - resolved_at_ >= resolve_ttl_) {
+        // 백그라운드 갱신이 실패해 캐시가 오래된 경우: 일단 기존 결과로 연결하고 다시 해석해 둠
+        startResolve();
+    }
+    connectTo(generation);
+}
+
+void PeerConnection::connectTo(std::uint64_t generation) {
+    boost::asio::async_connect(socket_, resolved_, boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec, const tcp::endpoint&) {
+            self->onConnected(ec, generation);
+        }));
+}
+
+void PeerConnection::startResolve() {
+    if (resolving_) {
+        return;
+    }
+    resolving_ = true;
+    resolver_.async_resolve(host_, port_, boost::asio::bind_executor(strand_,
+        [self = shared_from_this()](const boost::system::error_code& ec, tcp::resolver::results_type results) {
+            self->onResolved(ec, std::move(results));
+        }));
+}
+
+void PeerConnection::onResolved(const boost::system::error_code& ec, tcp::resolver::results_type results) {
+    resolving_ = false;
+    if (!ec && !results.empty()) {
+        resolved_ = std::move(results);
+        resolved_at_ = std::chrono::steady_clock::now();
+    }
+    if (!awaiting_resolve_ || state_ != State::CONNECTING) {
+        return;
+    }
+    awaiting_resolve_ = false;
+    if (resolved_.empty()) {
+        onConnected(ec ? ec : make_error_code(boost::asio::error::host_not_found), generation_);
+        return;
+    }
+    connectTo(generation_);
+}
+
+void PeerConnection::onConnected(const boost::system::error_code& ec, std::uint64_t generation) {
+    if (generation != generation_) {
+        return;
+    }
+    connect_timer_.cancel();
+
+    if (ec) {
+        const bool timedOut = connect_timed_out_;
+        resolved_ = {}; // 주소가 바뀌었을 수 있으므로 다음 연결 때 다시 해석합니다.
+        resetSocket();
+        failPending(timedOut ? make_error_code(boost::asio::error::timed_out) : ec);
+        return;
+    }
+
+    boost::system::error_code ignored;
+    socket_.set_option(tcp::no_delay(true), ignored);
+    const bool skipNegotiation = skip_negotiation_once_;
+    skip_negotiation_once_ = false;
+    if (binary_enabled_ && !json_only_ && !skipNegotiation) {
+        negotiate(generation);
+        return;
+    }
+    startConnected(WireFormat::JSON, generation);
+}
+
+void PeerConnection::negotiate(std::uint64_t generation) {
+    state_ = State::NEGOTIATING;
+
+    connect_timer_.expires_after(NEGOTIATION_TIMEOUT);
+    connect_timer_.async_wait(boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec) {
+            if (ec || generation != self->generation_ || self->state_ != State::NEGOTIATING) {
+                return;
+            }
+            // 표준 피어는 ack를 보내지 않지만, 느린 자판기일 수도 있으므로 다음 연결에서 다시 협상합니다.
+            self->fallBackToJson(false);
+        }));
+
+    boost::asio::async_write(socket_, boost::asio::buffer(BinaryCodec::PREAMBLE, BinaryCodec::PREAMBLE_SIZE),
+        boost::asio::bind_executor(strand_,
+            [self = shared_from_this(), generation](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    self->onNegotiated(ec, generation);
+                }
+            }));
+    boost::asio::async_read(socket_, boost::asio::buffer(ack_), boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec, std::size_t) {
+            self->onNegotiated(ec, generation);
+        }));
+}
+
+void PeerConnection::onNegotiated(const boost::system::error_code& ec, std::uint64_t generation) {
+    if (generation != generation_ || state_ != State::NEGOTIATING) {
+        return;
+    }
+    connect_timer_.cancel();
+    if (ec) {
+        fallBackToJson(false); // 전송 오류: 상대의 판단이 아니므로 기억하지 않음
+        return;
+    }
+    if (std::equal(ack_.begin(), ack_.end(), BinaryCodec::PREAMBLE)) {
+        startConnected(WireFormat::BINARY, generation);
+        return;
+    }
+    fallBackToJson(true);
+}
+
+void PeerConnection::fallBackToJson(bool refusedByPeer) {
+    // 협상 바이트열을 받은 표준 피어의 수신 버퍼를 오염시키지 않도록, 이 연결은 버리고 새로 연결합니다.
+    if (refusedByPeer) {
+        json_only_ = true;
+    }
+    resetSocket();
+    if (!queue_.empty()) {
+        // 기다리던 프레임은 바로 JSON으로 보냄. 거절이 아니었다면 그다음 연결에서 다시 협상
+        skip_negotiation_once_ = !refusedByPeer;
+        doConnect();
+    }
+}
+
+void PeerConnection::startConnected(WireFormat format, std::uint64_t generation) {
+    format_ = format;
+    state_ = State::CONNECTED;
+    watchForClose(generation);
+    doWrite();
+}
+
+void PeerConnection::doWrite() {
+    if (queue_.empty() || writing_ || state_ != State::CONNECTED) {
+        return;
+    }
+    const OutgoingFrame& frame = *queue_.front().frame;
+    const std::string& bytes = format_ == WireFormat::BINARY ? frame.binary : frame.json;
+    if (bytes.empty()) {
+        // 바이너리로 인코딩할 수 없었던 메시지는 바이너리 연결로 보낼 수 없습니다.
+        complete(queue_.front(), make_error_code(boost::asio::error::message_size));
+        queue_.pop_front();
+        doWrite();
+        return;
+    }
+    writing_ = true;
+    const std::uint64_t generation = generation_;
+    boost::asio::async_write(socket_, boost::asio::buffer(bytes), boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec, std::size_t) {
+            self->onWritten(ec, generation);
+        }));
+}
+
+void PeerConnection::onWritten(const boost::system::error_code& ec, std::uint64_t generation) {
+    if (generation != generation_) {
+        // 이미 닫힌 이전 소켓의 쓰기입니다. 남은 큐는 새 연결 쪽에서 이어서 처리합니다.
+        if (state_ == State::DISCONNECTED && !queue_.empty()) {
+            doConnect();
+        }
+        return;
+    }
+    writing_ = false;
+    // 전송 중에 상대가 닫았다면 커널이 받아 준 쓰기도 상대는 읽지 않으므로, 성공으로 끝내지 않고 끊어진 연결로 처리합니다.
+    const boost::system::error_code result = peer_closed_ && !ec ? make_error_code(boost::asio::error::eof) : ec;
+    peer_closed_ = false;
+    if (queue_.empty()) {
+        if (result) {
+            resetSocket(); // 닫힌 연결을 CONNECTED로 남겨 두지 않음
+        }
+        return;
+    }
+
+    if (!result) {
+        complete(queue_.front(), ec);
+        queue_.pop_front();
+        doWrite();
+        return;
+    }
+
+    // 재사용하던 연결이 끊어진 경우: 새로 연결한 뒤 같은 프레임을 한 번만 다시 보냅니다.
+    PendingWrite& front = queue_.front();
+    if (!front.retried) {
+        front.retried = true;
+        doConnect();
+        return;
+    }
+    complete(front, result);
+    queue_.pop_front();
+    if (queue_.empty()) {
+        resetSocket();
+    } else {
+        doConnect();
+    }
+}
+
+void PeerConnection::watchForClose(std::uint64_t generation) {
+    // 수신 측은 이 연결로 데이터를 보내지 않으므로, 읽기가 끝났다면 상대가 연결을 닫은 것입니다.
+    socket_.async_read_some(boost::asio::buffer(&probe_byte_, 1), boost::asio::bind_executor(strand_,
+        [self = shared_from_this(), generation](const boost::system::error_code& ec, std::size_t) {
+            if (ec == boost::asio::error::operation_aborted || generation != self->generation_) {
+                return;
+            }
+            if (self->writing_) {
+                // 전송 중이라면 쓰기가 끝난 뒤 onWritten에서 재연결하고 그 프레임을 다시 보냅니다.
+                self->peer_closed_ = true;
+                return;
+            }
+            self->resetSocket();
+            if (!self->queue_.empty()) {
+                self->doConnect();
+            }
+        }));
+}
+
+void PeerConnection::resetSocket() {
+    ++generation_;
+    boost::system::error_code ignored;
+    socket_.close(ignored);
+    connect_timer_.cancel();
+    state_ = State::DISCONNECTED;
+    writing_ = false;
+    peer_closed_ = false;
+    awaiting_resolve_ = false;
+}
+
+void PeerConnection::failPending(const boost::system::error_code& ec) {
+    std::deque<PendingWrite> failed;
+    failed.swap(queue_);
+    for (const auto& write : failed) {
+        complete(write, ec);
+    }
+}
+
+void PeerConnection::complete(const PendingWrite& write, const boost::system::error_code& ec) {
+    if (write.handler) {
+        write.handler(ec);
+    }
+}
+
+} // namespace network
@@ -0,0 +1,239 @@
+#include "persistence/DurableStore.hpp"
+
+#include "domain/inventory.h"
+#include "domain/order.h"
+#include "domain/prepaymentCode.h"
+#include "domain/vendingMachine.h"
+#include "persistence/inventoryRepository.h"
+#include "persistence/OrderRepository.hpp"
+#include "persistence/OvmAddressRepository.hpp"
+#include "persistence/prepayCodeRepository.h"
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace persistence {
+
+namespace {
+
+RecordWriter recordOf(JournalRecordType type) {
+    RecordWriter writer;
+    writer.u8(static_cast<std::uint8_t>(type));
+    return writer;
+}
+
+void writeOrder(RecordWriter& writer, const domain::Order& order) {
+    writer.str(order.getVmid()).str(order.getDrinkCode()).i32(order.getQty())
+          .str(order.getCertCode()).str(order.getPayStatus());
+}
+
+domain::Order readOrder(RecordReader& reader) {
+    std::string vmid = reader.str();
+    std::string drinkCode = reader.str();
+    const int qty = reader.i32();
+    std::string certCode = reader.str();
+    std::string payStatus = reader.str();
+    return domain::Order(vmid, drinkCode, qty, certCode, payStatus);
+}
+
+} // namespace
+
+DurableStore::DurableStore(const std::string& directory,
+                           InventoryRepository& inventoryRepo,
+                           OrderRepository& orderRepo,
+                           PrepayCodeRepository& prepayCodeRepo,
+                           OvmAddressRepository& ovmAddressRepo,
+                           std::size_t snapshotEvery)
+    : inventoryRepo_(inventoryRepo),
+      orderRepo_(orderRepo),
+      prepayCodeRepo_(prepayCodeRepo),
+      ovmAddressRepo_(ovmAddressRepo),
+      log_(std::make_unique<WriteAheadLog>(directory, snapshotEvery)) {
+    if (!orderRepo_.hasDurableStorage()) {
+        throw std::invalid_argument("주문 리포지토리가 재시작 후에도 남는 파일(orderStoragePath)에 저장해야 합니다.");
+    }
+}
+
+DurableStore::~DurableStore() {
+    attach(nullptr);
+}
+
+void DurableStore::attach(WriteAheadLog* log) {
+    inventoryRepo_.attachLog(log);
+    orderRepo_.attachLog(log);
+    prepayCodeRepo_.attachLog(log);
+    ovmAddressRepo_.attachLog(log);
+}
+
+bool DurableStore::recover() {
+    attach(nullptr); // 복원 중의 변경은 다시 로그에 남기지 않음
+    const std::size_t restored = log_->replay([this](std::string_view record) { apply(record); });
+    log_->setSnapshotSource([this]() { return snapshotRecords(); });
+    attach(log_.get());
+    return restored > 0;
+}
+
+void DurableStore::checkpoint() {
+    log_->checkpoint();
+}
+
+void DurableStore::setFailureHandler(WriteAheadLog::FailureHandler handler) {
+    log_->setFailureHandler(std::move(handler));
+}
+
+std::string DurableStore::orderStoragePath(const std::string& directory) {
+    return (std::filesystem::path(directory) / "orders.dat").string();
+}
+
+void DurableStore::apply(std::string_view record) {
+    RecordReader reader(record);
+    switch (static_cast<JournalRecordType>(reader.u8())) {
+        case JournalRecordType::INVENTORY_SET: {
+            std::string drinkCode = reader.str();
+            const int qty = reader.i32();
+            inventoryRepo_.addOrUpdateStock(domain::Inventory(drinkCode, qty));
+            break;
+        }
+        case JournalRecordType::ORDER_SAVE:
+            orderRepo_.save(readOrder(reader));
+            break;
+        case JournalRecordType::ORDER_STATUS: { // 주문 번호를 남기기 전의 로그
+            std::string vmid = reader.str();
+            std::string drinkCode = reader.str();
+            std::string certCode = reader.str();
+            std::string newStatus = reader.str();
+            orderRepo_.updateStatus(vmid, drinkCode, certCode, newStatus);
+            break;
+        }
+        case JournalRecordType::PREPAY_SAVE: {
+            std::string code = reader.str();
+            const auto status = static_cast<domain::CodeStatus>(reader.i32());
+            std::shared_ptr<domain::Order> heldOrder;
+            if (reader.u8() != 0) {
+                heldOrder = std::make_shared<domain::Order>(readOrder(reader));
+            }
+            prepayCodeRepo_.save(domain::PrePaymentCode(code, status, heldOrder));
+            break;
+        }
+        case JournalRecordType::PREPAY_STATUS: {
+            std::string code = reader.str();
+            prepayCodeRepo_.updateStatus(code, static_cast<domain::CodeStatus>(reader.i32()));
+            break;
+        }
+        case JournalRecordType::OVM_SAVE: {
+            std::string id = reader.str();
+            const int x = reader.i32();
+            const int y = reader.i32();
+            std::string port = reader.str();
+            ovmAddressRepo_.save(domain::VendingMachine(id, x, y, port));
+            break;
+        }
+        case JournalRecordType::HOLD_ADD: {
+            // 홀드 후 재고를 그대로 덮어쓰므로, 재고가 먼저 들어 있는 스냅샷에서도 두 번 빠지지 않음
+            InventoryRepository::Hold hold;
+            hold.id = reader.str();
+            hold.drinkCode = reader.str();
+            hold.amount = reader.i32();
+            hold.expiresAt = std::chrono::system_clock::time_point(std::chrono::milliseconds(reader.i64()));
+            const int qtyAfter = reader.i32();
+            inventoryRepo_.addOrUpdateStock(domain::Inventory(hold.drinkCode, qtyAfter));
+            inventoryRepo_.restoreHold(hold);
+            break;
+        }
+        case JournalRecordType::HOLD_END: {
+            std::string holdId = reader.str();
+            std::string drinkCode = reader.str();
+            const int qtyAfter = reader.i32();
+            inventoryRepo_.endHold(holdId, false);
+            inventoryRepo_.addOrUpdateStock(domain::Inventory(drinkCode, qtyAfter));
+            break;
+        }
+        case JournalRecordType::ORDER_STATUS_AT: {
+            const auto index = static_cast<std::size_t>(reader.i64());
+            std::string newStatus = reader.str();
+            if (!orderRepo_.updateStatusAt(index, newStatus)) {
+                throw std::runtime_error("로그 레코드가 없는 주문(" + std::to_string(index) + "번)을 가리킵니다.");
+            }
+            break;
+        }
+        case JournalRecordType::ORDER_LOG_LENGTH:
+            orderRepo_.restoreStorage(static_cast<std::size_t>(reader.i64()));
+            break;
+        default:
+            throw std::runtime_error("알 수 없는 로그 레코드 종류입니다.");
+    }
+}
+
+std::vector<std::string> DurableStore::snapshotRecords() const {
+    std::vector<std::string> records;
+    std::unordered_map<std::string, int> qtyByDrink;
+    for (const domain::Inventory& item : inventoryRepo_.findAll()) {
+        records.push_back(inventorySetRecord(item.getDrinkCode(), item.getQty()));
+        qtyByDrink[item.getDrinkCode()] = item.getQty();
+    }
+    for (const InventoryRepository::Hold& hold : inventoryRepo_.findAllHolds()) {
+        records.push_back(holdAddRecord(hold, qtyByDrink[hold.drinkCode]));
+    }
+    // 주문 이력은 복사하지 않고 파일을 동기화한 뒤 길이만 남김 (로그 뮤텍스 아래라 그 사이 주문이 바뀌지 않음)
+    orderRepo_.syncStorage();
+    records.push_back(orderLogLengthRecord(orderRepo_.size()));
+    for (const domain::PrePaymentCode& code : prepayCodeRepo_.findAll()) {
+        records.push_back(prepaySaveRecord(code));
+    }
+    for (const domain::VendingMachine& vm : ovmAddressRepo_.findAll()) {
+        records.push_back(ovmSaveRecord(vm));
+    }
+    return records;
+}
+
+std::string DurableStore::inventorySetRecord(std::string_view drinkCode, int qty) {
+    return recordOf(JournalRecordType::INVENTORY_SET).str(drinkCode).i32(qty).take();
+}
+
+std::string DurableStore::orderSaveRecord(const domain::Order& order) {
+    RecordWriter writer = recordOf(JournalRecordType::ORDER_SAVE);
+    writeOrder(writer, order);
+    return writer.take();
+}
+
+std::string DurableStore::orderStatusRecord(std::size_t index, const std::string& newStatus) {
+    return recordOf(JournalRecordType::ORDER_STATUS_AT).i64(static_cast<std::int64_t>(index)).str(newStatus).take();
+}
+
+std::string DurableStore::orderLogLengthRecord(std::size_t length) {
+    return recordOf(JournalRecordType::ORDER_LOG_LENGTH).i64(static_cast<std::int64_t>(length)).take();
+}
+
+std::string DurableStore::prepaySaveRecord(const domain::PrePaymentCode& prepayCode) {
+    RecordWriter writer = recordOf(JournalRecordType::PREPAY_SAVE);
+    writer.str(prepayCode.getCode()).i32(static_cast<std::int32_t>(prepayCode.getStatus()));
+    const std::shared_ptr<domain::Order> heldOrder = prepayCode.getHeldOrder();
+    writer.u8(heldOrder ? 1 : 0);
+    if (heldOrder) {
+        writeOrder(writer, *heldOrder);
+    }
+    return writer.take();
+}
+
+std::string DurableStore::prepayStatusRecord(const std::string& code, int newStatus) {
+    return recordOf(JournalRecordType::PREPAY_STATUS).str(code).i32(newStatus).take();
+}
+
+std::string DurableStore::holdAddRecord(const InventoryRepository::Hold& hold, int qtyAfter) {
+    const auto expiresAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(hold.expiresAt.time_since_epoch()).count();
+    return recordOf(JournalRecordType::HOLD_ADD).str(hold.id).str(hold.drinkCode).i32(hold.amount)
+           .i64(expiresAtMs).i32(qtyAfter).take();
+}
+
+std::string DurableStore::holdEndRecord(std::string_view holdId, std::string_view drinkCode, int qtyAfter) {
+    return recordOf(JournalRecordType::HOLD_END).str(holdId).str(drinkCode).i32(qtyAfter).take();
+}
+
+std::string DurableStore::ovmSaveRecord(const domain::VendingMachine& vm) {
+    return recordOf(JournalRecordType::OVM_SAVE).str(vm.getId()).i32(vm.getLocation().first)
+           .i32(vm.getLocation().second).str(vm.getPort()).take();
+}
+
+} // namespace persistence
@@ -0,0 +1,269 @@
+#include "persistence/OrderLog.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace persistence {
+
+namespace {
+
+constexpr std::size_t SEGMENT_BYTES = OrderLog::SEGMENT_RECORDS * sizeof(OrderLog::Record);
+
+[[noreturn]] void throwErrno(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+int openFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throwErrno("주문 파일을 열 수 없습니다: " + path);
+    }
+    return fd;
+}
+
+int openOrderFile(const std::string& path) {
+    if (!path.empty()) {
+        const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::error_code ec;
+            std::filesystem::create_directories(parent, ec); // 실패하면 아래 open이 이유와 함께 실패함
+        }
+        return openFile(path);
+    }
+    // 경로가 없으면 임시 디렉터리($TMPDIR)에 이름 없는 파일을 만듦. 쓸 수 있는 임시 디렉터리가 없으면
+    // 파일 시스템 없이 메모리 파일로 대신함 (그 경우 내려놓은 구간도 메모리에 남음)
+    std::error_code ec;
+    const std::filesystem::path tmpDir = std::filesystem::temp_directory_path(ec);
+    if (!ec) {
+#ifdef O_TMPFILE
+        const int unnamedFd = ::open(tmpDir.c_str(), O_RDWR | O_TMPFILE | O_CLOEXEC, 0600);
+        if (unnamedFd >= 0) {
+            return unnamedFd;
+        }
+#endif
+        std::string pattern = (tmpDir / ".orders-XXXXXX").string();
+        const int namedFd = ::mkstemp(pattern.data());
+        if (namedFd >= 0) {
+            ::unlink(pattern.c_str()); // 이름 없이 열어 두면 프로세스가 끝날 때 함께 사라짐
+            return namedFd;
+        }
+    }
+    const int memoryFd = ::memfd_create("orders", MFD_CLOEXEC);
+    if (memoryFd < 0) {
+        throwErrno("임시 주문 파일을 만들 수 없습니다");
+    }
+    return memoryFd;
+}
+
+} // namespace
+
+OrderLog::OrderLog(const std::string& path, std::size_t hotSegments)
+    : fd_(openOrderFile(path)), hotSegments_(hotSegments == 0 ? 1 : hotSegments) {
+    try {
+        struct stat st {};
+        if (::fstat(fd_, &st) != 0) {
+            throwErrno("주문 파일 크기를 알 수 없습니다");
+        }
+        fileBytes_ = static_cast<std::size_t>(st.st_size);
+        if (!path.empty()) {
+            stringsFd_ = openFile(path + ".strings");
+            loadStrings();
+        }
+    } catch (...) {
+        ::close(fd_);
+        if (stringsFd_ >= 0) {
+            ::close(stringsFd_);
+        }
+        throw;
+    }
+}
+
+OrderLog::~OrderLog() {
+    for (Record* segment : segments_) {
+        ::munmap(segment, SEGMENT_BYTES);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    if (stringsFd_ >= 0) {
+        ::close(stringsFd_);
+    }
+}
+
+// 문자열 표 파일: [길이 u16][바이트]의 반복. 쓰다 만 꼬리는 잘라냄
+void OrderLog::loadStrings() {
+    std::string bytes;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = ::pread(stringsFd_, buffer, sizeof(buffer), static_cast<off_t>(bytes.size()))) > 0) {
+        bytes.append(buffer, static_cast<std::size_t>(n));
+    }
+    if (n < 0) {
+        throwErrno("주문 문자열 표를 읽을 수 없습니다");
+    }
+    std::size_t pos = 0;
+    while (bytes.size() - pos >= sizeof(std::uint16_t)) {
+        std::uint16_t length = 0;
+        std::memcpy(&length, bytes.data() + pos, sizeof(length));
+        if (bytes.size() - pos - sizeof(length) < length) {
+            break;
+        }
+        std::string value = bytes.substr(pos + sizeof(length), length);
+        stringIds_.emplace(value, static_cast<std::uint16_t>(strings_.size()));
+        strings_.push_back(std::move(value));
+        pos += sizeof(length) + length;
+    }
+    if (pos != bytes.size() && ::ftruncate(stringsFd_, static_cast<off_t>(pos)) != 0) {
+        throwErrno("주문 문자열 표의 손상된 꼬리를 잘라낼 수 없습니다");
+    }
+    if (::lseek(stringsFd_, static_cast<off_t>(pos), SEEK_SET) < 0) { // 새 문자열은 이어서 씀
+        throwErrno("주문 문자열 표 끝으로 이동할 수 없습니다");
+    }
+}
+
+void OrderLog::restore(std::size_t length, const std::function<void(std::size_t, const Record&)>& visit) {
+    if (!segments_.empty()) {
+        throw std::logic_error("레코드를 추가한 뒤에는 주문 파일을 복원할 수 없습니다.");
+    }
+    if (fileBytes_ / sizeof(Record) < length) {
+        throw std::runtime_error("주문 파일이 스냅샷에 기록된 길이(" + std::to_string(length) + "건)보다 짧습니다.");
+    }
+    // 구간을 하나씩 매핑하며 바로 훑으므로, 훑은 구간은 다음 구간을 열 때 다시 내려놓임
+    for (std::size_t index = 0; index < length; ++index) {
+        if (index == segments_.size() * SEGMENT_RECORDS) {
+            addSegment();
+        }
+        const Record& r = record(index);
+        if (r.vmid >= strings_.size() || r.drinkCode >= strings_.size() || r.payStatus >= strings_.size() ||
+            r.certLen > CERT_CODE_CAPACITY) {
+            throw std::runtime_error("주문 파일의 " + std::to_string(index) + "번 레코드가 손상되었습니다.");
+        }
+        size_ = index + 1;
+        visit(index, r);
+    }
+}
+
+void OrderLog::sync() {
+    if (::fdatasync(fd_) != 0) {
+        throwErrno("주문 파일 동기화 실패");
+    }
+}
+
+void OrderLog::addSegment() {
+    const auto offset = static_cast<off_t>(segments_.size() * SEGMENT_BYTES);
+    const std::size_t needed = static_cast<std::size_t>(offset) + SEGMENT_BYTES;
+    if (fileBytes_ < needed) { // 이미 있는 뒷부분은 줄이지 않음 (복원할 레코드가 있을 수 있음)
+        if (::ftruncate(fd_, static_cast<off_t>(needed)) != 0) {
+            throwErrno("주문 파일을 늘릴 수 없습니다");
+        }
+        fileBytes_ = needed;
+    }
+    void* mapped = ::mmap(nullptr, SEGMENT_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+    if (mapped == MAP_FAILED) {
+        throwErrno("주문 파일을 매핑할 수 없습니다");
+    }
+    segments_.push_back(static_cast<Record*>(mapped));
+
+    // 최근 구간만 남기고 오래된 구간은 내려놓음 (공유 파일 매핑이므로 내용은 파일에 남음)
+    while (segments_.size() - evictedSegments_ > hotSegments_) {
+        ::madvise(segments_[evictedSegments_], SEGMENT_BYTES, MADV_DONTNEED);
+        ++evictedSegments_;
+    }
+}
+
+std::size_t OrderLog::residentSegments() const {
+    return segments_.size() - evictedSegments_;
+}
+
+std::uint16_t OrderLog::intern(std::string_view value) {
+    std::string key(value);
+    auto it = stringIds_.find(key);
+    if (it != stringIds_.end()) {
+        return it->second;
+    }
+    if (strings_.size() > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::length_error("주문 문자열 표가 가득 찼습니다.");
+    }
+    const auto id = static_cast<std::uint16_t>(strings_.size());
+    if (stringsFd_ >= 0) {
+        // 이 번호를 가리키는 레코드보다 먼저 디스크에 남겨, 재시작 후에도 번호가 같은 문자열을 가리키게 함
+        if (key.size() > std::numeric_limits<std::uint16_t>::max()) {
+            throw std::length_error("주문 문자열이 너무 깁니다.");
+        }
+        const auto length = static_cast<std::uint16_t>(key.size());
+        std::string entry(reinterpret_cast<const char*>(&length), sizeof(length));
+        entry += key;
+        if (::write(stringsFd_, entry.data(), entry.size()) != static_cast<ssize_t>(entry.size()) ||
+            ::fdatasync(stringsFd_) != 0) {
+            throwErrno("주문 문자열 표 기록 실패");
+        }
+    }
+    strings_.push_back(key);
+    stringIds_.emplace(std::move(key), id);
+    return id;
+}
+
+std::optional<std::uint16_t> OrderLog::lookupString(std::string_view value) const {
+    auto it = stringIds_.find(std::string(value));
+    if (it == stringIds_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void OrderLog::fill(Record& record, const domain::Order& order) {
+    const std::string certCode = order.getCertCode();
+    if (certCode.size() > CERT_CODE_CAPACITY) {
+        throw std::length_error("인증 코드 '" + certCode + "'가 너무 깁니다.");
+    }
+    // 문자열 표 등록이 실패해도 레코드가 반쯤 바뀌지 않도록 번호를 먼저 구함
+    const std::uint16_t vmid = intern(order.getVmid());
+    const std::uint16_t drinkCode = intern(order.getDrinkCode());
+    const std::uint16_t payStatus = intern(order.getPayStatus());
+
+    record.qty = order.getQty();
+    record.vmid = vmid;
+    record.drinkCode = drinkCode;
+    record.payStatus = payStatus;
+    record.certLen = static_cast<std::uint8_t>(certCode.size());
+    std::memset(record.certCode, 0, sizeof(record.certCode));
+    std::memcpy(record.certCode, certCode.data(), certCode.size());
+}
+
+std::size_t OrderLog::append(const domain::Order& order) {
+    if (order.getCertCode().size() > CERT_CODE_CAPACITY) { // 구간을 늘리기 전에 거절
+        throw std::length_error("인증 코드 '" + order.getCertCode() + "'가 너무 깁니다.");
+    }
+    if (size_ == segments_.size() * SEGMENT_RECORDS) {
+        addSegment();
+    }
+    const std::size_t index = size_;
+    fill(segments_[index / SEGMENT_RECORDS][index % SEGMENT_RECORDS], order);
+    ++size_;
+    return index;
+}
+
+void OrderLog::overwrite(std::size_t index, const domain::Order& order) {
+    fill(segments_[index / SEGMENT_RECORDS][index % SEGMENT_RECORDS], order);
+}
+
+void OrderLog::setPayStatus(std::size_t index, std::string_view payStatus) {
+    segments_[index / SEGMENT_RECORDS][index % SEGMENT_RECORDS].payStatus = intern(payStatus);
+}
+
+domain::Order OrderLog::at(std::size_t index) const {
+    const Record& r = record(index);
+    return domain::Order(strings_[r.vmid], strings_[r.drinkCode], r.qty,
+                         std::string(certCodeOf(r)), strings_[r.payStatus]);
+}
+
+} // namespace persistence
@@ -1,40 +1,108 @@
 #include "persistence/OrderRepository.hpp" 
 #include "domain/order.h" 
+#include "persistence/DurableStore.hpp"
+#include "persistence/WriteAheadLog.hpp"
+#include <mutex>
 #include <vector>
 #include <string>
-#include <algorithm> 
 
 namespace persistence {
 
+// 인증 코드가 같은 주문의 레코드 번호. 인증 코드가 없으면 그런 주문 중 가장 오래된 것
+std::optional<std::size_t> OrderRepository::indexOfCertCode(const std::string& certCode) const {
+    if (certCode.empty()) {
+        return firstWithoutCertCode_;
+    }
+    auto it = byCertCode_.find(certCode);
+    if (it == byCertCode_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool OrderRepository::isPending(const OrderLog::Record& record) {
+    if (!pendingId_) {
+        pendingId_ = orders_.lookupString("PENDING"); // 아직 없으면 PENDING 주문도 없음
+    }
+    return pendingId_ && record.payStatus == *pendingId_;
+}
+
+void OrderRepository::trackPending(std::size_t index, const OrderLog::Record& record) {
+    if (isPending(record)) {
+        pendingByMachineDrink_[machineDrinkKey(record.vmid, record.drinkCode)].insert(index);
+    }
+}
+
+void OrderRepository::untrackPending(std::size_t index, const OrderLog::Record& record) {
+    if (!isPending(record)) {
+        return;
+    }
+    auto it = pendingByMachineDrink_.find(machineDrinkKey(record.vmid, record.drinkCode));
+    if (it != pendingByMachineDrink_.end()) {
+        it->second.erase(index);
+        if (it->second.empty()) {
+            pendingByMachineDrink_.erase(it);
+        }
+    }
+}
+
 // 인증 코드로 주문 조회
 domain::Order OrderRepository::findByCertCode(const std::string& certCode) {
-    auto it = std::find_if(orders_.begin(), orders_.end(),
-                           [&certCode](const domain::Order& order) {
-                               return order.getCertCode() == certCode;
-                           });
-
-    if (it != orders_.end()) {
-        return *it; // 찾았으면 해당 Order 객체 반환
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (auto index = indexOfCertCode(certCode)) {
+        return orders_.at(*index); // 찾았으면 해당 Order 객체 반환
     }
     return domain::Order(); // 빈 Order 객체 반환
 
 }
 
-// 주문 정보 저장/업데이트
-void OrderRepository::save(const domain::Order& order) {
+std::vector<domain::Order> OrderRepository::findAll() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::vector<domain::Order> all;
+    all.reserve(orders_.size());
+    for (std::size_t i = 0; i < orders_.size(); ++i) {
+        all.push_back(orders_.at(i));
+    }
+    return all;
+}
 
-    if (!order.getCertCode().empty()) {
-        auto it = std::find_if(orders_.begin(), orders_.end(),
-                               [&order](const domain::Order& o) {
-                                   return o.getCertCode() == order.getCertCode();
-                               });
-        if (it != orders_.end()) {
-            *it = order; // 동일한 certCode가 있는 주문이면 업데이트
-            return;
+std::size_t OrderRepository::size() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return orders_.size();
+}
+
+void OrderRepository::restoreStorage(std::size_t length) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    byCertCode_.clear();
+    firstWithoutCertCode_.reset();
+    pendingByMachineDrink_.clear();
+    pendingId_.reset();
+    orders_.restore(length, [this](std::size_t index, const OrderLog::Record& record) {
+        const std::string_view certCode = OrderLog::certCodeOf(record);
+        if (!certCode.empty()) {
+            byCertCode_.insert_or_assign(std::string(certCode), index);
+        } else if (!firstWithoutCertCode_) {
+            firstWithoutCertCode_ = index;
         }
+        trackPending(index, record);
+    });
+}
+
+void OrderRepository::syncStorage() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    orders_.sync();
+}
+
+// 주문 정보 저장/업데이트
+void OrderRepository::save(const domain::Order& order) {
+    if (log_ == nullptr) {
+        saveInMemory(order);
+        return;
     }
-    // 그렇지 않거나, certCode가 없는 주문이면 새로 추가
-    orders_.push_back(order);
+    log_->commit([&]() {
+        saveInMemory(order);
+        return DurableStore::orderSaveRecord(order);
+    });
 }
 
 // 주문 상태 업데이트
@@ -42,24 +110,82 @@ bool OrderRepository::updateStatus(const std::string& vmid,
                                    const std::string& drinkCode,
                                    const std::string& certCode,
                                    const std::string& newStatus) {
-    
-    auto it = std::find_if(orders_.begin(), orders_.end(),
-                           [&](const domain::Order& o) {
-                               if (!certCode.empty()) {
-                                   return o.getCertCode() == certCode;
-                               }
-                               // certCode가 없는 경우, 가장 최근의 PENDING 상태인 해당 음료 주문을 찾는다고 가정.
-                               return o.getVmid() == vmid &&
-                                      o.getDrinkCode() == drinkCode &&
-                                      o.getPayStatus() == "PENDING"; // 예시: PENDING 상태의 주문만 업데이트
-                           });
-
-    if (it != orders_.end()) {
-     
-        (*it).setPayStatus(newStatus);
-        return true;
+    if (log_ == nullptr) {
+        return updateStatusInMemory(vmid, drinkCode, certCode, newStatus).has_value();
+    }
+    return log_->commit([&]() -> std::string {
+        const std::optional<std::size_t> index = updateStatusInMemory(vmid, drinkCode, certCode, newStatus);
+        if (!index) {
+            return {};
+        }
+        // 찾은 번호를 남겨, 주문 파일에 이미 반영된 변경을 다시 적용해도 다른 주문이 바뀌지 않게 함
+        return DurableStore::orderStatusRecord(*index, newStatus);
+    });
+}
+
+bool OrderRepository::updateStatusAt(std::size_t index, const std::string& newStatus) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (index >= orders_.size()) {
+        return false;
+    }
+    setStatusAt(index, newStatus);
+    return true;
+}
+
+void OrderRepository::saveInMemory(const domain::Order& order) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const std::string certCode = order.getCertCode();
+    if (!certCode.empty()) {
+        if (auto index = indexOfCertCode(certCode)) {
+            const OrderLog::Record previous = orders_.record(*index);
+            orders_.overwrite(*index, order); // 동일한 certCode가 있는 주문이면 업데이트
+            untrackPending(*index, previous);
+            trackPending(*index, orders_.record(*index));
+            return;
+        }
+    }
+    // 그렇지 않거나, certCode가 없는 주문이면 새로 추가
+    const std::size_t index = orders_.append(order);
+    if (!certCode.empty()) {
+        byCertCode_.emplace(certCode, index);
+    } else if (!firstWithoutCertCode_) {
+        firstWithoutCertCode_ = index;
+    }
+    trackPending(index, orders_.record(index));
+}
+
+std::optional<std::size_t> OrderRepository::updateStatusInMemory(const std::string& vmid,
+                                                                 const std::string& drinkCode,
+                                                                 const std::string& certCode,
+                                                                 const std::string& newStatus) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::optional<std::size_t> index;
+    if (!certCode.empty()) {
+        index = indexOfCertCode(certCode);
+    } else {
+        // certCode가 없는 경우, PENDING 상태인 해당 음료 주문 중 가장 오래된 것을 찾음.
+        // 표에 없는 문자열이면 그런 주문도 없음
+        const auto vmidId = orders_.lookupString(vmid);
+        const auto drinkCodeId = orders_.lookupString(drinkCode);
+        if (vmidId && drinkCodeId) {
+            auto it = pendingByMachineDrink_.find(machineDrinkKey(*vmidId, *drinkCodeId));
+            if (it != pendingByMachineDrink_.end()) { // 빈 집합은 지우므로 항상 원소가 있음
+                index = *it->second.begin();
+            }
+        }
+    }
+
+    if (index) {
+        setStatusAt(*index, newStatus);
     }
-    return false; // 업데이트할 주문을 찾지 못함
+    return index; // 찾지 못했으면 업데이트하지 않음
+}
+
+void OrderRepository::setStatusAt(std::size_t index, const std::string& newStatus) {
+    const OrderLog::Record previous = orders_.record(index);
+    orders_.setPayStatus(index, newStatus);
+    untrackPending(index, previous);
+    trackPending(index, orders_.record(index));
 }
 
 
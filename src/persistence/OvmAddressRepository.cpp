@@ -1,4 +1,6 @@
 #include "persistence/OvmAddressRepository.hpp"
+#include "persistence/DurableStore.hpp"
+#include "persistence/WriteAheadLog.hpp"
 #include <vector> // for findAll
 
 namespace persistence {
@@ -26,7 +28,14 @@ std::vector<domain::VendingMachine> OvmAddressRepository::findAll() const {
 
 // 외부 자판기 정보 추가/업데이트 (초기 설정용 또는 동적 추가 시)
 void OvmAddressRepository::save(const domain::VendingMachine& vm) {
-    vms_[vm.getId()] = vm;
+    if (log_ == nullptr) {
+        vms_[vm.getId()] = vm;
+        return;
+    }
+    log_->commit([&]() {
+        vms_[vm.getId()] = vm;
+        return DurableStore::ovmSaveRecord(vm);
+    });
 }
 
 } // namespace persistence
\ No newline at end of file
@@ -0,0 +1,449 @@
+#include "persistence/WriteAheadLog.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace persistence {
+
+namespace {
+
+constexpr std::size_t FRAME_HEADER_SIZE = 8;                 // 길이 u32 + CRC32 u32
+constexpr std::uint32_t MAX_RECORD_SIZE = 16u * 1024u * 1024u; // 이보다 긴 길이 필드는 손상으로 봄
+
+std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < table.size(); ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+std::uint32_t crc32(std::string_view data) {
+    static const std::array<std::uint32_t, 256> table = makeCrcTable();
+    std::uint32_t c = 0xFFFFFFFFu;
+    for (unsigned char byte : data) {
+        c = table[(c ^ byte) & 0xFFu] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+// 레코드 앞에 붙는 로그 순번(LSN). 스냅샷 첫 프레임에는 스냅샷에 반영된 마지막 LSN만 들어 있음
+std::string withLsn(std::uint64_t lsn, std::string_view record) {
+    std::string payload(reinterpret_cast<const char*>(&lsn), sizeof(lsn));
+    payload.append(record.data(), record.size());
+    return payload;
+}
+
+std::uint64_t lsnOf(std::string_view payload) {
+    std::uint64_t lsn = 0;
+    if (payload.size() < sizeof(lsn)) {
+        throw std::runtime_error("로그 레코드에 순번이 없습니다.");
+    }
+    std::memcpy(&lsn, payload.data(), sizeof(lsn));
+    return lsn;
+}
+
+void appendFrame(std::string& out, std::string_view payload) {
+    const auto size = static_cast<std::uint32_t>(payload.size());
+    const std::uint32_t crc = crc32(payload);
+    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.append(reinterpret_cast<const char*>(&crc), sizeof(crc));
+    out.append(payload.data(), payload.size());
+}
+
+/**
+ * @brief data의 프레임을 순서대로 handler에 넘기고, 마지막으로 온전한 프레임의 끝 위치를 반환합니다.
+ */
+std::size_t forEachFrame(std::string_view data, const std::function<void(std::string_view)>& handler) {
+    std::size_t pos = 0;
+    while (data.size() - pos >= FRAME_HEADER_SIZE) {
+        std::uint32_t size = 0;
+        std::uint32_t crc = 0;
+        std::memcpy(&size, data.data() + pos, sizeof(size));
+        std::memcpy(&crc, data.data() + pos + sizeof(size), sizeof(crc));
+        if (size > MAX_RECORD_SIZE || data.size() - pos - FRAME_HEADER_SIZE < size) {
+            break; // 쓰다 만 꼬리
+        }
+        const std::string_view payload = data.substr(pos + FRAME_HEADER_SIZE, size);
+        if (crc32(payload) != crc) {
+            break; // 손상된 레코드
+        }
+        handler(payload);
+        pos += FRAME_HEADER_SIZE + size;
+    }
+    return pos;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return {};
+    }
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+[[noreturn]] void throwErrno(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+void writeAll(int fd, std::string_view data, const std::string& what) {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throwErrno(what);
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+}
+
+void syncDirectory(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd >= 0) { // rename을 디스크에 반영 (실패해도 데이터 파일 자체는 이미 기록됨)
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+// --- RecordWriter / RecordReader ---
+
+RecordWriter& RecordWriter::u8(std::uint8_t value) {
+    bytes_.push_back(static_cast<char>(value));
+    return *this;
+}
+
+RecordWriter& RecordWriter::i32(std::int32_t value) {
+    bytes_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    return *this;
+}
+
+RecordWriter& RecordWriter::i64(std::int64_t value) {
+    bytes_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    return *this;
+}
+
+RecordWriter& RecordWriter::str(std::string_view value) {
+    const auto size = static_cast<std::uint32_t>(value.size());
+    bytes_.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    bytes_.append(value.data(), value.size());
+    return *this;
+}
+
+void RecordReader::need(std::size_t size) const {
+    if (bytes_.size() - pos_ < size) {
+        throw std::runtime_error("로그 레코드가 예상보다 짧습니다.");
+    }
+}
+
+std::uint8_t RecordReader::u8() {
+    need(1);
+    return static_cast<std::uint8_t>(bytes_[pos_++]);
+}
+
+std::int32_t RecordReader::i32() {
+    std::int32_t value = 0;
+    need(sizeof(value));
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return value;
+}
+
+std::int64_t RecordReader::i64() {
+    std::int64_t value = 0;
+    need(sizeof(value));
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(value));
+    pos_ += sizeof(value);
+    return value;
+}
+
+std::string RecordReader::str() {
+    std::uint32_t size = 0;
+    need(sizeof(size));
+    std::memcpy(&size, bytes_.data() + pos_, sizeof(size));
+    pos_ += sizeof(size);
+    need(size);
+    std::string value(bytes_.substr(pos_, size));
+    pos_ += size;
+    return value;
+}
+
+// --- WriteAheadLog ---
+
+WriteAheadLog::WriteAheadLog(std::string directory, std::size_t snapshotEvery)
+    : directory_(std::move(directory)),
+      logPath_(directory_ + "/wal.log"),
+      snapshotPath_(directory_ + "/snapshot.bin"),
+      snapshotEvery_(snapshotEvery) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) {
+        throw std::runtime_error("데이터 디렉터리(" + directory_ + ")를 만들 수 없습니다: " + ec.message());
+    }
+    openLogForAppend(false);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    retryWake_.notify_all();
+    if (retryThread_.joinable()) {
+        retryThread_.join();
+    }
+    if (logFd_ >= 0) {
+        ::close(logFd_);
+    }
+}
+
+void WriteAheadLog::openLogForAppend(bool truncate) {
+    if (logFd_ >= 0) {
+        ::close(logFd_);
+    }
+    logFd_ = ::open(logPath_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+    if (logFd_ < 0) {
+        throwErrno("로그 파일(" + logPath_ + ")을 열 수 없습니다");
+    }
+}
+
+std::size_t WriteAheadLog::replay(const std::function<void(std::string_view)>& handler) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    std::size_t count = 0;
+    auto counted = [&](std::string_view payload) {
+        handler(payload);
+        ++count;
+    };
+
+    std::uint64_t snapshotLsn = 0;
+    bool first = true;
+    const std::string snapshot = readFile(snapshotPath_);
+    const std::size_t snapshotValid = forEachFrame(snapshot, [&](std::string_view payload) {
+        if (first) { // 스냅샷에 반영된 마지막 LSN
+            snapshotLsn = lsnOf(payload);
+            first = false;
+            return;
+        }
+        counted(payload);
+    });
+    if (snapshotValid != snapshot.size()) {
+        // 스냅샷은 rename으로 한 번에 바뀌므로 중간에 끊길 수 없음: 디스크 손상
+        throw std::runtime_error("스냅샷 파일(" + snapshotPath_ + ")이 손상되었습니다.");
+    }
+
+    // 스냅샷을 쓰고 로그를 비우기 전에 멈췄다면 로그 앞부분은 이미 스냅샷에 들어 있으므로 건너뜀.
+    // 순번이 늘어나지 않는 프레임(실패 후 다시 쓴 묶음과 겹치는 레코드)도 이미 적용했으므로 건너뜀
+    nextLsn_ = snapshotLsn + 1;
+    sinceSnapshot_ = 0;
+    const std::string log = readFile(logPath_);
+    const std::size_t valid = forEachFrame(log, [&](std::string_view payload) {
+        const std::uint64_t lsn = lsnOf(payload);
+        if (lsn < nextLsn_) {
+            return;
+        }
+        counted(payload.substr(sizeof(lsn)));
+        nextLsn_ = lsn + 1;
+        ++sinceSnapshot_;
+    });
+    if (valid != log.size()) { // 쓰다 만 꼬리는 버리고 그 뒤부터 이어 씀
+        if (::ftruncate(logFd_, static_cast<off_t>(valid)) != 0) {
+            throwErrno("로그 파일의 손상된 꼬리를 잘라낼 수 없습니다");
+        }
+    }
+    durableBytes_ = valid;
+    truncatePending_ = false;
+    return count;
+}
+
+void WriteAheadLog::setSnapshotSource(SnapshotSource source) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    snapshotSource_ = std::move(source);
+}
+
+void WriteAheadLog::setFailureHandler(FailureHandler handler) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    failureHandler_ = std::move(handler);
+}
+
+bool WriteAheadLog::commit(const std::function<std::string()>& apply) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    const std::string record = apply();
+    if (record.empty()) {
+        return false;
+    }
+    enqueueLocked(record);
+    // 여기부터는 메모리 변경이 이미 보이므로 실패를 던지지 않음: 호출자에게 "실패"라고 하면 일어난 변경과 어긋남
+    std::string failure;
+    try {
+        waitDurableLocked(lock, enqueued_);
+        if (snapshotEvery_ > 0 && sinceSnapshot_ >= snapshotEvery_) {
+            checkpointLocked(lock); // 실패하면 로그가 그대로 남고 다음 commit에서 다시 시도함
+        }
+    } catch (const std::exception& e) {
+        failure = e.what();
+        if (!lock.owns_lock()) {
+            lock.lock();
+        }
+        scheduleRetryLocked();
+    }
+    lock.unlock();
+    if (!failure.empty()) {
+        reportFailure(failure);
+    }
+    return true;
+}
+
+void WriteAheadLog::scheduleRetryLocked() {
+    if (!retryThread_.joinable()) {
+        retryThread_ = std::thread([this] { retryLoop(); });
+    }
+    retryWake_.notify_all();
+}
+
+void WriteAheadLog::retryLoop() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (!stopping_) {
+        retryWake_.wait_for(lock, RETRY_INTERVAL, [this] { return stopping_; });
+        if (stopping_ || durable_ == enqueued_ || flushing_) {
+            continue; // 남은 레코드가 없거나 다른 스레드가 쓰는 중
+        }
+        try {
+            waitDurableLocked(lock, enqueued_);
+        } catch (const std::exception& e) {
+            const std::string failure = e.what();
+            lock.unlock();
+            reportFailure(failure + " (다시 시도 중)");
+            lock.lock();
+        }
+    }
+}
+
+void WriteAheadLog::reportFailure(const std::string& what) {
+    FailureHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        handler = failureHandler_;
+    }
+    if (handler) {
+        handler(what);
+    }
+}
+
+void WriteAheadLog::enqueueLocked(const std::string& record) {
+    appendFrame(pending_, withLsn(nextLsn_++, record));
+    ++enqueued_;
+    ++sinceSnapshot_;
+}
+
+void WriteAheadLog::waitDurableLocked(std::unique_lock<std::mutex>& lock, std::uint64_t ticket) {
+    while (durable_ < ticket) {
+        if (flushing_) {
+            flushed_.wait(lock); // 다른 스레드가 쓰는 묶음에 포함되었거나, 끝나면 다음 묶음을 씀
+            continue;
+        }
+        // 이 스레드가 지금까지 쌓인 레코드를 한 묶음으로 씀
+        flushing_ = true;
+        std::string batch;
+        batch.swap(pending_);
+        const std::uint64_t batchEnd = enqueued_;
+        const bool truncateFirst = truncatePending_;
+        lock.unlock();
+        std::exception_ptr failure;
+        try {
+            // 이전 묶음이 실패했다면 일부만 쓰인 프레임이 남았을 수 있으므로 마지막으로 디스크에 닿은 길이로 되돌림.
+            // 그대로 이어 쓰면 재생이 손상된 프레임에서 멈춰 뒤에 다시 쓴 레코드를 잃음
+            if (truncateFirst && ::ftruncate(logFd_, static_cast<off_t>(durableBytes_)) != 0) {
+                throwErrno("실패한 로그 묶음을 잘라낼 수 없습니다");
+            }
+            writeAll(logFd_, batch, "로그 기록 실패");
+            if (::fdatasync(logFd_) != 0) {
+                throwErrno("로그 동기화 실패");
+            }
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        lock.lock();
+        flushing_ = false;
+        if (!failure) {
+            durable_ = batchEnd;
+            durableBytes_ += batch.size();
+            truncatePending_ = false;
+        } else {
+            pending_.insert(0, batch); // 잘라낸 뒤 다음 시도에서 다시 씀
+            truncatePending_ = true;
+        }
+        flushed_.notify_all();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+}
+
+void WriteAheadLog::checkpoint() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    checkpointLocked(lock);
+}
+
+void WriteAheadLog::checkpointLocked(std::unique_lock<std::mutex>& lock) {
+    flushed_.wait(lock, [this] { return !flushing_; });
+    if (!snapshotSource_) {
+        return;
+    }
+    std::string image;
+    appendFrame(image, withLsn(nextLsn_ - 1, {}));
+    for (const std::string& record : snapshotSource_()) {
+        appendFrame(image, record);
+    }
+
+    const std::string tmpPath = snapshotPath_ + ".tmp";
+    const int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throwErrno("스냅샷 임시 파일을 열 수 없습니다");
+    }
+    try {
+        writeAll(fd, image, "스냅샷 기록 실패");
+        if (::fsync(fd) != 0) {
+            throwErrno("스냅샷 동기화 실패");
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    if (::rename(tmpPath.c_str(), snapshotPath_.c_str()) != 0) {
+        throwErrno("스냅샷 파일 교체 실패");
+    }
+    syncDirectory(directory_);
+
+    // 대기 중이던 레코드의 변경은 모두 스냅샷에 들어 있으므로 로그와 함께 비움
+    openLogForAppend(true);
+    pending_.clear();
+    durable_ = enqueued_;
+    durableBytes_ = 0;
+    truncatePending_ = false;
+    sinceSnapshot_ = 0;
+    flushed_.notify_all();
+}
+
+std::size_t WriteAheadLog::recordsSinceSnapshot() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return sinceSnapshot_;
+}
+
+} // namespace persistence
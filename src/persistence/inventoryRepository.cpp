@@ -1,46 +1,117 @@
 #include "persistence/inventoryRepository.h"
+#include "domain/drinkCatalog.h" // domain::drinkCodeSlot
 #include "domain/inventory.h"
+#include "persistence/DurableStore.hpp"
+#include "persistence/WriteAheadLog.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <stdexcept>
 
 namespace persistence {
 
+namespace {
 
-void InventoryRepository::addOrUpdateStock(const domain::Inventory& inventoryItem) {
-    stock_[inventoryItem.getDrinkCode()] = inventoryItem;
+std::string drinkCodeOfSlot(std::size_t slot) {
+    char code[3];
+    std::snprintf(code, sizeof(code), "%02zu", slot);
+    return code;
 }
 
-bool InventoryRepository::isDrinkHandled(const std::string& drinkCode) const {
-    return stock_.count(drinkCode) > 0;
+} // namespace
+
+template <typename Mutation>
+bool InventoryRepository::mutateSlot(int slot, Mutation mutation) {
+    std::atomic<int>& qty = qty_[static_cast<std::size_t>(slot)];
+    if (log_ == nullptr) {
+        return mutation(qty);
+    }
+    return log_->commit([&]() -> std::string {
+        if (!mutation(qty)) {
+            return {};
+        }
+        return DurableStore::inventorySetRecord(drinkCodeOfSlot(static_cast<std::size_t>(slot)),
+                                                qty.load(std::memory_order_acquire));
+    });
 }
 
-bool InventoryRepository::hasStock(const std::string& drinkCode) const {
-    auto it = stock_.find(drinkCode);
-    if (it != stock_.end()) {
-        return it->second.getQty() >= 1;
+template <typename Apply>
+bool InventoryRepository::commitOrApply(Apply apply) {
+    if (log_ == nullptr) {
+        return !apply().empty();
     }
-    return false;
+    return log_->commit(apply);
 }
 
-bool InventoryRepository::decreaseStockByOne(const std::string& drinkCode) {
-    auto it = stock_.find(drinkCode);
-    if (it != stock_.end()) {
-        try {
-            it->second.decreaseQuantity(1);
-            return true;
-        } catch (const std::out_of_range& /* e */) {
+bool InventoryRepository::tryDecrease(std::atomic<int>& qty, int amount) {
+    int current = qty.load(std::memory_order_acquire);
+    do {
+        if (current == NOT_HANDLED || current < amount) {
+            return false; // 취급하지 않거나 재고 부족 (domain::Inventory::decreaseQuantity와 같은 조건)
+        }
+        // 실패하면 current가 최신 값으로 갱신되어 다시 확인
+    } while (!qty.compare_exchange_weak(current, current - amount, std::memory_order_acq_rel, std::memory_order_acquire));
+    return true; // 성공
+}
+
+bool InventoryRepository::tryIncrease(std::atomic<int>& qty, int amount) {
+    int current = qty.load(std::memory_order_acquire);
+    do {
+        if (current == NOT_HANDLED) {
             return false;
         }
+    } while (!qty.compare_exchange_weak(current, std::min(current + amount, MAX_QTY),
+                                        std::memory_order_acq_rel, std::memory_order_acquire));
+    return true;
+}
+
+InventoryRepository::InventoryRepository() {
+    for (auto& slot : qty_) {
+        slot.store(NOT_HANDLED, std::memory_order_relaxed);
+    }
+}
+
+void InventoryRepository::addOrUpdateStock(const domain::Inventory& inventoryItem) {
+    const int slot = domain::drinkCodeSlot(inventoryItem.getDrinkCode());
+    if (slot < 0) {
+        throw std::invalid_argument("음료 코드 '" + inventoryItem.getDrinkCode() + "'는 두 자리 숫자가 아닙니다.");
+    }
+    const int newQty = inventoryItem.getQty(); // 0~99로 제한된 값
+    mutateSlot(slot, [newQty](std::atomic<int>& qty) {
+        qty.store(newQty, std::memory_order_release);
+        return true;
+    });
+}
+
+std::optional<int> InventoryRepository::quantityOf(std::string_view drinkCode) const {
+    const int slot = domain::drinkCodeSlot(drinkCode);
+    if (slot < 0) {
+        return std::nullopt;
+    }
+    const int qty = qty_[static_cast<std::size_t>(slot)].load(std::memory_order_acquire);
+    if (qty == NOT_HANDLED) {
+        return std::nullopt;
     }
-    return false;
+    return qty;
+}
+
+bool InventoryRepository::isDrinkHandled(const std::string& drinkCode) const {
+    return quantityOf(drinkCode).has_value();
+}
+
+bool InventoryRepository::hasStock(const std::string& drinkCode) const {
+    return quantityOf(drinkCode).value_or(0) >= 1;
+}
+
+bool InventoryRepository::decreaseStockByOne(const std::string& drinkCode) {
+    return decreaseStockByAmount(drinkCode, 1);
 }
 
 /**
  * @brief 특정 음료 코드에 해당하는 Inventory 객체를 반환합니다.
  */
 domain::Inventory InventoryRepository::getInventoryByDrinkCode(const std::string& drinkCode) const {
-    auto it = stock_.find(drinkCode);
-    if (it != stock_.end()) {
-        return it->second; // 찾았으면 해당 Inventory 객체 반환
+    if (auto qty = quantityOf(drinkCode)) {
+        return domain::Inventory(drinkCode, *qty); // 찾았으면 해당 Inventory 객체 반환
     }
     // 찾지 못했으면, drinkCode가 비어있거나 qty가 0인 기본 Inventory 객체 반환
     return domain::Inventory();
@@ -56,18 +127,83 @@ bool InventoryRepository::decreaseStockByAmount(const std::string& drinkCode, in
     if (amount <= 0) { // 감소량이 0 이하면 처리 안 함
         return false;
     }
-    auto it = stock_.find(drinkCode);
-    if (it != stock_.end()) {
-        try {
-            it->second.decreaseQuantity(amount); // domain::Inventory의 메소드 사용
-            return true; // 성공
-        } catch (const std::out_of_range&) {
-            // domain::Inventory에서 재고 부족으로 예외 발생
-            return false; // 실패 알림
+    const int slot = domain::drinkCodeSlot(drinkCode);
+    if (slot < 0) {
+        return false; // 해당 음료를 찾을 수 없음
+    }
+    return mutateSlot(slot, [amount](std::atomic<int>& qty) { return tryDecrease(qty, amount); });
+}
+
+bool InventoryRepository::increaseStockByAmount(const std::string& drinkCode, int amount) {
+    if (amount <= 0) {
+        return false;
+    }
+    const int slot = domain::drinkCodeSlot(drinkCode);
+    if (slot < 0) {
+        return false;
+    }
+    return mutateSlot(slot, [amount](std::atomic<int>& qty) { return tryIncrease(qty, amount); });
+}
+
+bool InventoryRepository::holdStock(const Hold& hold) {
+    const int slot = domain::drinkCodeSlot(hold.drinkCode);
+    if (slot < 0 || hold.amount <= 0) {
+        return false;
+    }
+    std::atomic<int>& qty = qty_[static_cast<std::size_t>(slot)];
+    return commitOrApply([&]() -> std::string {
+        std::lock_guard<std::mutex> lock(holdsMtx_);
+        if (holds_.count(hold.id) != 0 || !tryDecrease(qty, hold.amount)) {
+            return {};
+        }
+        holds_.emplace(hold.id, hold);
+        return DurableStore::holdAddRecord(hold, qty.load(std::memory_order_acquire));
+    });
+}
+
+std::optional<InventoryRepository::Hold> InventoryRepository::endHold(const std::string& holdId, bool returnToStock) {
+    std::optional<Hold> ended;
+    commitOrApply([&]() -> std::string {
+        std::lock_guard<std::mutex> lock(holdsMtx_);
+        auto it = holds_.find(holdId);
+        if (it == holds_.end()) {
+            return {};
+        }
+        ended = std::move(it->second);
+        holds_.erase(it);
+        std::atomic<int>& qty = qty_[static_cast<std::size_t>(domain::drinkCodeSlot(ended->drinkCode))];
+        if (returnToStock) {
+            tryIncrease(qty, ended->amount); // 그사이 취급을 멈춘 음료면 되돌릴 곳이 없음
         }
+        return DurableStore::holdEndRecord(holdId, ended->drinkCode, qty.load(std::memory_order_acquire));
+    });
+    return ended;
+}
+
+void InventoryRepository::restoreHold(const Hold& hold) {
+    std::lock_guard<std::mutex> lock(holdsMtx_);
+    holds_[hold.id] = hold;
+}
+
+std::vector<InventoryRepository::Hold> InventoryRepository::findAllHolds() const {
+    std::lock_guard<std::mutex> lock(holdsMtx_);
+    std::vector<Hold> holds;
+    holds.reserve(holds_.size());
+    for (const auto& entry : holds_) {
+        holds.push_back(entry.second);
     }
-    return false; // 해당 음료를 찾을 수 없음
+    return holds;
 }
 
+std::vector<domain::Inventory> InventoryRepository::findAll() const {
+    std::vector<domain::Inventory> items;
+    for (std::size_t slot = 0; slot < SLOT_COUNT; ++slot) {
+        const int qty = qty_[slot].load(std::memory_order_acquire);
+        if (qty != NOT_HANDLED) {
+            items.emplace_back(drinkCodeOfSlot(slot), qty);
+        }
+    }
+    return items;
+}
 
-} // namespace persistence
\ No newline at end of file
+} // namespace persistence
@@ -1,4 +1,6 @@
 #include "persistence/prepayCodeRepository.h"
+#include "persistence/DurableStore.hpp"
+#include "persistence/WriteAheadLog.hpp"
 #include <map> // 내부 저장소로 std::map 사용
 
 namespace persistence {
@@ -20,7 +22,14 @@ domain::PrePaymentCode PrepayCodeRepository::findByCode(const std::string& code)
 void PrepayCodeRepository::save(const domain::PrePaymentCode& prepayCode) {
     // prepayCode의 code_attribute를 키로 사용하여 정보를 저장하거나 업데이트합니다.
     // PrePaymentCode 객체 자체가 코드 문자열을 가지고 있으므로, prepayCode.getCode()를 사용합니다.
-    codes_[prepayCode.getCode()] = prepayCode;
+    if (log_ == nullptr) {
+        codes_[prepayCode.getCode()] = prepayCode;
+    } else {
+        log_->commit([&]() {
+            codes_[prepayCode.getCode()] = prepayCode;
+            return DurableStore::prepaySaveRecord(prepayCode);
+        });
+    }
     // UC12 (인증코드 발급) 단계에서 생성된 인증코드가 저장됩니다. 
     // UC15 (선결제요청 수신 및 재고 확보) 단계에서도 다른 자판기의 요청으로 코드가 저장될 수 있습니다. [cite: 32]
     // 이때 PrePayment.code = AuthCode.code로 저장하는 로직이 있음. [cite: 32]
@@ -33,7 +42,14 @@ bool PrepayCodeRepository::updateStatus(const std::string& code, domain::CodeSta
 
         if (newStatus == domain::CodeStatus::USED) {
             if (it->second.isUsable()) { // ACTIVE 상태일 때만 USED로 변경 가능
-                it->second.markAsUsed(); // UC14: "일치할 경우 AuthCode를 만료시킨다." 
+                if (log_ == nullptr) {
+                    it->second.markAsUsed(); // UC14: "일치할 경우 AuthCode를 만료시킨다." 
+                } else {
+                    log_->commit([&]() {
+                        it->second.markAsUsed();
+                        return DurableStore::prepayStatusRecord(code, static_cast<int>(newStatus));
+                    });
+                }
             } else {
                 // 이미 USED 상태이거나 다른 비활성 상태일 수 있음
                 return false; 
@@ -44,4 +60,14 @@ bool PrepayCodeRepository::updateStatus(const std::string& code, domain::CodeSta
     return false; // 코드를 찾지 못함
 }
 
+// 저장된 모든 선결제 정보 조회
+std::vector<domain::PrePaymentCode> PrepayCodeRepository::findAll() const {
+    std::vector<domain::PrePaymentCode> allCodes;
+    allCodes.reserve(codes_.size());
+    for (const auto& [code, prepayCode] : codes_) {
+        allCodes.push_back(prepayCode);
+    }
+    return allCodes;
+}
+
 } // namespace persistence
\ No newline at end of file
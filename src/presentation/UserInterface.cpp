@@ -14,12 +14,12 @@
 namespace presentation {
 
 
-bool UserInterface::isDrinkCodeValid(const std::string& code, const std::vector<domain::Drink>& allDrinks) const {
+bool UserInterface::isDrinkCodeValid(const std::string& code, domain::DrinkSpan allDrinks) const {
     if (code.length() != 2 || !std::all_of(code.begin(), code.end(), ::isdigit)) {
         return false;
     }
     for (const auto& drink : allDrinks) {
-        if (drink.getDrinkCode() == code) {
+        if (drink.drinkCodeView() == code) {
             return true;
         }
     }
@@ -82,7 +82,7 @@ std::string UserInterface::getUserInputString(const std::string& prompt) {
 
 // --- 음료 관련 ---
 
-void UserInterface::displayDrinkList(const std::vector<domain::Drink>& allDrinks) {
+void UserInterface::displayDrinkList(domain::DrinkSpan allDrinks) {
     // UC1.1 & UC1.2: 전체 음료 목록을 화면에 표시하고, 사용자가 확인.
     std::cout << "\n--- 음료 목록 (총 " << allDrinks.size() << "종) ---" << std::endl;
     std::cout << "+----------+--------------------+----------+" << std::endl;
@@ -96,15 +96,15 @@ void UserInterface::displayDrinkList(const std::vector<domain::Drink>& allDrinks
         std::cout << "| 현재 판매 가능한 음료 정보를 불러올 수 없습니다.         |" << std::endl;
     } else {
         for (const auto& drink : allDrinks) {
-            std::cout << "| " << std::left << std::setw(8) << drink.getDrinkCode() << " | "
-                      << std::left << std::setw(18) << drink.getName() << " | "
+            std::cout << "| " << std::left << std::setw(8) << drink.drinkCodeView() << " | "
+                      << std::left << std::setw(18) << drink.nameView() << " | "
                       << std::right << std::setw(7) << drink.getPrice() << "원 |" << std::endl;
         }
     }
     std::cout << "+----------+--------------------+----------+" << std::endl;
 }
 
-std::string UserInterface::selectDrink(const std::vector<domain::Drink>& allDrinks) {
+std::string UserInterface::selectDrink(domain::DrinkSpan allDrinks) {
     std::string drinkCodeInput;
     // UC2.1: 사용자가 화면에서 원하는 음료를 선택한다.
     while (true) {
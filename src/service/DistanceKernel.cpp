@@ -0,0 +1,122 @@
+#include "service/DistanceKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DISTANCE_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace service {
+
+namespace {
+
+void squaredDistancesScalar(const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                            std::int32_t qx, std::int32_t qy, std::uint32_t* out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        // 합이 2^31에 이를 수 있으므로 부호 없는 정수로 곱해 SIMD 구현과 같은 결과를 냅니다.
+        const auto dx = static_cast<std::uint32_t>(xs[i] - qx);
+        const auto dy = static_cast<std::uint32_t>(ys[i] - qy);
+        out[i] = dx * dx + dy * dy;
+    }
+}
+
+#ifdef DISTANCE_KERNEL_X86
+// 빌드 옵션과 관계없이 함수 단위로 명령어를 켜고, 실행 시 CPU 지원 여부를 확인한 뒤에만 호출합니다.
+__attribute__((target("sse4.1")))
+void squaredDistancesSse41(const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                           std::int32_t qx, std::int32_t qy, std::uint32_t* out) {
+    const __m128i vqx = _mm_set1_epi32(qx);
+    const __m128i vqy = _mm_set1_epi32(qy);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128i dx = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(xs + i)), vqx);
+        const __m128i dy = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ys + i)), vqy);
+        const __m128i d2 = _mm_add_epi32(_mm_mullo_epi32(dx, dx), _mm_mullo_epi32(dy, dy));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), d2);
+    }
+    squaredDistancesScalar(xs + i, ys + i, n - i, qx, qy, out + i);
+}
+
+__attribute__((target("avx2")))
+void squaredDistancesAvx2(const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                          std::int32_t qx, std::int32_t qy, std::uint32_t* out) {
+    const __m256i vqx = _mm256_set1_epi32(qx);
+    const __m256i vqy = _mm256_set1_epi32(qy);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + i)), vqx);
+        const __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + i)), vqy);
+        const __m256i d2 = _mm256_add_epi32(_mm256_mullo_epi32(dx, dx), _mm256_mullo_epi32(dy, dy));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), d2);
+    }
+    squaredDistancesScalar(xs + i, ys + i, n - i, qx, qy, out + i);
+}
+#endif
+
+DistanceKernel::Isa detectIsa() {
+#ifdef DISTANCE_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return DistanceKernel::Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return DistanceKernel::Isa::SSE41;
+    }
+#endif
+    return DistanceKernel::Isa::SCALAR;
+}
+
+} // namespace
+
+DistanceKernel::Isa DistanceKernel::activeIsa() {
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+bool DistanceKernel::isSupported(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+        case Isa::SSE41:
+            return activeIsa() == Isa::SSE41 || activeIsa() == Isa::AVX2;
+        case Isa::AVX2:
+            return activeIsa() == Isa::AVX2;
+    }
+    return false;
+}
+
+const char* DistanceKernel::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE41:
+            return "sse4.1";
+        case Isa::AVX2:
+            return "avx2";
+        case Isa::SCALAR:
+        default:
+            return "scalar";
+    }
+}
+
+void DistanceKernel::squaredDistances(const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                                      std::int32_t qx, std::int32_t qy, std::uint32_t* out) {
+    squaredDistances(activeIsa(), xs, ys, n, qx, qy, out);
+}
+
+void DistanceKernel::squaredDistances(Isa isa, const std::int32_t* xs, const std::int32_t* ys, std::size_t n,
+                                      std::int32_t qx, std::int32_t qy, std::uint32_t* out) {
+    if (!isSupported(isa)) {
+        isa = Isa::SCALAR;
+    }
+#ifdef DISTANCE_KERNEL_X86
+    if (isa == Isa::AVX2) {
+        squaredDistancesAvx2(xs, ys, n, qx, qy, out);
+        return;
+    }
+    if (isa == Isa::SSE41) {
+        squaredDistancesSse41(xs, ys, n, qx, qy, out);
+        return;
+    }
+#endif
+    squaredDistancesScalar(xs, ys, n, qx, qy, out);
+}
+
+} // namespace service
@@ -1,30 +1,42 @@
-
-
 #include "service/DistanceService.hpp"
+#include "service/DistanceKernel.hpp"
 #include "domain/vendingMachine.h" // domain::VendingMachine 객체 생성 및 반환을 위해 필요
-#include <algorithm> // std::sort
+#include <algorithm> // std::find, std::min, std::partial_sort
+#include <charconv>  // std::from_chars (ID 숫자 부분 해석)
+#include <cstdlib>   // std::abs
+#include <iterator>  // std::prev
 #include <vector>    // std::vector 사용
-#include <utility>   // std::pair 사용 (candidatesWithDistance)
-#include <stdexcept> // std::invalid_argument, std::out_of_range (extractNumericId에서 throw)
 
 namespace service {
 
-
-int DistanceService::extractNumericId(const std::string& vmId) const {
+int DistanceService::parseNumericId(const std::string& vmId) {
     if (vmId.length() > 1 && (vmId[0] == 'T' || vmId[0] == 't')) {
-        try {
-            // 'T' 다음 문자열부터 숫자 부분 추출
-            return std::stoi(vmId.substr(1));
-        } catch (const std::invalid_argument& ia) {
-            // std::stoi가 숫자로 변환할 수 없는 문자열을 만났을 때
-            throw std::invalid_argument("자판기 ID '" + vmId + "'에서 숫자 부분을 추출할 수 없습니다: " + ia.what());
-        } catch (const std::out_of_range& oor) {
-            // std::stoi가 변환한 숫자가 int 범위를 벗어났을 때
-            throw std::out_of_range("자판기 ID '" + vmId + "'의 숫자 부분이 범위를 벗어났습니다: " + oor.what());
+        int value = 0;
+        const char* first = vmId.data() + 1;
+        const char* last = vmId.data() + vmId.size();
+        auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec == std::errc() && ptr == last && value >= 0) {
+            return value;
         }
     }
-    // 'T'로 시작하지 않거나 길이가 너무 짧은 경우
-    throw std::invalid_argument("유효하지 않은 자판기 ID 형식입니다: '" + vmId + "' (예: T1, T12)");
+    return -1; // 'T'로 시작하지 않거나 숫자 부분이 없거나 범위를 벗어남
+}
+
+bool DistanceService::ranksBefore(const RankKey& a, const RankKey& b) {
+    if (a.squaredDistance != b.squaredDistance) {
+        return a.squaredDistance < b.squaredDistance; // 1순위: 거리 오름차순
+    }
+    // 2순위 (거리가 같을 시): ID의 숫자 부분 오름차순. 숫자로 해석할 수 없는 ID는 뒤로 보내고 그들끼리는 문자열 비교
+    // (정렬에 쓰이므로 어떤 ID 조합에서도 순서가 일관되어야 함)
+    const bool aNumeric = a.numericId >= 0;
+    const bool bNumeric = b.numericId >= 0;
+    if (aNumeric != bNumeric) {
+        return aNumeric;
+    }
+    if (aNumeric && a.numericId != b.numericId) {
+        return a.numericId < b.numericId;
+    }
+    return *a.id < *b.id;
 }
 
 std::optional<domain::VendingMachine> DistanceService::findNearestAvailableVendingMachine(
@@ -32,47 +44,262 @@ std::optional<domain::VendingMachine> DistanceService::findNearestAvailableVendi
     int currentVmY,
     const std::vector<OtherVendingMachineInfo>& otherVms
 ) const {
-    if (otherVms.empty()) {
-        return std::nullopt; // 후보 자판기가 없음
+    // 재고가 있는 자판기 중 가장 앞 순위를 한 번의 순회로 찾음 (PFR R3.2)
+    const OtherVendingMachineInfo* nearest = nullptr;
+    RankKey best{};
+    for (const auto& vmInfo : otherVms) {
+        if (!vmInfo.hasStock) { // 재고가 있는 자판기만 고려
+            continue;
+        }
+        RankKey key{squaredDistance(currentVmX, currentVmY, vmInfo.coordX, vmInfo.coordY), -1, &vmInfo.id};
+        if (nearest != nullptr && key.squaredDistance > best.squaredDistance) {
+            continue; // 더 멀면 ID를 해석할 필요도 없음
+        }
+        key.numericId = parseNumericId(vmInfo.id);
+        if (nearest == nullptr || ranksBefore(key, best)) {
+            nearest = &vmInfo;
+            best = key;
+        }
     }
 
-    std::vector<std::pair<double, OtherVendingMachineInfo>> candidatesWithDistance;
-    candidatesWithDistance.reserve(otherVms.size()); // 메모리 할당 최적화
+    if (nearest == nullptr) {
+        return std::nullopt; // 재고가 있는 자판기가 하나도 없음
+    }
+    return domain::VendingMachine(nearest->id, nearest->coordX, nearest->coordY, ""); // 포트 정보는 현재 알 수 없음
+}
 
-    // 1. 재고가 있는 자판기만 필터링하고, 거리를 계산하여 (거리, 자판기정보) 쌍으로 저장
+std::vector<domain::VendingMachine> DistanceService::rankNearestAvailableVendingMachines(
+    int currentVmX,
+    int currentVmY,
+    const std::vector<OtherVendingMachineInfo>& otherVms,
+    std::size_t k
+) const {
+    std::vector<std::pair<RankKey, const OtherVendingMachineInfo*>> candidates;
+    candidates.reserve(otherVms.size());
     for (const auto& vmInfo : otherVms) {
-        if (vmInfo.hasStock) { // 재고가 있는 자판기만 고려
-            double dist = calculateDistance(currentVmX, currentVmY, vmInfo.coordX, vmInfo.coordY);
-            candidatesWithDistance.emplace_back(dist, vmInfo);
+        if (vmInfo.hasStock) {
+            candidates.push_back({RankKey{squaredDistance(currentVmX, currentVmY, vmInfo.coordX, vmInfo.coordY),
+                                          parseNumericId(vmInfo.id), &vmInfo.id}, &vmInfo});
         }
     }
 
-    if (candidatesWithDistance.empty()) {
-        return std::nullopt; // 재고가 있는 자판기가 하나도 없음
+    // 상위 k개만 순위 순으로 정렬하고 나머지는 순서를 정하지 않음
+    const std::size_t count = std::min(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(count), candidates.end(),
+        [](const auto& a, const auto& b) { return ranksBefore(a.first, b.first); });
+
+    std::vector<domain::VendingMachine> ranked;
+    ranked.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const OtherVendingMachineInfo& vmInfo = *candidates[i].second;
+        ranked.emplace_back(vmInfo.id, vmInfo.coordX, vmInfo.coordY, ""); // 포트 정보는 현재 알 수 없음
     }
+    return ranked;
+}
+
+int DistanceService::parseDrinkCode(const std::string& drinkCode) {
+    int value = 0;
+    const char* first = drinkCode.data();
+    const char* last = first + drinkCode.size();
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    if (drinkCode.empty() || ec != std::errc() || ptr != last || value < 0 || value >= COORD_LIMIT) {
+        return -1;
+    }
+    return value;
+}
+
+int DistanceService::cellOf(int coord) {
+    return std::min(std::max(coord, 0), COORD_LIMIT - 1) / (COORD_LIMIT / GRID_SIZE);
+}
+
+void DistanceService::addToCell(std::uint32_t slot, int cell, int x, int y, const std::bitset<COORD_LIMIT>& stock) {
+    GridCell& target = cells_[cell];
+    machines_[slot].cell = cell;
+    machines_[slot].cellPos = static_cast<std::uint32_t>(target.slots.size());
+    target.xs.push_back(x);
+    target.ys.push_back(y);
+    target.stock.push_back(stock);
+    target.slots.push_back(slot);
+}
+
+std::bitset<DistanceService::COORD_LIMIT> DistanceService::removeFromCell(std::uint32_t slot) {
+    GridCell& source = cells_[machines_[slot].cell];
+    const std::uint32_t pos = machines_[slot].cellPos;
+    const std::uint32_t last = static_cast<std::uint32_t>(source.slots.size() - 1);
+    const std::bitset<COORD_LIMIT> stock = source.stock[pos];
+    if (pos != last) { // 칸의 마지막 자판기를 빈자리로 옮겨 배열을 빈틈없이 유지
+        source.xs[pos] = source.xs[last];
+        source.ys[pos] = source.ys[last];
+        source.stock[pos] = source.stock[last];
+        source.slots[pos] = source.slots[last];
+        machines_[source.slots[pos]].cellPos = pos;
+    }
+    source.xs.pop_back();
+    source.ys.pop_back();
+    source.stock.pop_back();
+    source.slots.pop_back();
+    return stock;
+}
 
-    // 2. 거리 및 ID 기준으로 정렬 (PFR R3.2)
-    //    - 1순위: 거리 오름차순
-    //    - 2순위 (거리가 같을 시): ID의 숫자 부분 오름차순
-    std::sort(candidatesWithDistance.begin(), candidatesWithDistance.end(),
-        [this](const auto& a, const auto& b) { // 람다 비교 함수
-            if (a.first < b.first) return true;  // 거리가 다르면 거리 기준
-            if (a.first > b.first) return false;
-            
-            // 거리가 같은 경우, ID의 숫자 부분으로 비교
-            try {
-                return extractNumericId(a.second.id) < extractNumericId(b.second.id);
-            } catch (const std::exception& e) {
-                // ID 파싱 실패 시 단순 문자열 비교
-                return a.second.id < b.second.id;
+void DistanceService::upsertMachine(const std::string& vmId, int x, int y) {
+    if (x < 0 || x >= COORD_LIMIT || y < 0 || y >= COORD_LIMIT) {
+        throw std::invalid_argument("자판기 '" + vmId + "'의 좌표가 범위(0~99)를 벗어났습니다.");
+    }
+    std::lock_guard<std::mutex> lock(indexMtx_);
+    const int newCell = cellOf(y) * GRID_SIZE + cellOf(x);
+    auto found = slotById_.find(vmId);
+    if (found == slotById_.end()) {
+        const auto slot = static_cast<std::uint32_t>(machines_.size());
+        machines_.push_back(IndexedMachine{vmId, parseNumericId(vmId), newCell, 0});
+        slotById_.emplace(vmId, slot);
+        addToCell(slot, newCell, x, y, {});
+        return;
+    }
+
+    const auto slot = static_cast<std::uint32_t>(found->second);
+    IndexedMachine& machine = machines_[slot];
+    if (machine.cell == newCell) {
+        cells_[newCell].xs[machine.cellPos] = x;
+        cells_[newCell].ys[machine.cellPos] = y;
+        return;
+    }
+    const std::bitset<COORD_LIMIT> stock = removeFromCell(slot);
+    addToCell(slot, newCell, x, y, stock);
+}
+
+void DistanceService::removeMachine(const std::string& vmId) {
+    std::lock_guard<std::mutex> lock(indexMtx_);
+    auto found = slotById_.find(vmId);
+    if (found == slotById_.end()) {
+        return;
+    }
+    const auto slot = static_cast<std::uint32_t>(found->second);
+    const auto lastSlot = static_cast<std::uint32_t>(machines_.size() - 1);
+
+    removeFromCell(slot);
+    slotById_.erase(found);
+
+    if (slot != lastSlot) { // 마지막 자판기를 빈자리로 옮겨 machines_를 빈틈없이 유지
+        IndexedMachine& moved = machines_[lastSlot];
+        cells_[moved.cell].slots[moved.cellPos] = slot;
+        slotById_[moved.id] = slot;
+        machines_[slot] = std::move(moved);
+    }
+    machines_.pop_back();
+}
+
+bool DistanceService::setStock(const std::string& vmId, const std::string& drinkCode, bool hasStock) {
+    const int drink = parseDrinkCode(drinkCode);
+    if (drink < 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(indexMtx_);
+    auto found = slotById_.find(vmId);
+    if (found == slotById_.end()) {
+        return false;
+    }
+    const IndexedMachine& machine = machines_[found->second];
+    cells_[machine.cell].stock[machine.cellPos].set(static_cast<std::size_t>(drink), hasStock);
+    return true;
+}
+
+std::vector<domain::VendingMachine> DistanceService::findNearestWithStock(int x, int y, const std::string& drinkCode, std::size_t k) const {
+    std::vector<domain::VendingMachine> result;
+    const int drink = parseDrinkCode(drinkCode);
+    if (drink < 0 || k == 0) {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(indexMtx_);
+    // 지금까지의 상위 k개를 순위 순으로 유지 (k가 작으므로 삽입 정렬)
+    std::vector<std::pair<RankKey, std::uint32_t>> top;
+    top.reserve(k + 1);
+    auto consider = [&](const RankKey& key, std::uint32_t slot) {
+        if (top.size() == k && !ranksBefore(key, top.back().first)) {
+            return;
+        }
+        auto pos = top.end();
+        while (pos != top.begin() && ranksBefore(key, std::prev(pos)->first)) {
+            --pos;
+        }
+        top.insert(pos, {key, slot});
+        if (top.size() > k) {
+            top.pop_back();
+        }
+    };
+
+    // 저장된 좌표는 0~99이므로 기준점이 커널 범위 안이면 거리 제곱이 32비트에 들어감
+    const bool useKernel = std::abs(static_cast<std::int64_t>(x)) <= DistanceKernel::COORD_BOUND &&
+                           std::abs(static_cast<std::int64_t>(y)) <= DistanceKernel::COORD_BOUND;
+    const int cellX = cellOf(x);
+    const int cellY = cellOf(y);
+    const int cellWidth = COORD_LIMIT / GRID_SIZE;
+    for (int ring = 0; ring < GRID_SIZE; ++ring) {
+        if (top.size() == k && ring > 0) {
+            // ring번째 고리의 칸은 기준점에서 최소 (ring-1)칸 + 1좌표 떨어져 있음
+            const std::int64_t gap = static_cast<std::int64_t>(cellWidth) * (ring - 1) + 1;
+            if (gap * gap > top.back().first.squaredDistance) {
+                break; // 남은 칸의 자판기는 k번째 후보보다 멀어 순위에 들 수 없음
             }
-        });
+        }
+        for (int cy = cellY - ring; cy <= cellY + ring; ++cy) {
+            if (cy < 0 || cy >= GRID_SIZE) {
+                continue;
+            }
+            // 고리의 위/아래 줄은 전부, 나머지 줄은 양 끝 칸만
+            const bool edgeRow = (cy == cellY - ring || cy == cellY + ring);
+            const int step = (edgeRow || ring == 0) ? 1 : 2 * ring;
+            for (int cx = cellX - ring; cx <= cellX + ring; cx += step) {
+                if (cx < 0 || cx >= GRID_SIZE) {
+                    continue;
+                }
+                const GridCell& cell = cells_[cy * GRID_SIZE + cx];
+                const std::size_t count = cell.slots.size();
+                if (!useKernel) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (cell.stock[i].test(static_cast<std::size_t>(drink))) {
+                            const IndexedMachine& machine = machines_[cell.slots[i]];
+                            consider(RankKey{squaredDistance(x, y, cell.xs[i], cell.ys[i]), machine.numericId, &machine.id},
+                                     cell.slots[i]);
+                        }
+                    }
+                    continue;
+                }
 
-    // 3. 가장 우선순위가 높은 (가장 가깝고, ID 조건 만족하는) 자판기 정보 추출
-    const auto& nearestVmInfo = candidatesWithDistance.front().second;
+                distanceScratch_.resize(count);
+                std::uint32_t* keys = distanceScratch_.data();
+                DistanceKernel::squaredDistances(cell.xs.data(), cell.ys.data(), count, x, y, keys);
+                // 재고 없는 자판기는 분기 없이 키를 UINT32_MAX로 만들어 아래 비교에서 떨어뜨림
+                for (std::size_t i = 0; i < count; ++i) {
+                    const std::uint32_t missing = cell.stock[i].test(static_cast<std::size_t>(drink)) ? 0u : 1u;
+                    keys[i] |= 0u - missing;
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    const std::uint32_t threshold = top.size() == k
+                        ? static_cast<std::uint32_t>(top.back().first.squaredDistance)
+                        : UINT32_MAX - 1;
+                    if (keys[i] > threshold) {
+                        continue;
+                    }
+                    const IndexedMachine& machine = machines_[cell.slots[i]];
+                    consider(RankKey{keys[i], machine.numericId, &machine.id}, cell.slots[i]);
+                }
+            }
+        }
+    }
+
+    result.reserve(top.size());
+    for (const auto& entry : top) {
+        const IndexedMachine& machine = machines_[entry.second];
+        const GridCell& cell = cells_[machine.cell];
+        result.emplace_back(machine.id, cell.xs[machine.cellPos], cell.ys[machine.cellPos], "");
+    }
+    return result;
+}
 
-    // 4. domain::VendingMachine 객체로 변환하여 반환
-    return domain::VendingMachine(nearestVmInfo.id, nearestVmInfo.coordX, nearestVmInfo.coordY, ""); // 포트 정보는 현재 알 수 없음
+std::size_t DistanceService::indexedMachineCount() const {
+    std::lock_guard<std::mutex> lock(indexMtx_);
+    return machines_.size();
 }
 
 } // namespace service
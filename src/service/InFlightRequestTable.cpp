@@ -0,0 +1,242 @@
+#include "service/InFlightRequestTable.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <random>
+#include <thread>
+#include <variant>
+
+namespace service {
+
+namespace {
+    const std::string& itemCodeOf(const network::Message& msg) {
+        return std::visit([](const auto& content) -> const std::string& { return content.item_code; }, msg.msg_content);
+    }
+
+    bool isResponseType(network::MessageType type) {
+        return type == network::MessageType::RESP_STOCK || type == network::MessageType::RESP_PREPAY;
+    }
+}
+
+InFlightRequestTable::InFlightRequestTable()
+    : salt_(static_cast<std::uint64_t>(std::random_device{}()) << 32) {}
+
+std::int64_t InFlightRequestTable::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// FNV-1a. 0은 "키 없음"으로 쓰므로 결과의 최하위 비트를 항상 1로 둡니다.
+std::uint64_t InFlightRequestTable::makeMatchKey(network::MessageType type, const std::string& itemCode, const std::string& peerId) {
+    std::uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](unsigned char c) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    };
+    mix(static_cast<unsigned char>(type));
+    for (char c : itemCode) mix(static_cast<unsigned char>(c));
+    mix(0);
+    for (char c : peerId) mix(static_cast<unsigned char>(c));
+    return hash | 1;
+}
+
+std::string InFlightRequestTable::formatId(std::uint64_t id) {
+    char digits[16];
+    auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), id, 16);
+    (void)ec;
+    return std::string(digits, end);
+}
+
+bool InFlightRequestTable::parseId(const std::string& text, std::uint64_t& id) {
+    const char* first = text.data();
+    const char* last = first + text.size();
+    auto [ptr, ec] = std::from_chars(first, last, id, 16);
+    return ec == std::errc() && ptr == last && id != 0;
+}
+
+std::string InFlightRequestTable::insert(network::MessageType responseType, const std::string& itemCode, const std::string& peerId,
+                                         std::size_t expectedResponses, std::chrono::milliseconds timeout, ResponseHandler handler) {
+    const std::int64_t now = nowNs();
+    for (Slot& slot : slots_) {
+        if (!tryClaim(slot, now)) {
+            continue;
+        }
+        std::uint32_t sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+        if (sequence == 0) { // 0은 "ID 없음"이므로 건너뜀
+            sequence = next_sequence_.fetch_add(1, std::memory_order_relaxed);
+        }
+        const std::uint64_t id = salt_ | sequence;
+
+        slot.responseType = responseType;
+        slot.itemCode = itemCode;
+        slot.peerId = peerId;
+        slot.expectedResponses = expectedResponses;
+        slot.responders.clear();
+        slot.handler = std::move(handler);
+        slot.deadlineNs.store(now + std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count(), std::memory_order_relaxed);
+        slot.matchKey.store(makeMatchKey(responseType, itemCode, peerId), std::memory_order_relaxed);
+        slot.id.store(id, std::memory_order_relaxed);
+        slot.state.store(ACTIVE, std::memory_order_release); // 위 필드를 모두 쓴 뒤 공개
+        return formatId(id);
+    }
+    return std::string(); // 가득 참
+}
+
+InFlightRequestTable::RouteResult InFlightRequestTable::route(const network::Message& response) {
+    if (!isResponseType(response.msg_type)) {
+        unmatched_.fetch_add(1, std::memory_order_relaxed);
+        return RouteResult::UNMATCHED;
+    }
+
+    Slot* slot = nullptr;
+    std::uint64_t id = 0;
+    if (!response.corr_id.empty()) {
+        if (!parseId(response.corr_id, id) || (slot = findById(id)) == nullptr) {
+            stale_.fetch_add(1, std::memory_order_relaxed); // 이미 끝났거나 이 프로세스가 발급하지 않은 ID
+            return RouteResult::STALE;
+        }
+    } else {
+        slot = findByFallback(response);
+        if (slot == nullptr) {
+            unmatched_.fetch_add(1, std::memory_order_relaxed);
+            return RouteResult::UNMATCHED;
+        }
+        id = slot->id.load(std::memory_order_acquire);
+    }
+
+    if (!acquireForDelivery(*slot, id)) {
+        stale_.fetch_add(1, std::memory_order_relaxed); // 찾은 직후 다른 스레드가 끝내거나 회수함
+        return RouteResult::STALE;
+    }
+
+    if (slot->deadlineNs.load(std::memory_order_relaxed) < nowNs()) {
+        release(*slot);
+        stale_.fetch_add(1, std::memory_order_relaxed);
+        return RouteResult::STALE;
+    }
+    const bool fieldsMatch = slot->responseType == response.msg_type &&
+        (!response.corr_id.empty() ||
+         (slot->itemCode == itemCodeOf(response) && (slot->peerId == "0" || slot->peerId == response.src_id)));
+    if (!fieldsMatch) { // 다른 종류의 응답에 ID를 붙였거나 해시 충돌
+        slot->state.store(ACTIVE, std::memory_order_release);
+        unmatched_.fetch_add(1, std::memory_order_relaxed);
+        return RouteResult::UNMATCHED;
+    }
+    if (std::find(slot->responders.begin(), slot->responders.end(), response.src_id) != slot->responders.end()) {
+        slot->state.store(ACTIVE, std::memory_order_release);
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        return RouteResult::DUPLICATE;
+    }
+
+    slot->responders.push_back(response.src_id);
+    ResponseHandler handler = slot->handler;
+    if (slot->expectedResponses > 0 && slot->responders.size() >= slot->expectedResponses) {
+        release(*slot); // 기다리던 응답을 모두 받음
+    } else {
+        slot->state.store(ACTIVE, std::memory_order_release);
+    }
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+
+    if (handler) {
+        handler(response); // 슬롯을 놓은 뒤 호출해 콜백이 오래 걸려도 다른 응답을 막지 않음
+    }
+    return RouteResult::DELIVERED;
+}
+
+void InFlightRequestTable::cancel(const std::string& corrId) {
+    std::uint64_t id = 0;
+    if (!parseId(corrId, id)) {
+        return;
+    }
+    Slot* slot = findById(id);
+    if (slot != nullptr && acquireForDelivery(*slot, id)) {
+        release(*slot);
+    }
+}
+
+InFlightRequestTable::Stats InFlightRequestTable::stats() const {
+    Stats s;
+    s.delivered = delivered_.load(std::memory_order_relaxed);
+    s.duplicates = duplicates_.load(std::memory_order_relaxed);
+    s.stale = stale_.load(std::memory_order_relaxed);
+    s.unmatched = unmatched_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool InFlightRequestTable::tryClaim(Slot& slot, std::int64_t now) {
+    std::uint8_t state = slot.state.load(std::memory_order_acquire);
+    if (state == FREE) {
+        return slot.state.compare_exchange_strong(state, CLAIMED, std::memory_order_acq_rel);
+    }
+    if (state == ACTIVE && slot.deadlineNs.load(std::memory_order_relaxed) < now) {
+        return slot.state.compare_exchange_strong(state, CLAIMED, std::memory_order_acq_rel); // 기한이 지난 슬롯 회수
+    }
+    return false;
+}
+
+InFlightRequestTable::Slot* InFlightRequestTable::findById(std::uint64_t id) {
+    for (Slot& slot : slots_) {
+        if (slot.id.load(std::memory_order_acquire) == id) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+InFlightRequestTable::Slot* InFlightRequestTable::findByFallback(const network::Message& response) {
+    const std::string& itemCode = itemCodeOf(response);
+    const std::uint64_t unicastKey = makeMatchKey(response.msg_type, itemCode, response.src_id);
+    const std::uint64_t broadcastKey = makeMatchKey(response.msg_type, itemCode, "0");
+    const std::int64_t now = nowNs();
+
+    Slot* best = nullptr;
+    std::uint32_t bestSequence = 0;
+    for (Slot& slot : slots_) {
+        if (slot.state.load(std::memory_order_acquire) == FREE) {
+            continue;
+        }
+        const std::uint64_t key = slot.matchKey.load(std::memory_order_relaxed);
+        if ((key != unicastKey && key != broadcastKey) || slot.deadlineNs.load(std::memory_order_relaxed) < now) {
+            continue;
+        }
+        const std::uint32_t sequence = static_cast<std::uint32_t>(slot.id.load(std::memory_order_relaxed));
+        if (best == nullptr || sequence > bestSequence) { // 가장 최근 요청에 연결
+            best = &slot;
+            bestSequence = sequence;
+        }
+    }
+    return best;
+}
+
+bool InFlightRequestTable::acquireForDelivery(Slot& slot, std::uint64_t expectedId) {
+    while (true) {
+        std::uint8_t state = slot.state.load(std::memory_order_acquire);
+        if (state == DELIVERING) {
+            std::this_thread::yield(); // 같은 요청의 다른 응답을 처리 중: 짧게 양보 후 재시도
+            continue;
+        }
+        if (state != ACTIVE) {
+            return false;
+        }
+        if (slot.state.compare_exchange_weak(state, DELIVERING, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+    if (slot.id.load(std::memory_order_relaxed) != expectedId) { // 그 사이 슬롯이 다른 요청으로 재사용됨
+        slot.state.store(ACTIVE, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void InFlightRequestTable::release(Slot& slot) {
+    slot.handler = nullptr;
+    slot.responders.clear();
+    slot.itemCode.clear();
+    slot.peerId.clear();
+    slot.matchKey.store(0, std::memory_order_relaxed);
+    slot.id.store(0, std::memory_order_relaxed);
+    slot.state.store(FREE, std::memory_order_release);
+}
+
+} // namespace service
@@ -5,6 +5,8 @@
 #include "domain/inventory.h"                
 #include "service/ErrorService.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include <string>
 
@@ -13,13 +15,15 @@ namespace service {
 InventoryService::InventoryService(
     persistence::InventoryRepository& inventoryRepo,
     persistence::DrinkRepository& drinkRepo,
-    service::ErrorService& errorService
+    service::ErrorService& errorService,
+    Clock::duration holdTtl
 ) : inventoryRepository_(inventoryRepo),
     drinkRepository_(drinkRepo),
-    errorService_(errorService) {}
+    errorService_(errorService),
+    holdTtl_(holdTtl) {}
 
 
-std::vector<domain::Drink> InventoryService::getAllDrinkTypes() {
+domain::DrinkSpan InventoryService::getAllDrinkTypes() {
     try {
         // PFR - R1.1: 전체 20종류의 음료 메뉴를 사용자에게 표시
         return drinkRepository_.findAll();
@@ -30,29 +34,35 @@ std::vector<domain::Drink> InventoryService::getAllDrinkTypes() {
             ErrorType::REPOSITORY_ACCESS_ERROR,
             "전체 음료 목록 조회 중 오류 발생: " + std::string(e.what())
         );
-        return {}; // 빈 벡터 반환
+        return {}; // 빈 뷰 반환
     }
 }
 
+const domain::Drink* InventoryService::findDrinkType(const std::string& drinkCode) const {
+    return drinkRepository_.tryFindByDrinkCode(drinkCode);
+}
+
 
 InventoryService::DrinkAvailabilityInfo InventoryService::checkDrinkAvailabilityAndPrice(const std::string& drinkCode) {
     DrinkAvailabilityInfo info; // isAvailable = false, price = 0, currentStock = 0 으로 자동 초기화
 
     try {
+        reapExpiredHolds(); // 만료된 선결제 홀드를 먼저 재고로 되돌림
+
         // 1. 음료 기본 정보(이름, 가격) 조회 (DrinkRepository 사용)
-        domain::Drink drink = drinkRepository_.findByDrinkCode(drinkCode);
-        if (drink.getDrinkCode().empty()) { // findByDrinkCode가 못 찾으면 기본 Drink 객체 반환
+        const domain::Drink* drink = drinkRepository_.tryFindByDrinkCode(drinkCode);
+        if (drink == nullptr) { // 메뉴에 없는 코드
             // UC1 E1 또는 UC3에서 음료 정보를 못 찾는 경우
             errorService_.processOccurredError(ErrorType::DRINK_NOT_FOUND, "음료 코드(" + drinkCode + ")에 해당하는 음료 정보 없음");
             return info; // isAvailable = false
         }
-        info.price = drink.getPrice();
+        info.price = drink->getPrice();
 
         // 2. 현재 자판기에서 해당 음료를 취급하는지 및 실제 재고량 확인 (InventoryRepository 사용)
         // PFR R1.3: 현재 자판기의 재고를 확인한다.
-        if (inventoryRepository_.isDrinkHandled(drinkCode)) {
-            domain::Inventory invItem = inventoryRepository_.getInventoryByDrinkCode(drinkCode);
-            info.currentStock = invItem.getQty(); // 실제 재고량 설정
+        // 취급 여부와 수량을 한 번의 원자적 읽기로 확인 (다른 스레드의 차감과 경합하지 않음)
+        if (auto qty = inventoryRepository_.quantityOf(drinkCode)) {
+            info.currentStock = *qty; // 실제 재고량 설정
 
             if (info.currentStock > 0) {
                 info.isAvailable = true; // 취급하고 재고도 있음 -> 구매 가능
@@ -82,7 +92,7 @@ void InventoryService::decreaseStock(const std::string& drinkCode) {
     }
 }
 
-void InventoryService::decreaseStockByAmount(const std::string& drinkCode, int amount) {
+bool InventoryService::decreaseStockByAmount(const std::string& drinkCode, int amount) {
     try {
         bool success = inventoryRepository_.decreaseStockByAmount(drinkCode, amount);
         if (!success) {
@@ -90,9 +100,93 @@ void InventoryService::decreaseStockByAmount(const std::string& drinkCode, int a
             errorService_.processOccurredError(ErrorType::INSUFFICIENT_STOCK_FOR_DECREASE, // 또는 DRINK_OUT_OF_STOCK
                                            "음료(" + drinkCode + ") " + std::to_string(amount) + "개 재고 차감 실패");
         }
+        return success;
     } catch (const std::exception& e) {
         errorService_.processOccurredError(ErrorType::REPOSITORY_ACCESS_ERROR,
                                            "음료(" + drinkCode + ") 재고 차감 중 오류: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool InventoryService::holdStock(const std::string& holdId, const std::string& drinkCode, int amount, Clock::time_point now) {
+    reapExpiredHolds(now);
+    const Clock::time_point expiresAt = now + holdTtl_;
+    if (!holds_.add(holdId, drinkCode, amount, expiresAt)) {
+        errorService_.processOccurredError(ErrorType::UNEXPECTED_SYSTEM_ERROR, "이미 재고를 잡아둔 인증 코드(" + holdId + ")의 중복 홀드 요청");
+        return false;
+    }
+    // 리포지토리에는 재시작 후에도 의미가 있는 벽시계 기준 만료 시각으로 기록
+    const auto wallExpiresAt = std::chrono::system_clock::now() +
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(expiresAt - Clock::now());
+    if (!inventoryRepository_.holdStock({holdId, drinkCode, amount, wallExpiresAt})) {
+        holds_.remove(holdId);
+        return false; // 재고 부족 또는 취급하지 않는 음료
+    }
+    return true;
+}
+
+bool InventoryService::commitHold(const std::string& holdId) {
+    if (!holds_.remove(holdId)) {
+        return false;
+    }
+    inventoryRepository_.endHold(holdId, false); // 잡아둔 수량은 이미 재고에서 빠져 있음
+    return true;
+}
+
+std::size_t InventoryService::restoreHolds(Clock::time_point now) {
+    const auto wallNow = std::chrono::system_clock::now();
+    std::size_t restored = 0;
+    for (const persistence::InventoryRepository::Hold& hold : inventoryRepository_.findAllHolds()) {
+        const Clock::time_point expiresAt = now + std::chrono::duration_cast<Clock::duration>(hold.expiresAt - wallNow);
+        if (holds_.add(hold.id, hold.drinkCode, hold.amount, expiresAt)) {
+            ++restored;
+        }
+    }
+    return restored;
+}
+
+std::optional<StockHoldTable::Hold> InventoryService::takeExpiredHold(const std::string& holdId) {
+    std::lock_guard<std::mutex> lock(expiredMtx_);
+    auto it = std::find_if(expiredHolds_.begin(), expiredHolds_.end(),
+                           [&holdId](const StockHoldTable::Hold& hold) { return hold.id == holdId; });
+    if (it == expiredHolds_.end()) {
+        return std::nullopt;
+    }
+    StockHoldTable::Hold hold = std::move(*it);
+    expiredHolds_.erase(it);
+    return hold;
+}
+
+bool InventoryService::releaseHold(const std::string& holdId) {
+    auto hold = holds_.remove(holdId);
+    if (!hold) {
+        return false;
+    }
+    returnToStock(*hold);
+    return true;
+}
+
+std::size_t InventoryService::reapExpiredHolds(Clock::time_point now) {
+    const std::vector<StockHoldTable::Hold> expired = holds_.reapExpired(now);
+    for (const auto& hold : expired) {
+        returnToStock(hold);
+    }
+    std::lock_guard<std::mutex> lock(expiredMtx_);
+    expiredHolds_.insert(expiredHolds_.end(), expired.begin(), expired.end());
+    while (!expiredHolds_.empty() && expiredHolds_.front().expiresAt + holdTtl_ <= now) {
+        expiredHolds_.pop_front(); // 만료 후 유지 시간만큼 지나도록 찾아가지 않은 홀드는 잊음
+    }
+    return expired.size();
+}
+
+int InventoryService::heldStock(const std::string& drinkCode) const {
+    return holds_.heldQuantity(drinkCode);
+}
+
+void InventoryService::returnToStock(const StockHoldTable::Hold& hold) {
+    if (!inventoryRepository_.endHold(hold.id, true)) {
+        errorService_.processOccurredError(ErrorType::REPOSITORY_ACCESS_ERROR,
+                                           "홀드(" + hold.id + ")의 음료(" + hold.drinkCode + ") 재고 반환 실패");
     }
 }
 
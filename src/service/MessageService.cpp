@@ -55,78 +55,151 @@ void MessageService::startReceivingMessages() {
 
 // UC8: 재고 조회 브로드캐스트 (PFR 표1)
 void MessageService::sendStockRequestBroadcast(const std::string& drinkCode) {
+    sendStockRequestBroadcast(drinkCode, DEFAULT_STOCK_RESPONSE_TIMEOUT, forwardToRegisteredHandler());
+}
+
+std::string MessageService::sendStockRequestBroadcast(const std::string& drinkCode, std::chrono::milliseconds timeout, ResponseHandler onResponse) {
+    // 모든 자판기가 응답하면 기한 전이라도 요청을 끝냅니다.
+    const std::string corrId = inFlight_.insert(network::Message::Type::RESP_STOCK, drinkCode, "0",
+                                                messageSender_.broadcastTargetCount(), timeout, std::move(onResponse));
+    if (corrId.empty()) {
+        errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "재고 조회 브로드캐스트 전송 실패: 응답 대기 중인 요청이 너무 많습니다.");
+        return corrId;
+    }
+
     network::Message msg;
-    msg.msg_type = network::Message::Type::REQ_STOCK;
     msg.src_id = myVmId_;
     msg.dst_id = "0"; // "0"은 브로드캐스트를 의미 (
-    msg.msg_content["item_code"] = drinkCode;
-    msg.msg_content["item_num"] = "1"; // 재고 조회는 항상 1개 음료에 대해 요청
+    msg.corr_id = corrId;
+    network::StockRequest content;
+    content.item_code = drinkCode;
+    content.item_num = 1; // 재고 조회는 항상 1개 음료에 대해 요청
+    msg.setContent(std::move(content));
 
     try {
-        messageSender_.send(msg);
+        messageSender_.send(msg, reportSendFailure("재고 조회 브로드캐스트 전송 실패"));
     } catch (const std::exception& e) { // MessageSender::send 내부에서 예외 발생 시
+        inFlight_.cancel(corrId);
         errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "재고 조회 브로드캐스트 전송 실패: " + std::string(e.what()));
+        return std::string();
     }
+    return corrId;
 }
 
 // UC16: 선결제 재고 확보 요청 (PFR 표3)
 void MessageService::sendPrepaymentReservationRequest(const std::string& targetVmId, const std::string& drinkCode, const std::string& authCode) {
+    sendPrepaymentReservationRequest(targetVmId, drinkCode, authCode, DEFAULT_PREPAY_RESPONSE_TIMEOUT, forwardToRegisteredHandler());
+}
+
+std::string MessageService::sendPrepaymentReservationRequest(const std::string& targetVmId, const std::string& drinkCode, const std::string& authCode,
+                                                             std::chrono::milliseconds timeout, ResponseHandler onResponse) {
+    const std::string corrId = inFlight_.insert(network::Message::Type::RESP_PREPAY, drinkCode, targetVmId, 1, timeout, std::move(onResponse));
+    if (corrId.empty()) {
+        errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "선결제 예약 요청 전송 실패 (" + targetVmId + "): 응답 대기 중인 요청이 너무 많습니다.");
+        return corrId;
+    }
+
     network::Message msg;
-    msg.msg_type = network::Message::Type::REQ_PREPAY;
     msg.src_id = myVmId_;
     msg.dst_id = targetVmId;
-    msg.msg_content["item_code"] = drinkCode;
-    msg.msg_content["item_num"] = "1"; // 우리 시스템은 1주문 1음료 원칙이므로 항상 1개 요청
-    msg.msg_content["cert_code"] = authCode;
+    msg.corr_id = corrId;
+    network::PrepayRequest content;
+    content.item_code = drinkCode;
+    content.item_num = 1; // 우리 시스템은 1주문 1음료 원칙이므로 항상 1개 요청
+    content.cert_code = authCode;
+    msg.setContent(std::move(content));
 
     try {
-        messageSender_.send(msg);
+        messageSender_.send(msg, reportSendFailure("선결제 예약 요청 전송 실패 (" + targetVmId + ")"));
     } catch (const std::exception& e) {
+        inFlight_.cancel(corrId);
         errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "선결제 예약 요청 전송 실패 (" + targetVmId + "): " + std::string(e.what()));
+        return std::string();
     }
+    return corrId;
+}
+
+void MessageService::cancelRequest(const std::string& corrId) {
+    inFlight_.cancel(corrId);
 }
 
 // UC17: 재고 조회 요청에 대한 응답 (PFR 표2)
-void MessageService::sendStockResponse(const std::string& destinationVmId, const std::string& drinkCode, int currentStock) {
+void MessageService::sendStockResponse(const std::string& destinationVmId, const std::string& drinkCode, int currentStock,
+                                       const std::string& corrId) {
     network::Message msg;
-    msg.msg_type = network::Message::Type::RESP_STOCK;
     msg.src_id = myVmId_;
     msg.dst_id = destinationVmId;
-    msg.msg_content["item_code"] = drinkCode;
-    msg.msg_content["item_num"] = std::to_string(currentStock); // 실제 재고량
-    msg.msg_content["coor_x"] = std::to_string(myCoordX_);
-    msg.msg_content["coor_y"] = std::to_string(myCoordY_);
+    msg.corr_id = corrId; // 요청의 corr_id를 그대로 돌려줌
+    network::StockResponse content;
+    content.item_code = drinkCode;
+    content.item_num = currentStock; // 실제 재고량
+    content.coor_x = myCoordX_;
+    content.coor_y = myCoordY_;
+    msg.setContent(std::move(content));
 
     try {
-        messageSender_.send(msg);
+        messageSender_.send(msg, reportSendFailure("재고 응답 전송 실패 (" + destinationVmId + ")"));
     } catch (const std::exception& e) {
         errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "재고 응답 전송 실패 (" + destinationVmId + "): " + std::string(e.what()));
     }
 }
 
 // UC15: 선결제 재고 확보 요청에 대한 응답 (PFR 표4)
-void MessageService::sendPrepaymentReservationResponse(const std::string& destinationVmId, const std::string& drinkCode, int reservedItemNum, bool available) {
+void MessageService::sendPrepaymentReservationResponse(const std::string& destinationVmId, const std::string& drinkCode, int reservedItemNum, bool available,
+                                                       const std::string& corrId) {
     network::Message msg;
-    msg.msg_type = network::Message::Type::RESP_PREPAY;
     msg.src_id = myVmId_;
     msg.dst_id = destinationVmId;
-    msg.msg_content["item_code"] = drinkCode;
-    msg.msg_content["item_num"] = std::to_string(reservedItemNum); // 확보된 (또는 요청받은) 수량
-    msg.msg_content["availability"] = available ? "T" : "F"; // 성공 여부
+    msg.corr_id = corrId;
+    network::PrepayResponse content;
+    content.item_code = drinkCode;
+    content.item_num = reservedItemNum; // 확보된 (또는 요청받은) 수량
+    content.availability = available; // 성공 여부
+    msg.setContent(std::move(content));
 
     try {
-        messageSender_.send(msg);
+        messageSender_.send(msg, reportSendFailure("선결제 예약 응답 전송 실패 (" + destinationVmId + ")"));
     } catch (const std::exception& e) {
         errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED, "선결제 예약 응답 전송 실패 (" + destinationVmId + "): " + std::string(e.what()));
     }
 }
 
+network::MessageSender::PeerHandler MessageService::reportSendFailure(const std::string& context) {
+    return [this, context](const std::string& endpoint, const boost::system::error_code& ec) {
+        if (ec) {
+            errorService_.processOccurredError(ErrorType::MESSAGE_SEND_FAILED,
+                context + " [" + endpoint + "]: " + ec.message());
+        }
+    };
+}
+
 void MessageService::registerMessageHandler(network::Message::Type type, GenericMessageHandler handler) {
     messageHandlers_[type] = std::move(handler);
 }
 
 
+MessageService::ResponseHandler MessageService::forwardToRegisteredHandler() {
+    return [this](const network::Message& response) {
+        auto it = messageHandlers_.find(response.msg_type);
+        if (it != messageHandlers_.end()) {
+            it->second(response);
+        }
+    };
+}
+
 void MessageService::onMessageReceived(const network::Message& msg) {
+    if (msg.msg_type == network::Message::Type::RESP_STOCK || msg.msg_type == network::Message::Type::RESP_PREPAY) {
+        // 늦게 도착한 응답도 다른 자판기의 재고로는 유효하므로, 요청과 연결하기 전에 캐시부터 갱신합니다.
+        if (const auto* stock = msg.contentAs<network::StockResponse>()) {
+            peerStock_.update(msg.src_id, stock->item_code, stock->item_num, stock->coor_x, stock->coor_y);
+        } else if (const auto* prepay = msg.contentAs<network::PrepayResponse>()) {
+            peerStock_.applyReservation(msg.src_id, prepay->item_code, prepay->item_num, prepay->availability);
+        }
+        // 응답은 기다리는 요청의 콜백으로만 전달합니다. 늦게 도착했거나 중복된 응답은 여기서 버려
+        // 이전 거래의 응답이 현재 거래의 상태를 바꾸지 않도록 합니다.
+        inFlight_.route(msg);
+        return;
+    }
     auto it = messageHandlers_.find(msg.msg_type);
     if (it != messageHandlers_.end()) {
         it->second(msg); // 등록된 핸들러(UserProcessController의 onXXXReceived) 호출
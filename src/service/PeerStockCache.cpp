@@ -0,0 +1,74 @@
+#include "service/PeerStockCache.hpp"
+
+#include <algorithm>
+
+namespace service {
+
+void PeerStockCache::update(const std::string& vmId, const std::string& drinkCode, int stock, int coordX, int coordY,
+                            Clock::time_point at) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry* entry = find(vmId, drinkCode);
+    if (entry == nullptr) {
+        std::vector<Entry>& entries = entriesByDrink_[drinkCode];
+        entries.push_back(Entry{vmId, stock, coordX, coordY, at});
+        return;
+    }
+    if (at < entry->updatedAt) {
+        return; // 이미 더 최근 값을 가지고 있음
+    }
+    entry->stock = stock;
+    entry->coordX = coordX;
+    entry->coordY = coordY;
+    entry->updatedAt = at;
+}
+
+void PeerStockCache::applyReservation(const std::string& vmId, const std::string& drinkCode, int reservedItemNum, bool available) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry* entry = find(vmId, drinkCode);
+    if (entry == nullptr) {
+        return;
+    }
+    if (available) {
+        entry->stock = std::max(0, entry->stock - reservedItemNum);
+        return;
+    }
+    std::vector<Entry>& entries = entriesByDrink_[drinkCode];
+    entries.erase(entries.begin() + (entry - entries.data()));
+}
+
+std::vector<OtherVendingMachineInfo> PeerStockCache::freshEntries(const std::string& drinkCode, std::chrono::milliseconds maxAge,
+                                                                  Clock::time_point now) const {
+    std::vector<OtherVendingMachineInfo> result;
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = entriesByDrink_.find(drinkCode);
+    if (it == entriesByDrink_.end()) {
+        return result;
+    }
+    result.reserve(it->second.size());
+    for (const Entry& entry : it->second) {
+        if (now - entry.updatedAt <= maxAge) {
+            result.push_back({entry.vmId, entry.coordX, entry.coordY, entry.stock > 0});
+        }
+    }
+    return result;
+}
+
+void PeerStockCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    entriesByDrink_.clear();
+}
+
+PeerStockCache::Entry* PeerStockCache::find(const std::string& vmId, const std::string& drinkCode) {
+    auto it = entriesByDrink_.find(drinkCode);
+    if (it == entriesByDrink_.end()) {
+        return nullptr;
+    }
+    for (Entry& entry : it->second) {
+        if (entry.vmId == vmId) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace service
@@ -0,0 +1,100 @@
+#include "service/StockHoldTable.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace service {
+
+StockHoldTable::StockHoldTable(Clock::duration tick, std::size_t wheelSlots, Clock::time_point origin)
+    : tick_(tick), origin_(origin), wheel_(wheelSlots), lastReapedTick_(0) {
+    if (tick_ <= Clock::duration::zero() || wheelSlots == 0) {
+        throw std::invalid_argument("타이머 휠의 tick과 칸 수는 0보다 커야 합니다.");
+    }
+}
+
+std::int64_t StockHoldTable::tickFloor(Clock::time_point at) const {
+    const auto elapsed = at - origin_;
+    return elapsed <= Clock::duration::zero() ? 0 : static_cast<std::int64_t>(elapsed / tick_);
+}
+
+std::int64_t StockHoldTable::tickCeil(Clock::time_point at) const {
+    const auto elapsed = at - origin_;
+    if (elapsed <= Clock::duration::zero()) {
+        return 0;
+    }
+    return static_cast<std::int64_t>((elapsed + tick_ - Clock::duration(1)) / tick_);
+}
+
+bool StockHoldTable::add(const std::string& id, const std::string& drinkCode, int amount, Clock::time_point expiresAt) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    const std::uint64_t sequence = nextSequence_;
+    if (!holds_.emplace(id, Slot{Hold{id, drinkCode, amount, expiresAt}, sequence}).second) {
+        return false;
+    }
+    ++nextSequence_;
+    heldByDrink_[drinkCode] += amount;
+
+    // 만료 tick 칸에 넣되, 이미 지나간 tick이면 다음 reapExpired에서 바로 보이도록 다음 칸에 넣음
+    const std::int64_t expiryTick = std::max(tickCeil(expiresAt), lastReapedTick_ + 1);
+    wheel_[static_cast<std::size_t>(expiryTick) % wheel_.size()].push_back(WheelEntry{id, sequence});
+    return true;
+}
+
+std::optional<StockHoldTable::Hold> StockHoldTable::remove(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = holds_.find(id);
+    if (it == holds_.end()) {
+        return std::nullopt;
+    }
+    Hold hold = std::move(it->second.hold);
+    holds_.erase(it);
+    heldByDrink_[hold.drinkCode] -= hold.amount; // 휠 항목은 그 칸을 지날 때 버림
+    return hold;
+}
+
+std::vector<StockHoldTable::Hold> StockHoldTable::reapExpired(Clock::time_point now) {
+    std::vector<Hold> expired;
+    std::lock_guard<std::mutex> lock(mtx_);
+    const std::int64_t nowTick = tickFloor(now);
+    if (nowTick <= lastReapedTick_) {
+        return expired;
+    }
+    // 한 바퀴 이상 지났으면 모든 칸을 한 번씩만 훑음
+    const std::int64_t firstTick = std::max(lastReapedTick_ + 1, nowTick - static_cast<std::int64_t>(wheel_.size()) + 1);
+    for (std::int64_t t = firstTick; t <= nowTick; ++t) {
+        std::vector<WheelEntry>& bucket = wheel_[static_cast<std::size_t>(t) % wheel_.size()];
+        auto keep = bucket.begin();
+        for (auto entry = bucket.begin(); entry != bucket.end(); ++entry) {
+            auto it = holds_.find(entry->id);
+            if (it == holds_.end() || it->second.sequence != entry->sequence) {
+                continue; // 이미 확정·취소된 홀드
+            }
+            if (it->second.hold.expiresAt > now) {
+                if (keep != entry) { // 다음 바퀴 이후에 만료
+                    *keep = std::move(*entry);
+                }
+                ++keep;
+                continue;
+            }
+            heldByDrink_[it->second.hold.drinkCode] -= it->second.hold.amount;
+            expired.push_back(std::move(it->second.hold));
+            holds_.erase(it);
+        }
+        bucket.erase(keep, bucket.end());
+    }
+    lastReapedTick_ = nowTick;
+    return expired;
+}
+
+int StockHoldTable::heldQuantity(const std::string& drinkCode) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = heldByDrink_.find(drinkCode);
+    return it == heldByDrink_.end() ? 0 : it->second;
+}
+
+std::size_t StockHoldTable::size() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return holds_.size();
+}
+
+} // namespace service
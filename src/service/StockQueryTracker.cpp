@@ -0,0 +1,78 @@
+#include "service/StockQueryTracker.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace service {
+
+StockQueryTracker::StockQueryTracker(StockQueryOptions options, int myX, int myY, std::size_t totalPeers)
+    : options_(std::move(options)), myX_(myX), myY_(myY), totalPeers_(totalPeers) {
+    responders_.reserve(totalPeers_);
+}
+
+void StockQueryTracker::reset() {
+    responders_.clear();
+    hasCandidate_ = false;
+    bestSquaredDistance_ = 0;
+}
+
+bool StockQueryTracker::recordResponse(const OtherVendingMachineInfo& response) {
+    if (hasResponded(response.id)) {
+        return false;
+    }
+    responders_.push_back(response.id);
+    if (response.hasStock) {
+        const std::int64_t d2 = squaredDistanceTo(response.coordX, response.coordY);
+        if (!hasCandidate_ || d2 < bestSquaredDistance_) {
+            bestSquaredDistance_ = d2;
+        }
+        hasCandidate_ = true;
+    }
+    return true;
+}
+
+bool StockQueryTracker::isComplete() const {
+    if (responders_.size() >= totalPeers_) {
+        return true; // 더 기다릴 응답이 없음
+    }
+    switch (options_.policy) {
+        case StockQueryPolicy::FIRST:
+            return hasCandidate_;
+        case StockQueryPolicy::QUORUM:
+            return hasCandidate_ && responders_.size() >= options_.quorum;
+        case StockQueryPolicy::NEAREST_POSSIBLE:
+            return hasCandidate_ && nearestCannotImprove();
+        case StockQueryPolicy::ALL:
+        default:
+            return false;
+    }
+}
+
+// 거리 비교만 필요하므로 제곱근 없이 정수 거리 제곱으로 비교합니다.
+std::int64_t StockQueryTracker::squaredDistanceTo(int x, int y) const {
+    const std::int64_t dx = static_cast<std::int64_t>(x) - myX_;
+    const std::int64_t dy = static_cast<std::int64_t>(y) - myY_;
+    return dx * dx + dy * dy;
+}
+
+bool StockQueryTracker::hasResponded(const std::string& id) const {
+    return std::find(responders_.begin(), responders_.end(), id) != responders_.end();
+}
+
+bool StockQueryTracker::nearestCannotImprove() const {
+    std::size_t pendingKnown = 0;
+    for (const PeerLocation& peer : options_.knownPeers) {
+        if (hasResponded(peer.id)) {
+            continue;
+        }
+        ++pendingKnown;
+        // 거리가 같으면 ID 순서(PFR R3.2)로 후보가 바뀔 수 있으므로 같은 거리도 기다림
+        if (squaredDistanceTo(peer.coordX, peer.coordY) <= bestSquaredDistance_) {
+            return false;
+        }
+    }
+    // 좌표를 모르는 자판기가 아직 응답하지 않았다면 더 가까울 수 있음
+    return responders_.size() + pendingKnown >= totalPeers_;
+}
+
+} // namespace service
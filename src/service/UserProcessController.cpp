@@ -23,7 +23,10 @@
 #include <thread>  
 #include <mutex>
 #include <condition_variable>
+#include <stdexcept>
 #include <iostream> 
+#include <algorithm>
+#include <unordered_set>
 namespace service {
 
 UserProcessController::UserProcessController(
@@ -38,7 +41,8 @@ UserProcessController::UserProcessController(
     const std::string& myVmId,
     int myVmX,
     int myVmY,
-    int totalOtherVmCount
+    int totalOtherVmCount,
+    StockQueryOptions stockQueryOptions
 ) : userInterface_(ui),
     inventoryService_(inventoryService),
     orderService_(orderService),
@@ -47,13 +51,15 @@ UserProcessController::UserProcessController(
     distanceService_(distanceService),
     errorService_(errorService),
     ioContext_(ioContext),
+    strand_(boost::asio::make_strand(ioContext)),
     myVendingMachineId_(myVmId),
     myVendingMachineX_(myVmX),
     myVendingMachineY_(myVmY),
     currentState_(ControllerState::INITIALIZING),
     isCurrentOrderPrepayment_(false),
     total_other_vms_(totalOtherVmCount), // 주입받은 값으로 초기화
-    response_timer_(ioContext) {
+    stockQuery_(std::move(stockQueryOptions), myVmX, myVmY, static_cast<std::size_t>(std::max(totalOtherVmCount, 0))),
+    response_timer_(strand_) {
 }
 
 void UserProcessController::run() {
@@ -105,18 +111,24 @@ void UserProcessController::resetCurrentTransactionState() {
     isCurrentOrderPrepayment_ = false;
     pendingDrinkSelection_.reset();
     availableOtherVmsForDrink_.clear();
+    stockQuery_.reset();
     selectedTargetVmForPrepayment_.reset();
-    response_timer_.cancel(); // 진행 중이던 Asio 타이머 취소
+    prepaymentAlternatives_.clear();
+    // 응답을 기다리던 요청을 끝내고 세대를 올려, 이미 strand_에 올라간 이전 거래의 응답도 무시되게 함
+    if (!pendingRequestCorrId_.empty()) {
+        messageService_.cancelRequest(pendingRequestCorrId_);
+        pendingRequestCorrId_.clear();
+    }
+    ++transactionGeneration_;
+    // 진행 중이던 Asio 타이머 취소 (타이머는 strand 위에서만 조작)
+    boost::asio::post(strand_, [this]() { response_timer_.cancel(); });
     cv_data_ready_ = false;   // 조건 변수 플래그 리셋
 }
 
 domain::Drink UserProcessController::getDrinkDetails(const std::string& drinkCode) {
     try {
-        auto allDrinks = inventoryService_.getAllDrinkTypes();
-        for (const auto& drink : allDrinks) {
-            if (drink.getDrinkCode() == drinkCode) {
-                return drink;
-            }
+        if (const domain::Drink* drink = inventoryService_.findDrinkType(drinkCode)) {
+            return *drink;
         }
         { 
             std::lock_guard<std::mutex> lock(mtx_);
@@ -137,29 +149,40 @@ domain::Drink UserProcessController::getDrinkDetails(const std::string& drinkCod
 }
 
 void UserProcessController::initializeSystemAndRegisterMessageHandlers() {
-    // MessageService의 핸들러 등록. 콜백은 io_context 스레드에서 실행됨.
-    // boost::asio::post를 사용하여 핸들러 실행을 io_context 큐에 올림.
+    // MessageService의 핸들러 등록. 콜백은 io_context 스레드(여러 개일 수 있음)에서 실행됨.
+    // boost::asio::post로 strand_에 올려 핸들러와 타이머 콜백이 서로 겹쳐 실행되지 않게 함.
+    // 응답(RESP_STOCK, RESP_PREPAY)은 요청을 보낼 때 넘긴 콜백으로만 받으므로 여기서는 요청 타입만 등록함.
     messageService_.registerMessageHandler(network::Message::Type::REQ_STOCK,
-        [this](const network::Message& msg){ boost::asio::post(ioContext_, [this, msg](){ this->onReqStockReceived(msg); }); });
-    messageService_.registerMessageHandler(network::Message::Type::RESP_STOCK,
-        [this](const network::Message& msg){ boost::asio::post(ioContext_, [this, msg](){ this->onRespStockReceived(msg); }); });
+        [this](const network::Message& msg){ boost::asio::post(strand_, [this, msg](){ this->onReqStockReceived(msg); }); });
     messageService_.registerMessageHandler(network::Message::Type::REQ_PREPAY,
-        [this](const network::Message& msg){ boost::asio::post(ioContext_, [this, msg](){ this->onReqPrepayReceived(msg); }); });
-    messageService_.registerMessageHandler(network::Message::Type::RESP_PREPAY,
-        [this](const network::Message& msg){ boost::asio::post(ioContext_, [this, msg](){ this->onRespPrepayReceived(msg); }); });
+        [this](const network::Message& msg){ boost::asio::post(strand_, [this, msg](){ this->onReqPrepayReceived(msg); }); });
 
     messageService_.startReceivingMessages(); // 네트워크 메시지 수신 시작
 }
 
+std::function<void(const network::Message&)> UserProcessController::responseCallback(ResponseMethod method) {
+    std::uint64_t generation;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        generation = transactionGeneration_;
+    }
+    return [this, method, generation](const network::Message& msg) {
+        boost::asio::post(strand_, [this, method, generation, msg]() { (this->*method)(msg, generation); });
+    };
+}
+
 // Asio 타이머 시작 헬퍼 함수
 void UserProcessController::startResponseTimer(std::chrono::seconds duration, ControllerState stateToWatchOnTimeout) {
-    response_timer_.expires_after(duration); // 타이머 만료 시간 설정
-    // 타이머 만료 시 호출될 콜백 등록
-    response_timer_.async_wait(
-        [this, stateToWatchOnTimeout](const boost::system::error_code& ec) {
-            this->handleTimeout(ec, stateToWatchOnTimeout);
-        }
-    );
+    // 메인 스레드에서 호출되므로, 타이머 조작은 메시지 핸들러와 같은 strand에서 수행
+    boost::asio::post(strand_, [this, duration, stateToWatchOnTimeout]() {
+        response_timer_.expires_after(duration); // 타이머 만료 시간 설정
+        // 타이머 만료 시 호출될 콜백 등록 (타이머가 strand_에 묶여 있어 콜백도 strand_에서 실행)
+        response_timer_.async_wait(
+            [this, stateToWatchOnTimeout](const boost::system::error_code& ec) {
+                this->handleTimeout(ec, stateToWatchOnTimeout);
+            }
+        );
+    });
 }
 
 // Asio 타이머 만료 시 호출될 콜백
@@ -179,6 +202,7 @@ void UserProcessController::handleTimeout(const boost::system::error_code& ec, C
                 currentState_ = ControllerState::HANDLING_ERROR;
             }
         } else if (currentState_ == ControllerState::ISSUING_AUTH_CODE_AND_REQUESTING_RESERVATION) {
+            // 응답이 늦을 뿐 대상이 이미 같은 인증 코드로 재고를 잡았을 수 있으므로 다음 후보로 넘어가지 않음
             std::string targetVmId_str = selectedTargetVmForPrepayment_ ? selectedTargetVmForPrepayment_->getId() : "대상 자판기";
             last_error_info_ = errorService_.processOccurredError(ErrorType::RESPONSE_TIMEOUT_FROM_OTHER_VM, targetVmId_str + "로부터 선결제 응답 없음");
             currentState_ = ControllerState::HANDLING_ERROR;
@@ -235,9 +259,9 @@ void UserProcessController::processCurrentState() {
                 // current_timeout_duration_은 state_issuingAuthCodeAndRequestingReservation에서 10초로 설정됨
                 std::chrono::seconds waitDuration = current_timeout_duration_ + std::chrono::seconds(1);
                 if (cv_.wait_for(lock, waitDuration, [this]{ return cv_data_ready_; })) {
-                } else { // cv_.wait_for 자체 타임아웃
-                    std::lock_guard<std::mutex> state_check_lock(mtx_);
+                } else { // cv_.wait_for 자체 타임아웃 (lock이 이미 mtx_를 잡고 있음)
                     if (currentState_ == ControllerState::ISSUING_AUTH_CODE_AND_REQUESTING_RESERVATION) {
+                        // 시간 초과는 예약 실패가 아니므로 다음 후보로 넘어가지 않음 (handleTimeout 참고)
                         std::string targetVmId_str = selectedTargetVmForPrepayment_ ? selectedTargetVmForPrepayment_->getId() : "대상 자판기";
                         last_error_info_ = errorService_.processOccurredError(ErrorType::RESPONSE_TIMEOUT_FROM_OTHER_VM, targetVmId_str + "로부터 선결제 예약 응답 시간 초과 (컨트롤러 cv_.wait_for 타임아웃)");
                         currentState_ = ControllerState::HANDLING_ERROR;
@@ -285,7 +309,7 @@ void UserProcessController::processCurrentState() {
 void UserProcessController::state_displayingMainMenu() {
     resetCurrentTransactionState(); // 내부에서 뮤텍스 사용
     userInterface_.displayMessage("\n=========== Vending Machine Menu ===========");
-    std::vector<domain::Drink> allDrinks = inventoryService_.getAllDrinkTypes(); // PFR R1.1
+    domain::DrinkSpan allDrinks = inventoryService_.getAllDrinkTypes(); // PFR R1.1
     userInterface_.displayDrinkList(allDrinks);
 
     std::vector<std::string> menuOptions = {
@@ -484,21 +508,35 @@ void UserProcessController::state_broadcastingStockRequest() {
         {
             std::lock_guard<std::mutex> lock(mtx_); // 공유 데이터(availableOtherVmsForDrink_ 등) 보호
             availableOtherVmsForDrink_.clear(); // 이전 다른 자판기 목록 초기화
+            stockQuery_.reset();                // 이전 조회의 응답 기록 초기화
             cv_data_ready_ = false;             // 응답 대기를 위한 플래그 리셋
             current_timeout_duration_ = std::chrono::seconds(3); // UC9 E2: 3초 이내 응답 없을 시 타임아웃 
+
+            if (answerStockQueryFromCache(drinkCodeToBroadcast)) {
+                // 캐시만으로 결과가 정해짐: 응답을 기다리지 않고 UC10으로 진행하고, 캐시는 백그라운드에서 갱신
+                // (응답은 MessageService가 캐시에 기록하므로 콜백은 필요 없음)
+                currentState_ = ControllerState::DISPLAYING_OTHER_VM_OPTIONS;
+                messageService_.sendStockRequestBroadcast(drinkCodeToBroadcast, current_timeout_duration_, nullptr);
+                return;
+            }
+            // 전송 직후 도착하는 응답도 받도록 전송 전에 응답 대기 상태로 전환
+            currentState_ = ControllerState::AWAITING_STOCK_RESPONSES;
         }
 
         // 실제 브로드캐스트 요청
         // MessageService는 생성 시 자신의 ID(myVmId_)를 알고 있으므로, broadcastStockRequest에는 drinkCode만 전달합니다.
         // MessageService의 sendStockRequestBroadcast 내부에서 dst_id = "0" (브로드캐스트)으로 설정됩니다. ]
-        messageService_.sendStockRequestBroadcast(drinkCodeToBroadcast); // 
+        // 응답은 이 요청의 콜백으로만 들어오며, 거래가 바뀐 뒤 도착한 응답은 세대 비교로 걸러짐
+        const std::string corrId = messageService_.sendStockRequestBroadcast(
+            drinkCodeToBroadcast, current_timeout_duration_, responseCallback(&UserProcessController::onRespStockReceived));
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            pendingRequestCorrId_ = corrId;
+        }
 
         // 응답 대기 타이머 시작
         startResponseTimer(current_timeout_duration_, ControllerState::AWAITING_STOCK_RESPONSES);
 
-        // 응답 대기 상태로 전환
-        changeState(ControllerState::AWAITING_STOCK_RESPONSES);
-
     } catch (const std::exception& e) {
         // messageService_에서 발생한 예외 처리 (예: 네트워크 오류 - UC8 E1
         std::lock_guard<std::mutex> lock(mtx_); // last_error_info_ 및 currentState_ 보호
@@ -510,6 +548,51 @@ void UserProcessController::state_broadcastingStockRequest() {
     }
 }
 
+bool UserProcessController::answerStockQueryFromCache(const std::string& drinkCode) {
+    const std::chrono::milliseconds maxAge = stockQuery_.options().cacheMaxAge;
+    if (maxAge <= std::chrono::milliseconds::zero()) {
+        return false;
+    }
+    for (const service::OtherVendingMachineInfo& cached : messageService_.peerStockCache().freshEntries(drinkCode, maxAge)) {
+        if (cached.coordX >= 0 && cached.coordX < DistanceService::COORD_LIMIT &&
+            cached.coordY >= 0 && cached.coordY < DistanceService::COORD_LIMIT) {
+            distanceService_.upsertMachine(cached.id, cached.coordX, cached.coordY);
+            distanceService_.setStock(cached.id, drinkCode, cached.hasStock);
+        }
+        stockQuery_.recordResponse(cached);
+        if (cached.hasStock) {
+            availableOtherVmsForDrink_.push_back(cached);
+        }
+    }
+    if (stockQuery_.isComplete()) {
+        return true;
+    }
+    // 캐시로는 부족하면 캐시 값을 섞지 않고 새 응답만으로 판단
+    stockQuery_.reset();
+    availableOtherVmsForDrink_.clear();
+    return false;
+}
+
+bool UserProcessController::retryPrepaymentWithNextCandidate(const std::string& reason) {
+    if (selectedTargetVmForPrepayment_ && pendingDrinkSelection_) {
+        // 실패한 자판기는 이 음료 재고가 없는 것으로 색인에 기록
+        distanceService_.setStock(selectedTargetVmForPrepayment_->getId(), pendingDrinkSelection_->getDrinkCode(), false);
+    }
+    if (prepaymentAlternatives_.empty()) {
+        return false;
+    }
+    // 이전 대상의 요청을 끝내 늦게 도착한 응답이 새 대상의 응답으로 처리되지 않게 함
+    if (!pendingRequestCorrId_.empty()) {
+        messageService_.cancelRequest(pendingRequestCorrId_);
+        pendingRequestCorrId_.clear();
+    }
+    selectedTargetVmForPrepayment_ = prepaymentAlternatives_.front();
+    prepaymentAlternatives_.erase(prepaymentAlternatives_.begin());
+    userInterface_.displayMessage(reason + ": 다음으로 가까운 " + selectedTargetVmForPrepayment_->getId() + "에 다시 요청합니다.");
+    currentState_ = ControllerState::ISSUING_AUTH_CODE_AND_REQUESTING_RESERVATION; // 메인 루프가 새 대상에 요청을 보냄
+    return true;
+}
+
 // UC10, UC11: 다른 자판기 옵션 표시 및 선결제 결정
 void UserProcessController::state_displayingOtherVmOptions() {
     std::optional<domain::Drink> currentDrinkSelection;
@@ -533,13 +616,18 @@ void UserProcessController::state_displayingOtherVmOptions() {
     }
 
     try { // UC10 (S)-1
-        std::optional<domain::VendingMachine> nearestVm = distanceService_.findNearestAvailableVendingMachine(
-            myVendingMachineX_, myVendingMachineY_, currentAvailableVms
-        );
+        // 1순위와 함께 다음 후보들도 받아 두어, 예약이 실패하면 재고 조회 없이 다음 자판기로 재시도 (UC16)
+        std::vector<domain::VendingMachine> rankedVms =
+            rankPrepaymentCandidates(currentDrinkSelection->getDrinkCode(), currentAvailableVms);
+        std::optional<domain::VendingMachine> nearestVm;
+        if (!rankedVms.empty()) {
+            nearestVm = rankedVms.front();
+        }
         if (nearestVm) {
             { // selectedTargetVmForPrepayment_ 업데이트 보호
                 std::lock_guard<std::mutex> lock(mtx_);
                 selectedTargetVmForPrepayment_ = nearestVm;
+                prepaymentAlternatives_.assign(rankedVms.begin() + 1, rankedVms.end());
             }
             userInterface_.displayNearestVendingMachine(*nearestVm, currentDrinkSelection->getName());
 
@@ -564,6 +652,37 @@ void UserProcessController::state_displayingOtherVmOptions() {
     }
 }
 
+std::vector<domain::VendingMachine> UserProcessController::rankPrepaymentCandidates(
+    const std::string& drinkCode, const std::vector<service::OtherVendingMachineInfo>& responders) const {
+    // 응답은 모두 공간 색인에 반영되어 있으므로 색인에서 가까운 자판기를 바로 찾음.
+    // 색인에는 이번 조회에 응답하지 않은 자판기의 이전 재고가 남아 있을 수 있어 응답한 자판기만 남김
+    std::unordered_set<std::string> responderIds;
+    for (const auto& vm : responders) {
+        responderIds.insert(vm.id);
+    }
+    const std::size_t wanted = std::min(PREPAY_CANDIDATE_LIMIT, responderIds.size());
+    std::vector<domain::VendingMachine> ranked;
+    for (std::size_t k = wanted; k > 0; k *= 2) { // 걸러져 모자라면 범위를 넓혀 다시 찾음
+        std::vector<domain::VendingMachine> nearest =
+            distanceService_.findNearestWithStock(myVendingMachineX_, myVendingMachineY_, drinkCode, k);
+        ranked.clear();
+        for (domain::VendingMachine& vm : nearest) {
+            if (ranked.size() < wanted && responderIds.count(vm.getId()) != 0) {
+                ranked.push_back(std::move(vm));
+            }
+        }
+        if (ranked.size() == wanted || nearest.size() < k) {
+            break; // 충분히 찾았거나 색인에 재고 있는 자판기가 더 없음
+        }
+    }
+    if (ranked.size() < wanted) {
+        // 좌표가 범위를 벗어나 색인하지 못한 응답이 있으면 응답 목록으로 직접 순위를 매김
+        return distanceService_.rankNearestAvailableVendingMachines(
+            myVendingMachineX_, myVendingMachineY_, responders, PREPAY_CANDIDATE_LIMIT);
+    }
+    return ranked;
+}
+
 // UC16: 재고 확보 요청 전송
 void UserProcessController::state_issuingAuthCodeAndRequestingReservation() {
     std::string targetVmId, drinkCode, certCode, drinkName;
@@ -585,7 +704,12 @@ void UserProcessController::state_issuingAuthCodeAndRequestingReservation() {
     }
 
     userInterface_.displayMessage(targetVmId + "에 " + drinkName + " 재고 확보 요청 (인증코드: " + certCode + ")");
-    messageService_.sendPrepaymentReservationRequest(targetVmId, drinkCode, certCode); // UC16 (S)-1
+    const std::string corrId = messageService_.sendPrepaymentReservationRequest( // UC16 (S)-1
+        targetVmId, drinkCode, certCode, current_timeout_duration_, responseCallback(&UserProcessController::onRespPrepayReceived));
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        pendingRequestCorrId_ = corrId;
+    }
     startResponseTimer(current_timeout_duration_, ControllerState::ISSUING_AUTH_CODE_AND_REQUESTING_RESERVATION);
 }
 
@@ -644,6 +768,17 @@ void UserProcessController::state_awaitingAuthCodeInputPrompt() {
     }
     currentActiveOrder_ = *heldOrderPtr;
 
+    // 잡아둔 재고를 확정. 홀드가 만료되어 재고로 돌아간 뒤라면 잡아뒀던 수량만큼 남은 재고에서 다시 차감
+    if (!inventoryService_.commitHold(authCode)) {
+        const std::optional<StockHoldTable::Hold> expired = inventoryService_.takeExpiredHold(authCode);
+        const int heldAmount = expired ? expired->amount : currentActiveOrder_->getQty();
+        if (!inventoryService_.decreaseStockByAmount(currentActiveOrder_->getDrinkCode(), heldAmount)) {
+            last_error_info_ = errorService_.processOccurredError(ErrorType::DRINK_OUT_OF_STOCK, "인증 코드 " + authCode + "의 재고 예약이 만료되었고 남은 재고가 없습니다.");
+            currentState_ = ControllerState::HANDLING_ERROR;
+            return;
+        }
+    }
+
     domain::Drink tempDrink = getDrinkDetails(currentActiveOrder_->getDrinkCode()); // 임시 변수에 받아 상태 변경 확인
     if (currentState_ == ControllerState::HANDLING_ERROR) return; // getDrinkDetails에서 오류 발생
     pendingDrinkSelection_ = tempDrink;
@@ -693,10 +828,11 @@ void UserProcessController::state_handlingError(const service::ErrorInfo& errorI
 
 void UserProcessController::onReqStockReceived(const network::Message& msg) { // UC17
     std::lock_guard<std::mutex> lock(mtx_); // 공유 자원 접근 보호
-    if (msg.msg_content.count("item_code")) { // (S) UC17.1
-        std::string requestedDrinkCode = msg.msg_content.at("item_code");
+    const auto* request = msg.contentAs<network::StockRequest>();
+    if (request && !request->item_code.empty()) { // (S) UC17.1
+        const std::string& requestedDrinkCode = request->item_code;
         auto availabilityInfo = inventoryService_.checkDrinkAvailabilityAndPrice(requestedDrinkCode); // (S) UC17.2
-        messageService_.sendStockResponse(msg.src_id, requestedDrinkCode, availabilityInfo.currentStock); // (S) UC17.3
+        messageService_.sendStockResponse(msg.src_id, requestedDrinkCode, availabilityInfo.currentStock, msg.corr_id); // (S) UC17.3
     } else { // UC17 E1
         last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "REQ_STOCK (item_code 누락 from " + msg.src_id + ")");
         currentState_ = ControllerState::HANDLING_ERROR; // 메인 스레드가 처리하도록 상태 변경
@@ -705,30 +841,49 @@ void UserProcessController::onReqStockReceived(const network::Message& msg) { //
     }
 }
 
-void UserProcessController::onRespStockReceived(const network::Message& msg) { // UC9
+void UserProcessController::onRespStockReceived(const network::Message& msg, std::uint64_t generation) { // UC9
     std::lock_guard<std::mutex> lock(mtx_);
+    if (generation != transactionGeneration_) return; // 이전 거래의 요청에 대한 응답
 
     try {
-        std::string drinkCode = msg.msg_content.at("item_code");
-        int stockQty = std::stoi(msg.msg_content.at("item_num"));
-        int x = std::stoi(msg.msg_content.at("coor_x"));
-        int y = std::stoi(msg.msg_content.at("coor_y"));
+        const auto* response = msg.contentAs<network::StockResponse>();
+        if (!response) {
+            throw std::invalid_argument("msg_content가 RESP_STOCK 형식이 아닙니다.");
+        }
+        const std::string& drinkCode = response->item_code;
+        int stockQty = response->item_num;
+        int x = response->coor_x;
+        int y = response->coor_y;
         std::string vmId = msg.src_id;
 
-        if (pendingDrinkSelection_ && pendingDrinkSelection_->getDrinkCode() == drinkCode && stockQty > 0) { // (A) UC9.1
-            bool alreadyReceived = false;
-            for(const auto& ovm : availableOtherVmsForDrink_) if(ovm.id == vmId) alreadyReceived = true;
-            if(alreadyReceived) return;
-        
+        // 응답받은 좌표와 재고 여부를 공간 색인에 반영 (좌표가 범위를 벗어난 응답은 색인하지 않음)
+        if (x >= 0 && x < DistanceService::COORD_LIMIT && y >= 0 && y < DistanceService::COORD_LIMIT) {
+            distanceService_.upsertMachine(vmId, x, y);
+            distanceService_.setStock(vmId, drinkCode, stockQty > 0);
+        }
+
+        if (currentState_ != ControllerState::AWAITING_STOCK_RESPONSES ||
+            !pendingDrinkSelection_ || pendingDrinkSelection_->getDrinkCode() != drinkCode) {
+            return; // 이미 조회가 끝났거나 다른 음료에 대한 응답
+        }
+        // 재고가 없다는 응답도 기록해, 재고 없는 자판기 때문에 타임아웃까지 기다리지 않게 함
+        const bool hasStock = stockQty > 0;
+        if (!stockQuery_.recordResponse({vmId, x, y, hasStock})) {
+            return; // 같은 자판기의 중복 응답
+        }
+        if (hasStock) { // (A) UC9.1
             availableOtherVmsForDrink_.push_back({vmId, x, y, true});
-            if (availableOtherVmsForDrink_.size() >= total_other_vms_) {
-                response_timer_.cancel(); // 모든 응답 수신, 타이머 취소
-                currentState_ = ControllerState::DISPLAYING_OTHER_VM_OPTIONS; // (S) UC9.2 -> UC10
-                cv_data_ready_ = true;
-                cv_.notify_one();
-            }else{
-                userInterface_.displayMessage("[" + vmId + "] " + drinkCode + " 재고: " + std::to_string(stockQty) + "개 (총 " + std::to_string(availableOtherVmsForDrink_.size()) + "/" + std::to_string(total_other_vms_) + ")");
-            }
+        }
+
+        if (stockQuery_.isComplete()) { // 정책상 결과가 더 나아질 수 없음
+            response_timer_.cancel();
+            messageService_.cancelRequest(pendingRequestCorrId_); // 이후 도착하는 응답은 MessageService에서 버림
+            pendingRequestCorrId_.clear();
+            currentState_ = ControllerState::DISPLAYING_OTHER_VM_OPTIONS; // (S) UC9.2 -> UC10
+            cv_data_ready_ = true;
+            cv_.notify_one();
+        } else if (hasStock) {
+            userInterface_.displayMessage("[" + vmId + "] " + drinkCode + " 재고: " + std::to_string(stockQty) + "개 (응답 " + std::to_string(stockQuery_.responseCount()) + "/" + std::to_string(stockQuery_.totalPeers()) + ")");
         }
     } catch (const std::exception& e) { // UC9 E1
         last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "RESP_STOCK 처리 오류 (from " + msg.src_id + "): " + e.what());
@@ -741,36 +896,30 @@ void UserProcessController::onRespStockReceived(const network::Message& msg) { /
 void UserProcessController::onReqPrepayReceived(const network::Message& msg) { // UC15
     std::lock_guard<std::mutex> lock(mtx_);
     try { // (S) UC15.1
-        std::string drinkCode = msg.msg_content.at("item_code");
-        std::string certCode = msg.msg_content.at("cert_code");
+        const auto* request = msg.contentAs<network::PrepayRequest>();
+        if (!request) {
+            throw std::invalid_argument("msg_content가 REQ_PREPAY 형식이 아닙니다.");
+        }
+        const std::string& drinkCode = request->item_code;
+        const std::string& certCode = request->cert_code;
         std::string requestingVmId = msg.src_id;
-        int requestedItemNum = 1;
-        if (msg.msg_content.count("item_num")) {
-            try {
-                requestedItemNum = std::stoi(msg.msg_content.at("item_num"));
-                if (requestedItemNum <= 0 || requestedItemNum > 99) {
-                    last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "REQ_PREPAY (잘못된 item_num from " + msg.src_id + ")");
-                    currentState_ = ControllerState::HANDLING_ERROR; // 또는 직접 실패 응답 전송
-                    cv_data_ready_ = true; cv_.notify_one();
-                    messageService_.sendPrepaymentReservationResponse(requestingVmId, drinkCode, 0, false);
-                    return;
-                }
-            } catch (const std::exception&) {
-                last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "REQ_PREPAY (item_num 파싱 오류 from " + msg.src_id + ")");
-                currentState_ = ControllerState::HANDLING_ERROR;
-                cv_data_ready_ = true; cv_.notify_one();
-                messageService_.sendPrepaymentReservationResponse(requestingVmId, drinkCode, 0, false);
-                return;
-            }
+        int requestedItemNum = request->item_num; // 누락 시 1 (직렬화 단계에서 정수로 변환됨)
+        if (requestedItemNum <= 0 || requestedItemNum > 99) {
+            last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "REQ_PREPAY (잘못된 item_num from " + msg.src_id + ")");
+            currentState_ = ControllerState::HANDLING_ERROR; // 또는 직접 실패 응답 전송
+            cv_data_ready_ = true; cv_.notify_one();
+            messageService_.sendPrepaymentReservationResponse(requestingVmId, drinkCode, 0, false, msg.corr_id);
+            return;
         }
         bool reservationSuccess = false;
         auto availabilityInfo = inventoryService_.checkDrinkAvailabilityAndPrice(drinkCode);
-        if (availabilityInfo.isAvailable && availabilityInfo.currentStock >= requestedItemNum) { // (S) UC15.2
-            inventoryService_.decreaseStockByAmount(drinkCode, requestedItemNum);
+        // 재고를 바로 없애지 않고 인증 코드로 홀드. 구매자가 유지 시간 안에 오지 않으면 재고로 되돌아감 (S) UC15.2
+        if (availabilityInfo.isAvailable && availabilityInfo.currentStock >= requestedItemNum &&
+            inventoryService_.holdStock(certCode, drinkCode, requestedItemNum)) {
             prepaymentService_.recordIncomingPrepayment(certCode, drinkCode, requestingVmId);
             reservationSuccess = true;
         } else { /* (A1) UC15 */ }
-        messageService_.sendPrepaymentReservationResponse(requestingVmId, drinkCode, (reservationSuccess ? requestedItemNum : 0), reservationSuccess); // (S) UC15.3
+        messageService_.sendPrepaymentReservationResponse(requestingVmId, drinkCode, (reservationSuccess ? requestedItemNum : 0), reservationSuccess, msg.corr_id); // (S) UC15.3
     } catch (const std::exception& e) {
         last_error_info_ = errorService_.processOccurredError(ErrorType::INVALID_MESSAGE_FORMAT, "REQ_PREPAY 처리 오류 (from " + msg.src_id + "): " + e.what());
         currentState_ = ControllerState::HANDLING_ERROR;
@@ -778,21 +927,25 @@ void UserProcessController::onReqPrepayReceived(const network::Message& msg) { /
     }
 }
 
-void UserProcessController::onRespPrepayReceived(const network::Message& msg) { // UC16
+void UserProcessController::onRespPrepayReceived(const network::Message& msg, std::uint64_t generation) { // UC16
     std::lock_guard<std::mutex> lock(mtx_);
+    if (generation != transactionGeneration_) return; // 이전 거래의 요청에 대한 응답
     if (currentState_ != ControllerState::ISSUING_AUTH_CODE_AND_REQUESTING_RESERVATION) return;
     response_timer_.cancel(); // 응답 수신, 타이머 취소
 
     try {
-        std::string receivedDrinkCode = msg.msg_content.at("item_code");
-        std::string availability = msg.msg_content.at("availability");
+        const auto* response = msg.contentAs<network::PrepayResponse>();
+        if (!response) {
+            throw std::invalid_argument("msg_content가 RESP_PREPAY 형식이 아닙니다.");
+        }
+        const std::string& receivedDrinkCode = response->item_code;
 
         if (pendingDrinkSelection_ && pendingDrinkSelection_->getDrinkCode() == receivedDrinkCode &&
             currentActiveOrder_ && !currentActiveOrder_->getCertCode().empty() &&
             selectedTargetVmForPrepayment_ && selectedTargetVmForPrepayment_->getId() == msg.src_id) {
-            if (availability == "T") { // (S) UC16.2
+            if (response->availability) { // (S) UC16.2
                 currentState_ = ControllerState::DISPLAYING_AUTH_CODE_INFO; // UC12로
-            } else { // (E1) UC16
+            } else if (!retryPrepaymentWithNextCandidate(msg.src_id + " 재고 확보 실패")) { // (E1) UC16
                 last_error_info_ = errorService_.processOccurredError(ErrorType::STOCK_RESERVATION_FAILED_AT_OTHER_VM, msg.src_id);
                 currentState_ = ControllerState::HANDLING_ERROR;
             }
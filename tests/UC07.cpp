@@ -2,9 +2,11 @@
 #include <iostream>
 #include <string>
 #include <memory>
+#include <type_traits>
 
 // Domain
 #include "domain/drink.h"
+#include "domain/drinkCatalog.h"
 #include "domain/order.h"
 #include "domain/inventory.h"
 
@@ -90,4 +92,34 @@ TEST(UC07Test, StockReductionLogic) {
     EXPECT_FALSE(afterAllDecrease.isAvailable);
     
     std::cout << "✓ UC07.4 완료: 재고 차감 로직 검증" << std::endl;
-}
\ No newline at end of file
+}
+// 테스트 5: 배출할 음료 정보 조회 (컴파일 시간 카탈로그와 코드 색인, 복사 없는 목록)
+TEST(UC07Test, DrinkCatalogLookupByCode) {
+    static_assert(drinkCatalogIndex("01") == 0, "리터럴 코드는 컴파일 시간에 인덱스로 바뀜");
+    static_assert(DRINK_CATALOG[drinkCatalogIndex("18")].nameView() == "아메리카노", "");
+    static_assert(drinkCatalogIndex("21") == -1 && drinkCatalogIndex("1") == -1, "");
+    static_assert(!std::is_constructible_v<Drink, std::string, std::string, int>,
+                  "임시 문자열로 만들면 뷰가 해제된 메모리를 가리키므로 막음");
+
+    DrinkRepository drinkRepo;
+    DrinkSpan allDrinks = drinkRepo.findAll();
+    ASSERT_EQ(allDrinks.size(), 20u);
+    EXPECT_EQ(allDrinks.begin(), DrinkRepository().findAll().begin()); // 매번 같은 카탈로그를 가리킴
+
+    for (const Drink& drink : allDrinks) {
+        EXPECT_EQ(&drinkRepo.findByDrinkCode(drink.getDrinkCode()), &drink);
+    }
+    EXPECT_EQ(drinkRepo.findByDrinkCode("18").getName(), "아메리카노");
+
+    EXPECT_EQ(drinkRepo.tryFindByDrinkCode("00"), nullptr);
+    EXPECT_EQ(drinkRepo.tryFindByDrinkCode("99"), nullptr);
+    EXPECT_EQ(drinkRepo.tryFindByDrinkCode("1"), nullptr);
+    EXPECT_EQ(drinkRepo.tryFindByDrinkCode("0a"), nullptr);
+    EXPECT_THROW(drinkRepo.findByDrinkCode("21"), std::runtime_error);
+
+    InventoryRepository inventoryRepo;
+    ErrorService errorService;
+    InventoryService inventoryService(inventoryRepo, drinkRepo, errorService);
+    EXPECT_EQ(inventoryService.findDrinkType("05"), &drinkRepo.findByDrinkCode("05"));
+    EXPECT_FALSE(inventoryService.checkDrinkAvailabilityAndPrice("42").isAvailable);
+}
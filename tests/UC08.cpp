@@ -127,8 +127,9 @@ public:
         messageService_->registerMessageHandler(Message::Type::REQ_STOCK,
             [this](const Message& msg) {
                 std::cout << "[" << vmId_ << "] REQ_STOCK 수신: " << msg.src_id << std::endl;
-                if (msg.msg_content.count("item_code")) {
-                    std::string drinkCode = msg.msg_content.at("item_code");
+                const auto* request = msg.contentAs<network::StockRequest>();
+                if (request && !request->item_code.empty()) {
+                    const std::string& drinkCode = request->item_code;
                     auto availability = inventoryService_->checkDrinkAvailabilityAndPrice(drinkCode);
                     messageService_->sendStockResponse(msg.src_id, drinkCode, availability.currentStock);
                     std::cout << "[" << vmId_ << "] RESP_STOCK 전송: " << msg.src_id << " (재고: " << availability.currentStock << ")" << std::endl;
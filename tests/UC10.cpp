@@ -1,10 +1,25 @@
 #include <gtest/gtest.h>
 #include "domain/vendingMachine.h"
+#include "service/DistanceKernel.hpp"
 #include "service/DistanceService.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "service/PeerStockCache.hpp"
+#include "service/StockQueryTracker.hpp"
+
 using domain::VendingMachine;
 using service::OtherVendingMachineInfo;
+using service::DistanceKernel;
 using service::DistanceService;
+using service::PeerStockCache;
+using service::StockQueryOptions;
+using service::StockQueryPolicy;
+using service::StockQueryTracker;
 
 TEST(SystemTest, BroadcastAndFindNearestVendingMachine) {
     // 1. 현재 자판기(t1) 정보
@@ -26,4 +41,197 @@ TEST(SystemTest, BroadcastAndFindNearestVendingMachine) {
     // 4. 사용자 안내 메시지(예상 결과)
     EXPECT_EQ(nearest.getId(), "T3");
     EXPECT_EQ(nearest.getLocation(), std::make_pair(5, 5));
-}
\ No newline at end of file
+}
+
+TEST(SystemTest, StockQueryCompletesWhenNearestCannotImprove) {
+    // 현재 자판기 (0,0), 다른 자판기 T2(3,4) 거리 5, T3(6,8) 거리 10, T4(30,40) 거리 50
+    StockQueryOptions options;
+    options.policy = StockQueryPolicy::NEAREST_POSSIBLE;
+    options.knownPeers = {{"T2", 3, 4}, {"T3", 6, 8}, {"T4", 30, 40}};
+    StockQueryTracker tracker(options, 0, 0, 3);
+
+    // 먼 T3가 먼저 재고 있음 응답: 더 가까운 T2가 남아 있으므로 계속 대기
+    EXPECT_TRUE(tracker.recordResponse({"T3", 6, 8, true}));
+    EXPECT_FALSE(tracker.isComplete());
+
+    // T2는 재고 없음: 남은 T4는 T3보다 멀어 답이 바뀔 수 없으므로 종료
+    EXPECT_TRUE(tracker.recordResponse({"T2", 3, 4, false}));
+    EXPECT_TRUE(tracker.isComplete());
+
+    // 같은 자판기의 중복 응답은 세지 않음
+    EXPECT_FALSE(tracker.recordResponse({"T2", 3, 4, false}));
+    EXPECT_EQ(tracker.responseCount(), 2u);
+}
+
+TEST(SystemTest, StockQueryPoliciesFirstQuorumAndAll) {
+    StockQueryOptions options;
+    options.policy = StockQueryPolicy::FIRST;
+    StockQueryTracker first(options, 0, 0, 3);
+    first.recordResponse({"T2", 3, 4, false});
+    EXPECT_FALSE(first.isComplete()); // 재고 없는 응답만으로는 끝나지 않음
+    first.recordResponse({"T3", 6, 8, true});
+    EXPECT_TRUE(first.isComplete());
+
+    options.policy = StockQueryPolicy::QUORUM;
+    options.quorum = 2;
+    StockQueryTracker quorum(options, 0, 0, 3);
+    quorum.recordResponse({"T3", 6, 8, true});
+    EXPECT_FALSE(quorum.isComplete());
+    quorum.recordResponse({"T2", 3, 4, false});
+    EXPECT_TRUE(quorum.isComplete());
+
+    // ALL: 재고가 없더라도 모든 자판기가 응답하면 타임아웃 전에 끝남
+    options.policy = StockQueryPolicy::ALL;
+    StockQueryTracker all(options, 0, 0, 2);
+    all.recordResponse({"T2", 3, 4, true});
+    EXPECT_FALSE(all.isComplete());
+    all.recordResponse({"T3", 6, 8, false});
+    EXPECT_TRUE(all.isComplete());
+
+    // 좌표를 모르는 자판기가 남아 있으면 NEAREST_POSSIBLE도 기다림
+    options.policy = StockQueryPolicy::NEAREST_POSSIBLE;
+    options.knownPeers = {{"T2", 3, 4}};
+    StockQueryTracker nearest(options, 0, 0, 2);
+    nearest.recordResponse({"T2", 3, 4, true});
+    EXPECT_FALSE(nearest.isComplete());
+    all.reset();
+    EXPECT_EQ(all.responseCount(), 0u);
+}
+
+TEST(SystemTest, PeerStockCacheAnswersWithinStalenessBound) {
+    PeerStockCache cache;
+    const auto now = PeerStockCache::Clock::now();
+    cache.update("T2", "07", 3, 3, 4, now - std::chrono::milliseconds(1000));
+    cache.update("T3", "07", 0, 6, 8, now - std::chrono::milliseconds(1000));
+    cache.update("T4", "07", 5, 30, 40, now - std::chrono::milliseconds(20000)); // 오래된 값
+
+    auto fresh = cache.freshEntries("07", std::chrono::milliseconds(5000), now);
+    ASSERT_EQ(fresh.size(), 2u);
+    EXPECT_EQ(fresh[0].id, "T2");
+    EXPECT_TRUE(fresh[0].hasStock);
+    EXPECT_FALSE(fresh[1].hasStock);
+
+    // 캐시 값으로 조회 정책이 만족되는지 판단 (T4는 T2보다 멀어 기다릴 필요 없음)
+    StockQueryOptions options;
+    options.policy = StockQueryPolicy::NEAREST_POSSIBLE;
+    options.knownPeers = {{"T2", 3, 4}, {"T3", 6, 8}, {"T4", 30, 40}};
+    StockQueryTracker tracker(options, 0, 0, 3);
+    for (const auto& entry : fresh) tracker.recordResponse(entry);
+    EXPECT_TRUE(tracker.isComplete());
+
+    // 선결제 예약 성공은 재고를 줄이고, 실패는 그 자판기 기록을 지움
+    cache.applyReservation("T2", "07", 3, true);
+    fresh = cache.freshEntries("07", std::chrono::milliseconds(5000), now);
+    ASSERT_EQ(fresh.size(), 2u);
+    EXPECT_FALSE(fresh[0].hasStock);
+    cache.applyReservation("T3", "07", 1, false);
+    EXPECT_EQ(cache.freshEntries("07", std::chrono::milliseconds(5000), now).size(), 1u);
+
+    // 더 오래된 값으로는 덮어쓰지 않음
+    cache.update("T2", "07", 9, 3, 4, now - std::chrono::milliseconds(3000));
+    EXPECT_FALSE(cache.freshEntries("07", std::chrono::milliseconds(5000), now)[0].hasStock);
+}
+
+TEST(SystemTest, SpatialIndexMatchesBruteForceNearest) {
+    DistanceService distanceService;
+    std::mt19937 rng(16);
+    std::uniform_int_distribution<int> coord(0, 99);
+
+    // 자판기 2000대 중 약 1/3에 "07" 재고
+    struct Machine { std::string id; int x; int y; bool stock; };
+    std::vector<Machine> machines;
+    for (int i = 1; i <= 2000; ++i) {
+        Machine m{"T" + std::to_string(i), coord(rng), coord(rng), i % 3 == 0};
+        distanceService.upsertMachine(m.id, m.x, m.y);
+        distanceService.setStock(m.id, "07", m.stock);
+        machines.push_back(m);
+    }
+    // 일부 자판기는 옮기거나 제거
+    for (int i = 0; i < 100; ++i) {
+        Machine& m = machines[static_cast<std::size_t>(i * 7)];
+        m.x = coord(rng);
+        m.y = coord(rng);
+        distanceService.upsertMachine(m.id, m.x, m.y);
+    }
+    for (int i = 0; i < 50; ++i) {
+        distanceService.removeMachine(machines[static_cast<std::size_t>(i * 11 + 1)].id);
+        machines[static_cast<std::size_t>(i * 11 + 1)].stock = false;
+    }
+    EXPECT_EQ(distanceService.indexedMachineCount(), 1950u);
+
+    for (int q = 0; q < 50; ++q) {
+        const int x = coord(rng);
+        const int y = coord(rng);
+        std::vector<std::tuple<int, int, std::string>> expected; // (거리 제곱, ID 숫자, ID)
+        for (const Machine& m : machines) {
+            if (m.stock) {
+                expected.emplace_back((m.x - x) * (m.x - x) + (m.y - y) * (m.y - y), std::stoi(m.id.substr(1)), m.id);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        const auto nearest = distanceService.findNearestWithStock(x, y, "07", 5);
+        ASSERT_EQ(nearest.size(), 5u);
+        for (std::size_t i = 0; i < nearest.size(); ++i) {
+            EXPECT_EQ(nearest[i].getId(), std::get<2>(expected[i]));
+        }
+    }
+
+    // 재고 없는 음료, 잘못된 음료 코드, 범위를 벗어난 좌표
+    EXPECT_TRUE(distanceService.findNearestWithStock(50, 50, "08", 3).empty());
+    EXPECT_FALSE(distanceService.setStock("T3", "abc", true));
+    EXPECT_THROW(distanceService.upsertMachine("T9999", 100, 0), std::invalid_argument);
+}
+
+TEST(SystemTest, NearestPrefersSmallerNumericIdOnTieWithoutThrowing) {
+    DistanceService distanceService;
+    std::vector<OtherVendingMachineInfo> responses = {
+        {"T12", 3, 4, true}, {"T2", 4, 3, true}, {"X1", 0, 5, true}, {"T1", 0, 1, false}};
+    auto nearest = distanceService.findNearestAvailableVendingMachine(0, 0, responses);
+    ASSERT_TRUE(nearest.has_value());
+    EXPECT_EQ(nearest->getId(), "T2"); // 거리 5로 같으면 ID 숫자가 작은 T2, 재고 없는 T1은 제외
+}
+
+TEST(SystemTest, RankedAlternativesForPrepaymentRetry) {
+    DistanceService distanceService;
+    std::vector<OtherVendingMachineInfo> responses = {
+        {"T5", 50, 50, true}, {"T3", 5, 5, true}, {"T4", 0, 2, false},
+        {"T2", 10, 10, true}, {"T7", 3, 4, true}, {"T1x", 4, 3, true}};
+
+    // 가까운 순 상위 3대: T7(거리 5) -> T1x(거리 5, 숫자 ID가 아니므로 뒤) -> T3
+    auto ranked = distanceService.rankNearestAvailableVendingMachines(0, 0, responses, 3);
+    ASSERT_EQ(ranked.size(), 3u);
+    EXPECT_EQ(ranked[0].getId(), "T7");
+    EXPECT_EQ(ranked[1].getId(), "T1x");
+    EXPECT_EQ(ranked[2].getId(), "T3");
+    EXPECT_EQ(ranked[0].getId(), distanceService.findNearestAvailableVendingMachine(0, 0, responses)->getId());
+
+    // k가 후보 수보다 크면 재고 있는 자판기 전부, 재고 없는 T4는 제외
+    EXPECT_EQ(distanceService.rankNearestAvailableVendingMachines(0, 0, responses, 10).size(), 5u);
+    EXPECT_TRUE(distanceService.rankNearestAvailableVendingMachines(0, 0, {}, 3).empty());
+}
+
+TEST(SystemTest, DistanceKernelMatchesScalarForEveryIsa) {
+    std::mt19937 rng(18);
+    std::uniform_int_distribution<std::int32_t> coord(-DistanceKernel::COORD_BOUND, DistanceKernel::COORD_BOUND);
+    for (std::size_t n : {std::size_t{0}, std::size_t{1}, std::size_t{7}, std::size_t{8}, std::size_t{13}, std::size_t{1001}}) {
+        std::vector<std::int32_t> xs(n), ys(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            xs[i] = coord(rng);
+            ys[i] = coord(rng);
+        }
+        const std::int32_t qx = coord(rng), qy = coord(rng);
+        std::vector<std::uint32_t> expected(n), actual(n);
+        DistanceKernel::squaredDistances(DistanceKernel::Isa::SCALAR, xs.data(), ys.data(), n, qx, qy, expected.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::int64_t dx = static_cast<std::int64_t>(xs[i]) - qx, dy = static_cast<std::int64_t>(ys[i]) - qy;
+            ASSERT_EQ(expected[i], static_cast<std::uint32_t>(dx * dx + dy * dy));
+        }
+        // 지원하지 않는 구현은 스칼라로 계산되므로 모든 구현이 같은 결과여야 함
+        for (auto isa : {DistanceKernel::Isa::SSE41, DistanceKernel::Isa::AVX2}) {
+            std::fill(actual.begin(), actual.end(), 0u);
+            DistanceKernel::squaredDistances(isa, xs.data(), ys.data(), n, qx, qy, actual.data());
+            EXPECT_EQ(actual, expected) << DistanceKernel::isaName(isa) << " n=" << n;
+        }
+    }
+}
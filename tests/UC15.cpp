@@ -7,6 +7,9 @@
 #include "persistence/DrinkRepository.hpp"
 #include "persistence/prepayCodeRepository.h"
 #include "persistence/OrderRepository.hpp"
+#include "persistence/OvmAddressRepository.hpp"
+#include "persistence/DurableStore.hpp"
+#include "persistence/WriteAheadLog.hpp"
 
 #include "service/ErrorService.hpp"
 #include "service/InventoryService.hpp"
@@ -17,8 +20,16 @@
 #include "network/MessageReceiver.hpp"
 
 #include <boost/asio/io_context.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 using domain::Order;
 using domain::Inventory;
@@ -60,9 +71,11 @@ TEST(UC15Test, AcceptPrepaymentRequestWithSufficientStock) {
     prepayRequest.msg_type = network::Message::Type::REQ_PREPAY;
     prepayRequest.src_id = "T1";
     prepayRequest.dst_id = "T2";
-    prepayRequest.msg_content["item_code"] = "02"; // 사이다
-    prepayRequest.msg_content["item_num"] = "1";
-    prepayRequest.msg_content["cert_code"] = "ABC12";
+    network::PrepayRequest prepayContent;
+    prepayContent.item_code = "02"; // 사이다
+    prepayContent.item_num = 1;
+    prepayContent.cert_code = "ABC12";
+    prepayRequest.setContent(prepayContent);
     
     std::cout << "T1에서 T2로 선결제 요청: 사이다(02), 인증코드 ABC12" << std::endl;
     
@@ -130,9 +143,11 @@ TEST(UC15Test, RejectPrepaymentRequestWithInsufficientStock) {
     prepayRequest.msg_type = network::Message::Type::REQ_PREPAY;
     prepayRequest.src_id = "T3";
     prepayRequest.dst_id = "T1";
-    prepayRequest.msg_content["item_code"] = "02"; // 사이다
-    prepayRequest.msg_content["item_num"] = "1";
-    prepayRequest.msg_content["cert_code"] = "XYZ99";
+    network::PrepayRequest prepayContent;
+    prepayContent.item_code = "02"; // 사이다
+    prepayContent.item_num = 1;
+    prepayContent.cert_code = "XYZ99";
+    prepayRequest.setContent(prepayContent);
     
     std::cout << "T3에서 T1로 선결제 요청: 사이다(02), 인증코드 XYZ99" << std::endl;
     
@@ -159,4 +174,467 @@ TEST(UC15Test, RejectPrepaymentRequestWithInsufficientStock) {
     EXPECT_TRUE(savedPrepay.getCode().empty()); // 저장되지 않음
     
     std::cout << "✓ 테스트 2 완료: 재고 부족으로 선결제 요청 거절, 재고 및 데이터 변경 없음" << std::endl;
-}
\ No newline at end of file
+}
+// 테스트 3: 여러 스레드의 동시 선결제 요청이 재고보다 많이 차감하지 않는지 테스트
+TEST(UC15Test, ConcurrentReservationsNeverOversell) {
+    persistence::InventoryRepository inventoryRepo;
+    inventoryRepo.addOrUpdateStock(Inventory("01", 150)); // 최대 99개로 제한됨
+    EXPECT_EQ(inventoryRepo.quantityOf("01"), 99);
+    EXPECT_FALSE(inventoryRepo.quantityOf("02").has_value()); // 취급하지 않는 음료
+    EXPECT_THROW(inventoryRepo.addOrUpdateStock(Inventory("1", 3)), std::invalid_argument);
+
+    std::atomic<int> reserved{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([&inventoryRepo, &reserved, t]() {
+            for (int i = 0; i < 200; ++i) {
+                const int amount = 1 + (t + i) % 3;
+                if (inventoryRepo.decreaseStockByAmount("01", amount)) {
+                    reserved += amount;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const int remaining = inventoryRepo.quantityOf("01").value();
+    EXPECT_GE(remaining, 0);
+    EXPECT_LT(remaining, 3); // 남은 수량으로는 더 이상 어떤 요청도 채울 수 없을 때까지 차감됨
+    EXPECT_EQ(reserved.load() + remaining, 99);
+    EXPECT_FALSE(inventoryRepo.decreaseStockByAmount("02", 1));
+}
+
+// 테스트 4: 선결제 홀드는 확정·취소·만료에 따라 재고를 유지하거나 되돌림
+TEST(UC15Test, PrepaymentHoldsCommitReleaseAndExpire) {
+    using Clock = service::InventoryService::Clock;
+    persistence::InventoryRepository inventoryRepo;
+    persistence::DrinkRepository drinkRepo;
+    service::ErrorService errorService;
+    service::InventoryService inventoryService(inventoryRepo, drinkRepo, errorService, std::chrono::seconds(30));
+    inventoryRepo.addOrUpdateStock(Inventory("01", 10));
+
+    const Clock::time_point t0 = Clock::now();
+    ASSERT_TRUE(inventoryService.holdStock("AAAA1", "01", 3, t0));
+    ASSERT_TRUE(inventoryService.holdStock("BBBB2", "01", 2, t0));
+    ASSERT_TRUE(inventoryService.holdStock("CCCC3", "01", 4, t0 + std::chrono::seconds(20)));
+    EXPECT_FALSE(inventoryService.holdStock("DDDD4", "01", 2, t0)); // 가용 재고 1개
+    EXPECT_FALSE(inventoryService.holdStock("AAAA1", "01", 1, t0)); // 같은 인증 코드로 중복 홀드 불가
+    EXPECT_EQ(inventoryRepo.quantityOf("01"), 1);                   // 보유 10 - 홀드 9
+    EXPECT_EQ(inventoryService.heldStock("01"), 9);
+
+    EXPECT_TRUE(inventoryService.commitHold("AAAA1"));  // 구매자가 찾아감: 재고는 그대로 빠진 상태
+    EXPECT_TRUE(inventoryService.releaseHold("BBBB2")); // 취소: 재고로 되돌아감
+    EXPECT_FALSE(inventoryService.commitHold("BBBB2"));
+    EXPECT_EQ(inventoryRepo.quantityOf("01"), 3);
+
+    EXPECT_EQ(inventoryService.reapExpiredHolds(t0 + std::chrono::seconds(31)), 0u); // CCCC3은 50초에 만료
+    EXPECT_EQ(inventoryService.reapExpiredHolds(t0 + std::chrono::seconds(52)), 1u);
+    EXPECT_EQ(inventoryRepo.quantityOf("01"), 7);
+    EXPECT_EQ(inventoryService.heldStock("01"), 0);
+    EXPECT_FALSE(inventoryService.commitHold("CCCC3")); // 만료된 홀드는 확정할 수 없음
+    auto expired = inventoryService.takeExpiredHold("CCCC3"); // 늦게 온 구매자에게 다시 차감할 수량
+    ASSERT_TRUE(expired.has_value());
+    EXPECT_EQ(expired->amount, 4);
+    EXPECT_FALSE(inventoryService.takeExpiredHold("CCCC3").has_value());
+
+    ASSERT_TRUE(inventoryService.holdStock("EEEE5", "01", 1, t0 + std::chrono::seconds(52)));
+    EXPECT_EQ(inventoryService.reapExpiredHolds(t0 + std::chrono::seconds(83)), 1u);
+    EXPECT_EQ(inventoryService.reapExpiredHolds(t0 + std::chrono::seconds(113)), 0u);
+    EXPECT_FALSE(inventoryService.takeExpiredHold("EEEE5").has_value()); // 만료 후 유지 시간이 지나면 잊음
+}
+
+// 테스트 5: 타이머 휠 한 바퀴보다 먼 만료와, 여러 바퀴를 건너뛴 뒤의 일괄 만료
+TEST(UC15Test, HoldTimerWheelHandlesLongExpiriesAndLargeGaps) {
+    using Clock = service::StockHoldTable::Clock;
+    const Clock::time_point origin = Clock::now();
+    service::StockHoldTable table(std::chrono::seconds(1), 8, origin); // 8초에 한 바퀴
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(table.add("H" + std::to_string(i), "02", 1, origin + std::chrono::seconds(1 + i % 20)));
+    }
+    EXPECT_EQ(table.heldQuantity("02"), 100);
+
+    std::size_t reaped = 0;
+    for (int sec = 1; sec <= 20; ++sec) {
+        const auto expired = table.reapExpired(origin + std::chrono::seconds(sec));
+        for (const auto& hold : expired) {
+            EXPECT_LE(hold.expiresAt, origin + std::chrono::seconds(sec));
+        }
+        reaped += expired.size();
+        EXPECT_EQ(reaped, static_cast<std::size_t>(sec * 5)); // 매초 5개씩 만료
+    }
+    EXPECT_EQ(table.size(), 0u);
+
+    ASSERT_TRUE(table.add("late", "02", 2, origin + std::chrono::seconds(30)));
+    ASSERT_TRUE(table.add("gone", "02", 1, origin + std::chrono::seconds(25)));
+    EXPECT_TRUE(table.remove("gone").has_value());
+    EXPECT_TRUE(table.reapExpired(origin + std::chrono::seconds(29)).empty());
+    EXPECT_EQ(table.reapExpired(origin + std::chrono::seconds(100)).size(), 1u); // 여러 바퀴를 건너뜀
+    EXPECT_EQ(table.heldQuantity("02"), 0);
+}
+
+// 테스트 6: 로그와 스냅샷으로 재시작 후 재고, 주문, 선결제 코드를 복원하고 쓰다 만 로그 꼬리는 버림
+TEST(UC15Test, RepositoriesRecoverFromWriteAheadLog) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / ("uc15_wal_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(dir);
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 4);
+        EXPECT_FALSE(store.recover()); // 처음 시작
+
+        inventoryRepo.addOrUpdateStock(Inventory("01", 10));
+        inventoryRepo.addOrUpdateStock(Inventory("02", 5));
+        ASSERT_TRUE(inventoryRepo.decreaseStockByAmount("01", 3));
+        EXPECT_FALSE(inventoryRepo.decreaseStockByAmount("02", 6)); // 실패한 변경은 로그에 남지 않음
+        ovmRepo.save(domain::VendingMachine("T2", 10, 20, "12346"));
+        auto held = std::make_shared<Order>("T1", "01", 1, "ABCD1", "APPROVED");
+        prepayRepo.save(PrePaymentCode("ABCD1", domain::CodeStatus::ACTIVE, held)); // 5번째 레코드에서 스냅샷
+        orderRepo.save(Order("T1", "02", 1, "", "PENDING"));
+        EXPECT_TRUE(orderRepo.updateStatus("T1", "02", "", "APPROVED"));
+        prepayRepo.updateStatus("ABCD1", domain::CodeStatus::USED);
+        ASSERT_TRUE(inventoryRepo.increaseStockByAmount("02", 2));
+    }
+    EXPECT_TRUE(fs::exists(dir / "snapshot.bin"));
+
+    // 마지막 레코드를 쓰다 멈춘 것처럼 로그 끝에 불완전한 프레임을 붙임
+    {
+        std::ofstream tail(dir / "wal.log", std::ios::binary | std::ios::app);
+        tail.write("\x20\x00\x00\x00\x01\x02", 6);
+    }
+    const auto tornSize = fs::file_size(dir / "wal.log");
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 4);
+        EXPECT_TRUE(store.recover());
+        EXPECT_EQ(fs::file_size(dir / "wal.log"), tornSize - 6);
+
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 7);
+        EXPECT_EQ(inventoryRepo.quantityOf("02"), 7);
+        EXPECT_FALSE(inventoryRepo.quantityOf("03").has_value());
+        EXPECT_EQ(ovmRepo.findById("T2").getLocation(), std::make_pair(10, 20));
+        EXPECT_EQ(orderRepo.findAll().size(), 1u);
+        EXPECT_EQ(orderRepo.findAll().front().getPayStatus(), "APPROVED");
+        const PrePaymentCode code = prepayRepo.findByCode("ABCD1");
+        EXPECT_EQ(code.getStatus(), domain::CodeStatus::USED);
+        ASSERT_NE(code.getHeldOrder(), nullptr);
+        EXPECT_EQ(code.getHeldOrder()->getCertCode(), "ABCD1");
+
+        // 복원 뒤 이어 쓴 변경과 수동 스냅샷
+        ASSERT_TRUE(inventoryRepo.decreaseStockByAmount("01", 1));
+        store.checkpoint();
+        EXPECT_EQ(fs::file_size(dir / "wal.log"), 0u);
+        ASSERT_TRUE(inventoryRepo.decreaseStockByAmount("01", 1));
+    }
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 4);
+        EXPECT_TRUE(store.recover());
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 5);
+        EXPECT_EQ(orderRepo.findAll().size(), 1u);
+    }
+    fs::remove_all(dir);
+}
+
+// 테스트 7: 선결제 홀드는 로그에 남아 재시작 후에도 확정·만료되고, 재고가 두 번 빠지지 않음
+TEST(UC15Test, PrepaymentHoldsSurviveRestart) {
+    namespace fs = std::filesystem;
+    using Clock = service::InventoryService::Clock;
+    const fs::path dir = fs::temp_directory_path() / ("uc15_holds_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(dir);
+    persistence::DrinkRepository drinkRepo;
+    service::ErrorService errorService;
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 3);
+        store.recover();
+        service::InventoryService inventoryService(inventoryRepo, drinkRepo, errorService, std::chrono::seconds(30));
+        inventoryRepo.addOrUpdateStock(Inventory("01", 10));
+        ASSERT_TRUE(inventoryService.holdStock("AAAA1", "01", 3));
+        ASSERT_TRUE(inventoryService.holdStock("BBBB2", "01", 2)); // 여기서 스냅샷: 홀드가 스냅샷에 들어감
+        ASSERT_TRUE(inventoryService.holdStock("CCCC3", "01", 1)); // 로그 꼬리
+        ASSERT_TRUE(inventoryService.releaseHold("BBBB2"));
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 6);
+    }
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 3);
+        ASSERT_TRUE(store.recover());
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 6); // 홀드 수량은 한 번만 빠져 있음
+        EXPECT_EQ(inventoryRepo.findAllHolds().size(), 2u);
+
+        service::InventoryService inventoryService(inventoryRepo, drinkRepo, errorService, std::chrono::seconds(30));
+        const Clock::time_point now = Clock::now();
+        EXPECT_EQ(inventoryService.restoreHolds(now), 2u);
+        EXPECT_EQ(inventoryService.heldStock("01"), 4);
+        EXPECT_TRUE(inventoryService.commitHold("AAAA1")); // 재시작 전에 잡은 홀드를 확정: 다시 차감하지 않음
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 6);
+        EXPECT_EQ(inventoryService.reapExpiredHolds(now + std::chrono::seconds(32)), 1u); // CCCC3 만료
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 7);
+        EXPECT_TRUE(inventoryRepo.findAllHolds().empty());
+    }
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()));
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 3);
+        ASSERT_TRUE(store.recover());
+        EXPECT_EQ(inventoryRepo.quantityOf("01"), 7);
+        EXPECT_TRUE(inventoryRepo.findAllHolds().empty());
+    }
+    fs::remove_all(dir);
+}
+
+// 테스트 8: 같은 레코드가 로그에 두 번 쓰였어도 (실패한 묶음을 다시 쓴 경우) 재생은 한 번만 적용함
+TEST(UC15Test, WriteAheadLogReplaySkipsRepeatedRecords) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / ("uc15_wal_dup_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(dir);
+    {
+        persistence::WriteAheadLog log(dir.string(), 0);
+        log.replay([](std::string_view) {});
+        for (const char* record : {"a", "b", "c"}) {
+            ASSERT_TRUE(log.commit([record]() { return std::string(record); }));
+        }
+    }
+    // 로그 전체를 한 번 더 이어 붙여 순번이 되돌아가게 함
+    std::string bytes;
+    {
+        std::ifstream in(dir / "wal.log", std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(dir / "wal.log", std::ios::binary | std::ios::app);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    persistence::WriteAheadLog log(dir.string(), 0);
+    std::vector<std::string> replayed;
+    EXPECT_EQ(log.replay([&replayed](std::string_view record) { replayed.emplace_back(record); }), 3u);
+    EXPECT_EQ(replayed, (std::vector<std::string>{"a", "b", "c"}));
+    EXPECT_TRUE(log.commit([]() { return std::string("d"); }));
+    fs::remove_all(dir);
+}
+
+// 테스트 9: 주문 저장소는 최근 구간만 메모리에 남기고, 내려놓은 구간의 주문도 조회·갱신됨
+TEST(UC15Test, OrderLogKeepsOnlyRecentSegmentsResident) {
+    persistence::OrderRepository orderRepo("", 1);
+    const std::size_t total = persistence::OrderLog::SEGMENT_RECORDS * 3 + 10;
+    for (std::size_t i = 0; i < total; ++i) {
+        const std::string certCode = "C" + std::to_string(i);
+        orderRepo.save(Order("T" + std::to_string(1 + i % 7), "0" + std::to_string(i % 10), 1, certCode, "PENDING"));
+    }
+    orderRepo.save(Order("T9", "05", 1, "", "PENDING")); // 인증 코드 없는 주문
+    EXPECT_EQ(orderRepo.size(), total + 1);
+    EXPECT_EQ(orderRepo.storage().residentSegments(), 1u);
+
+    const Order oldest = orderRepo.findByCertCode("C0"); // 내려놓은 첫 구간
+    EXPECT_EQ(oldest.getVmid(), "T1");
+    EXPECT_EQ(oldest.getDrinkCode(), "00");
+    EXPECT_EQ(oldest.getPayStatus(), "PENDING");
+    EXPECT_TRUE(orderRepo.findByCertCode("NONE").getCertCode().empty());
+
+    EXPECT_TRUE(orderRepo.updateStatus("", "", "C1", "APPROVED"));
+    EXPECT_EQ(orderRepo.findByCertCode("C1").getPayStatus(), "APPROVED");
+    EXPECT_TRUE(orderRepo.updateStatus("T9", "05", "", "DECLINED"));
+    EXPECT_FALSE(orderRepo.updateStatus("T9", "05", "", "DECLINED")); // 더 이상 PENDING 주문 없음
+    EXPECT_FALSE(orderRepo.updateStatus("T42", "05", "", "APPROVED")); // 한 번도 저장되지 않은 자판기
+
+    orderRepo.save(Order("T3", "07", 2, "C2", "APPROVED")); // 같은 인증 코드는 덮어씀
+    EXPECT_EQ(orderRepo.size(), total + 1);
+    EXPECT_EQ(orderRepo.findByCertCode("C2").getQty(), 2);
+    EXPECT_THROW(orderRepo.save(Order("T1", "01", 1, std::string(30, 'X'), "PENDING")), std::length_error);
+
+    const std::vector<Order> all = orderRepo.findAll();
+    ASSERT_EQ(all.size(), total + 1);
+    EXPECT_EQ(all[2].getDrinkCode(), "07");
+    EXPECT_EQ(all.back().getPayStatus(), "DECLINED");
+}
+
+// 테스트 10: 인증 코드 색인과 (자판기, 음료)별 PENDING 색인이 덮어쓰기와 상태 변경을 따라감
+TEST(UC15Test, OrderIndexesFollowOverwritesAndStatusChanges) {
+    persistence::OrderRepository orderRepo;
+    EXPECT_FALSE(orderRepo.updateStatus("T1", "01", "", "APPROVED")); // 주문 없음
+    EXPECT_TRUE(orderRepo.findByCertCode("").getVmid().empty());
+
+    orderRepo.save(Order("T1", "01", 1, "AAAA1", "PENDING"));
+    orderRepo.save(Order("T1", "01", 1, "", "PENDING"));
+    orderRepo.save(Order("T1", "01", 1, "BBBB2", "PENDING"));
+    orderRepo.save(Order("T1", "02", 1, "", "APPROVED"));
+    EXPECT_EQ(orderRepo.findByCertCode("").getDrinkCode(), "01"); // 인증 코드 없는 가장 오래된 주문
+
+    // 가장 오래된 PENDING 주문부터 갱신
+    EXPECT_TRUE(orderRepo.updateStatus("T1", "01", "", "APPROVED"));
+    EXPECT_EQ(orderRepo.findByCertCode("AAAA1").getPayStatus(), "APPROVED");
+
+    // 인증 코드로 상태를 바꾸면 PENDING 색인에서도 빠짐
+    EXPECT_TRUE(orderRepo.updateStatus("", "", "BBBB2", "DECLINED"));
+    EXPECT_TRUE(orderRepo.updateStatus("T1", "01", "", "APPROVED")); // 인증 코드 없는 주문
+    EXPECT_FALSE(orderRepo.updateStatus("T1", "01", "", "APPROVED"));
+
+    // 덮어쓰기로 음료와 상태가 바뀌면 색인도 옮겨감
+    orderRepo.save(Order("T1", "03", 1, "AAAA1", "PENDING"));
+    EXPECT_FALSE(orderRepo.updateStatus("T1", "01", "", "APPROVED"));
+    EXPECT_TRUE(orderRepo.updateStatus("T1", "03", "", "APPROVED"));
+    EXPECT_EQ(orderRepo.findByCertCode("AAAA1").getPayStatus(), "APPROVED");
+    EXPECT_EQ(orderRepo.size(), 4u);
+}
+
+// 테스트 11: 여러 스레드가 동시에 저장해도 구간을 늘리는 중의 레코드와 색인이 깨지지 않음
+TEST(UC15Test, OrderRepositoryAcceptsConcurrentSaves) {
+    persistence::OrderRepository orderRepo("", 1);
+    constexpr int threads = 4;
+    const int perThread = static_cast<int>(persistence::OrderLog::SEGMENT_RECORDS); // 모두 합쳐 구간 4개
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&orderRepo, t, perThread]() {
+            for (int i = 0; i < perThread; ++i) {
+                orderRepo.save(Order("T" + std::to_string(t), "01", 1, "C" + std::to_string(t) + "_" + std::to_string(i), "PENDING"));
+                orderRepo.findByCertCode("C" + std::to_string(t) + "_" + std::to_string(i / 2));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    EXPECT_EQ(orderRepo.size(), static_cast<std::size_t>(threads * perThread));
+    for (int t = 0; t < threads; ++t) {
+        EXPECT_EQ(orderRepo.findByCertCode("C" + std::to_string(t) + "_" + std::to_string(perThread - 1)).getVmid(),
+                  "T" + std::to_string(t));
+    }
+}
+
+// 테스트 12: 스냅샷에는 주문 이력 대신 주문 파일 길이만 남고, 재시작 후 파일에서 주문과 색인을 되살림
+TEST(UC15Test, OrderHistoryStaysOutOfSnapshot) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / ("uc15_orders_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(dir);
+    const std::size_t total = persistence::OrderLog::SEGMENT_RECORDS + 10;
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo;
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        EXPECT_THROW(persistence::DurableStore(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo),
+                     std::invalid_argument); // 작업용 파일에 저장하는 주문 리포지토리는 받지 않음
+    }
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()), 1);
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 1u << 20);
+        store.recover();
+        orderRepo.save(Order("T1", "01", 1, "", "PENDING"));
+        orderRepo.save(Order("T1", "01", 2, "", "PENDING"));
+        for (std::size_t i = 2; i < total; ++i) {
+            orderRepo.save(Order("T2", "02", 1, "C" + std::to_string(i), "PENDING"));
+        }
+        store.checkpoint();
+        EXPECT_LT(fs::file_size(dir / "snapshot.bin"), 256u); // 주문 수와 관계없음
+
+        // 스냅샷 이후의 변경은 로그 꼬리로 남음 (주문 파일에도 이미 반영됨)
+        EXPECT_TRUE(orderRepo.updateStatus("T1", "01", "", "APPROVED"));
+        orderRepo.save(Order("T3", "03", 1, "LAST", "PENDING"));
+    }
+
+    {
+        persistence::InventoryRepository inventoryRepo;
+        persistence::OrderRepository orderRepo(persistence::DurableStore::orderStoragePath(dir.string()), 1);
+        persistence::PrepayCodeRepository prepayRepo;
+        persistence::OvmAddressRepository ovmRepo;
+        persistence::DurableStore store(dir.string(), inventoryRepo, orderRepo, prepayRepo, ovmRepo, 1u << 20);
+        ASSERT_TRUE(store.recover());
+        EXPECT_EQ(orderRepo.size(), total + 1);
+        EXPECT_EQ(orderRepo.storage().residentSegments(), 1u);
+        EXPECT_EQ(orderRepo.findByCertCode("C2").getVmid(), "T2");
+        EXPECT_EQ(orderRepo.findByCertCode("LAST").getDrinkCode(), "03");
+
+        // 다시 적용한 상태 변경이 두 번째 PENDING 주문을 건드리지 않았고, PENDING 색인도 되살아남
+        EXPECT_TRUE(orderRepo.updateStatus("T1", "01", "", "DECLINED"));
+        EXPECT_FALSE(orderRepo.updateStatus("T1", "01", "", "DECLINED"));
+        const std::vector<Order> all = orderRepo.findAll();
+        EXPECT_EQ(all[0].getPayStatus(), "APPROVED");
+        EXPECT_EQ(all[1].getPayStatus(), "DECLINED");
+        EXPECT_EQ(all[1].getQty(), 2);
+    }
+    fs::remove_all(dir);
+}
+
+// 테스트 13: 로그를 쓸 수 없어도 이미 반영한 변경은 실패로 보고하지 않고, 실패 처리기로 알린 뒤 재시도함
+TEST(UC15Test, WriteAheadLogReportsWriteFailuresWithoutThrowing) {
+    namespace fs = std::filesystem;
+    if (!fs::exists("/dev/full")) {
+        GTEST_SKIP() << "/dev/full 없음";
+    }
+    const fs::path dir = fs::temp_directory_path() / ("uc15_wal_full_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::create_symlink("/dev/full", dir / "wal.log"); // 모든 쓰기가 ENOSPC로 실패
+
+    std::atomic<int> failures{0};
+    {
+        persistence::WriteAheadLog log(dir.string(), 0);
+        log.setFailureHandler([&failures](const std::string&) { ++failures; });
+        bool applied = false;
+        bool logged = false;
+        EXPECT_NO_THROW(logged = log.commit([&applied]() {
+            applied = true;
+            return std::string("a");
+        }));
+        EXPECT_TRUE(applied);
+        EXPECT_TRUE(logged);
+        EXPECT_GE(failures.load(), 1);
+
+        const int reported = failures.load();
+        std::this_thread::sleep_for(persistence::WriteAheadLog::RETRY_INTERVAL * 3 / 2);
+        EXPECT_GT(failures.load(), reported); // 다음 commit이 없어도 백그라운드에서 다시 씀
+    } // 재시도 스레드를 멈추고 소멸
+    fs::remove_all(dir);
+}
+
+// 테스트 14: 경로 없는 주문 저장소는 작업 디렉터리를 쓰지 않고, 임시 디렉터리를 쓸 수 없어도 만들어짐
+TEST(UC15Test, ScratchOrderStorageNeedsNoWritableDirectory) {
+    const char* previous = std::getenv("TMPDIR");
+    const std::string saved = previous ? previous : "";
+    ::setenv("TMPDIR", "/nonexistent/uc15", 1);
+    {
+        persistence::OrderRepository orderRepo("", 1);
+        for (std::size_t i = 0; i < persistence::OrderLog::SEGMENT_RECORDS + 1; ++i) {
+            orderRepo.save(Order("T1", "01", 1, "M" + std::to_string(i), "PENDING"));
+        }
+        EXPECT_EQ(orderRepo.findByCertCode("M0").getVmid(), "T1");
+        EXPECT_FALSE(orderRepo.hasDurableStorage());
+    }
+    if (previous) {
+        ::setenv("TMPDIR", saved.c_str(), 1);
+    } else {
+        ::unsetenv("TMPDIR");
+    }
+}
@@ -11,8 +11,10 @@
 #include "service/ErrorService.hpp"
 #include "service/InventoryService.hpp"
 #include "service/DistanceService.hpp"
+#include "service/InFlightRequestTable.hpp"
 #include "network/message.hpp"
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -43,21 +45,25 @@ TEST(UC16Test, CreatePrepaymentReservationRequest) {
     reservationRequest.msg_type = network::Message::Type::REQ_PREPAY;
     reservationRequest.src_id = "T1";
     reservationRequest.dst_id = targetVmId;
-    reservationRequest.msg_content["item_code"] = drinkCode;
-    reservationRequest.msg_content["item_num"] = "1";
-    reservationRequest.msg_content["cert_code"] = authCode;
+    network::PrepayRequest reservationContent;
+    reservationContent.item_code = drinkCode;
+    reservationContent.item_num = 1;
+    reservationContent.cert_code = authCode;
+    reservationRequest.setContent(reservationContent);
     
     // 메시지 내용 검증
     EXPECT_EQ(reservationRequest.msg_type, network::Message::Type::REQ_PREPAY);
     EXPECT_EQ(reservationRequest.src_id, "T1");
     EXPECT_EQ(reservationRequest.dst_id, "T2");
-    EXPECT_EQ(reservationRequest.msg_content.at("item_code"), "02");
-    EXPECT_EQ(reservationRequest.msg_content.at("item_num"), "1");
-    EXPECT_EQ(reservationRequest.msg_content.at("cert_code"), "ABC12");
+    const auto* content = reservationRequest.contentAs<network::PrepayRequest>();
+    ASSERT_NE(content, nullptr);
+    EXPECT_EQ(content->item_code, "02");
+    EXPECT_EQ(content->item_num, 1);
+    EXPECT_EQ(content->cert_code, "ABC12");
     
     std::cout << "재고 확보 요청 메시지: " << reservationRequest.src_id 
               << " -> " << reservationRequest.dst_id 
-              << " (음료: " << reservationRequest.msg_content.at("item_code") << ")" << std::endl;
+              << " (음료: " << content->item_code << ")" << std::endl;
     std::cout << "✓ 테스트 1 완료: REQ_PREPAY 메시지 생성 성공" << std::endl;
 }
 
@@ -87,15 +93,17 @@ TEST(UC16Test, SendMultiplePrepaymentRequests) {
         request.msg_type = network::Message::Type::REQ_PREPAY;
         request.src_id = "T1";
         request.dst_id = targetVm;
-        request.msg_content["item_code"] = drinkCode;
-        request.msg_content["item_num"] = "1";
-        request.msg_content["cert_code"] = authCode;
+        network::PrepayRequest content;
+        content.item_code = drinkCode;
+        content.item_num = 1;
+        content.cert_code = authCode;
+        request.setContent(content);
         
         requests.push_back(request);
         
         // 개별 메시지 검증
         EXPECT_EQ(request.dst_id, targetVm);
-        EXPECT_EQ(request.msg_content.at("item_code"), drinkCode);
+        EXPECT_EQ(request.contentAs<network::PrepayRequest>()->item_code, drinkCode);
         
         std::cout << "요청 생성: T1 -> " << targetVm << " (콜라 1개)" << std::endl;
     }
@@ -104,3 +112,68 @@ TEST(UC16Test, SendMultiplePrepaymentRequests) {
     std::cout << "✓ 테스트 3 완료: 여러 자판기에 대한 재고 확보 요청 생성" << std::endl;
 }
 
+
+// 테스트 4: corr_id로 선결제 응답을 요청에 연결하고, 중복/늦은 응답은 버리는지 테스트
+TEST(UC16Test, RouteReservationResponseByCorrelationId) {
+    std::cout << "=== UC16 테스트: corr_id로 재고 확보 응답 연결 ===" << std::endl;
+
+    service::InFlightRequestTable table;
+    int delivered = 0;
+    std::string corrId = table.insert(network::Message::Type::RESP_PREPAY, "01", "T2", 1, std::chrono::seconds(10),
+                                      [&delivered](const network::Message&) { ++delivered; });
+    ASSERT_FALSE(corrId.empty());
+
+    network::Message response;
+    response.src_id = "T2";
+    response.dst_id = "T1";
+    response.corr_id = corrId;
+    response.setContent(network::PrepayResponse{"01", 1, true});
+
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::DELIVERED);
+    // 단일 대상 요청은 첫 응답으로 끝나므로 같은 응답이 다시 오면 늦은 응답으로 버려짐
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::STALE);
+    EXPECT_EQ(delivered, 1);
+
+    // 취소된 요청(이전 거래)에 대한 응답도 버려짐
+    std::string cancelledId = table.insert(network::Message::Type::RESP_PREPAY, "01", "T2", 1, std::chrono::seconds(10),
+                                           [&delivered](const network::Message&) { ++delivered; });
+    table.cancel(cancelledId);
+    response.corr_id = cancelledId;
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::STALE);
+    EXPECT_EQ(delivered, 1);
+    std::cout << "✓ 테스트 4 완료: 응답 연결 및 늦은 응답 제거" << std::endl;
+}
+
+// 테스트 5: corr_id를 돌려주지 않는 자판기의 응답과 브로드캐스트 중복 응답 처리
+TEST(UC16Test, FallbackMatchingAndDuplicateResponses) {
+    std::cout << "=== UC16 테스트: corr_id 없는 응답 연결 및 중복 제거 ===" << std::endl;
+
+    service::InFlightRequestTable table;
+    std::vector<std::string> responders;
+    table.insert(network::Message::Type::RESP_STOCK, "01", "0", 3, std::chrono::seconds(3),
+                 [&responders](const network::Message& msg) { responders.push_back(msg.src_id); });
+
+    network::Message response;
+    response.dst_id = "T1";
+    response.setContent(network::StockResponse{"01", 5, 10, 20});
+
+    response.src_id = "T2";
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::DELIVERED);
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::DUPLICATE);
+
+    // 다른 음료에 대한 응답은 어떤 요청과도 연결되지 않음
+    network::Message otherDrink = response;
+    otherDrink.src_id = "T3";
+    otherDrink.setContent(network::StockResponse{"02", 5, 10, 20});
+    EXPECT_EQ(table.route(otherDrink), service::InFlightRequestTable::RouteResult::UNMATCHED);
+
+    response.src_id = "T3";
+    EXPECT_EQ(table.route(response), service::InFlightRequestTable::RouteResult::DELIVERED);
+    EXPECT_EQ(responders, (std::vector<std::string>{"T2", "T3"}));
+
+    const auto stats = table.stats();
+    EXPECT_EQ(stats.delivered, 2u);
+    EXPECT_EQ(stats.duplicates, 1u);
+    EXPECT_EQ(stats.unmatched, 1u);
+    std::cout << "✓ 테스트 5 완료: corr_id 없는 응답 연결 및 중복 제거" << std::endl;
+}
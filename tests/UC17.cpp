@@ -41,21 +41,24 @@ TEST(UC17Test, ReceiveStockInquiryAndCheckInventory) {
     stockRequest.msg_type = network::Message::Type::REQ_STOCK;
     stockRequest.src_id = "T1";
     stockRequest.dst_id = "T2";
-    stockRequest.msg_content["item_code"] = "02"; // 사이다 조회
-    stockRequest.msg_content["item_num"] = "1";
+    network::StockRequest requestContent;
+    requestContent.item_code = "02"; // 사이다 조회
+    requestContent.item_num = 1;
+    stockRequest.setContent(requestContent);
     
     std::cout << "수신된 재고 조회 요청: " << stockRequest.src_id 
               << " -> " << stockRequest.dst_id 
-              << ", 음료코드: " << stockRequest.msg_content.at("item_code") << std::endl;
+              << ", 음료코드: " << stockRequest.contentAs<network::StockRequest>()->item_code << std::endl;
     
     // 요청 메시지 검증
     EXPECT_EQ(stockRequest.msg_type, network::Message::Type::REQ_STOCK);
     EXPECT_EQ(stockRequest.src_id, "T1");
     EXPECT_EQ(stockRequest.dst_id, "T2");
-    EXPECT_EQ(stockRequest.msg_content.at("item_code"), "02");
+    ASSERT_NE(stockRequest.contentAs<network::StockRequest>(), nullptr);
+    EXPECT_EQ(stockRequest.contentAs<network::StockRequest>()->item_code, "02");
     
     // 재고 확인 처리
-    std::string requestedDrinkCode = stockRequest.msg_content.at("item_code");
+    std::string requestedDrinkCode = stockRequest.contentAs<network::StockRequest>()->item_code;
     auto availability = inventoryService.checkDrinkAvailabilityAndPrice(requestedDrinkCode);
     
     EXPECT_EQ(requestedDrinkCode, "02");
@@ -95,25 +98,29 @@ TEST(UC17Test, GenerateStockInquiryResponse) {
     stockResponse.msg_type = network::Message::Type::RESP_STOCK;
     stockResponse.src_id = "T3";
     stockResponse.dst_id = requestingVmId;
-    stockResponse.msg_content["item_code"] = requestedDrinkCode;
-    stockResponse.msg_content["item_num"] = std::to_string(availability.currentStock);
-    stockResponse.msg_content["coor_x"] = "10";  // T3 좌표 (10, 30)
-    stockResponse.msg_content["coor_y"] = "30";
+    network::StockResponse responseContent;
+    responseContent.item_code = requestedDrinkCode;
+    responseContent.item_num = availability.currentStock;
+    responseContent.coor_x = 10;  // T3 좌표 (10, 30)
+    responseContent.coor_y = 30;
+    stockResponse.setContent(responseContent);
     
     // 응답 메시지 검증
+    const auto* content = stockResponse.contentAs<network::StockResponse>();
+    ASSERT_NE(content, nullptr);
     EXPECT_EQ(stockResponse.msg_type, network::Message::Type::RESP_STOCK);
     EXPECT_EQ(stockResponse.src_id, "T3");
     EXPECT_EQ(stockResponse.dst_id, "T1");
-    EXPECT_EQ(stockResponse.msg_content.at("item_code"), "01");
-    EXPECT_EQ(std::stoi(stockResponse.msg_content.at("item_num")), 3);
-    EXPECT_EQ(stockResponse.msg_content.at("coor_x"), "10");
-    EXPECT_EQ(stockResponse.msg_content.at("coor_y"), "30");
+    EXPECT_EQ(content->item_code, "01");
+    EXPECT_EQ(content->item_num, 3);
+    EXPECT_EQ(content->coor_x, 10);
+    EXPECT_EQ(content->coor_y, 30);
     
     std::cout << "생성된 응답 메시지: " << stockResponse.src_id 
               << " -> " << stockResponse.dst_id 
-              << ", 콜라 재고: " << stockResponse.msg_content.at("item_num") << "개" << std::endl;
-    std::cout << "좌표 정보: (" << stockResponse.msg_content.at("coor_x") 
-              << ", " << stockResponse.msg_content.at("coor_y") << ")" << std::endl;
+              << ", 콜라 재고: " << content->item_num << "개" << std::endl;
+    std::cout << "좌표 정보: (" << content->coor_x 
+              << ", " << content->coor_y << ")" << std::endl;
     std::cout << "✓ 테스트 2 완료: RESP_STOCK 응답 메시지 생성 성공" << std::endl;
 }
 
@@ -139,13 +146,15 @@ TEST(UC17Test, HandleOutOfStockInquiry) {
     stockRequest.msg_type = network::Message::Type::REQ_STOCK;
     stockRequest.src_id = "T5";
     stockRequest.dst_id = "T1";
-    stockRequest.msg_content["item_code"] = "02"; // 사이다 (재고 없음)
-    stockRequest.msg_content["item_num"] = "1";
+    network::StockRequest requestContent;
+    requestContent.item_code = "02"; // 사이다 (재고 없음)
+    requestContent.item_num = 1;
+    stockRequest.setContent(requestContent);
     
     std::cout << "재고 조회 요청: T5 -> T1, 사이다 재고 문의" << std::endl;
     
     // 재고 확인
-    std::string requestedDrinkCode = stockRequest.msg_content.at("item_code");
+    std::string requestedDrinkCode = stockRequest.contentAs<network::StockRequest>()->item_code;
     auto availability = inventoryService.checkDrinkAvailabilityAndPrice(requestedDrinkCode);
     
     EXPECT_FALSE(availability.isAvailable);
@@ -156,16 +165,20 @@ TEST(UC17Test, HandleOutOfStockInquiry) {
     stockResponse.msg_type = network::Message::Type::RESP_STOCK;
     stockResponse.src_id = "T1";
     stockResponse.dst_id = "T5";
-    stockResponse.msg_content["item_code"] = requestedDrinkCode;
-    stockResponse.msg_content["item_num"] = "0"; // 재고 없음
-    stockResponse.msg_content["coor_x"] = "10";  // T1 좌표 (10, 10)
-    stockResponse.msg_content["coor_y"] = "10";
+    network::StockResponse responseContent;
+    responseContent.item_code = requestedDrinkCode;
+    responseContent.item_num = 0; // 재고 없음
+    responseContent.coor_x = 10;  // T1 좌표 (10, 10)
+    responseContent.coor_y = 10;
+    stockResponse.setContent(responseContent);
     
     // 응답 검증
-    EXPECT_EQ(std::stoi(stockResponse.msg_content.at("item_num")), 0);
-    EXPECT_EQ(stockResponse.msg_content.at("item_code"), "02");
+    const auto* content = stockResponse.contentAs<network::StockResponse>();
+    ASSERT_NE(content, nullptr);
+    EXPECT_EQ(content->item_num, 0);
+    EXPECT_EQ(content->item_code, "02");
     
-    std::cout << "응답 메시지: 사이다 재고 " << stockResponse.msg_content.at("item_num") << "개 (재고 없음)" << std::endl;
+    std::cout << "응답 메시지: 사이다 재고 " << content->item_num << "개 (재고 없음)" << std::endl;
     std::cout << "✓ 테스트 3 완료: 재고 없는 음료에 대한 응답 처리" << std::endl;
 }
 
@@ -212,10 +225,12 @@ TEST(UC17Test, HandleMultipleStockInquiries) {
         response.msg_type = network::Message::Type::RESP_STOCK;
         response.src_id = "T2";
         response.dst_id = requestingVm;
-        response.msg_content["item_code"] = drinkCode;
-        response.msg_content["item_num"] = std::to_string(availability.currentStock);
-        response.msg_content["coor_x"] = "20";
-        response.msg_content["coor_y"] = "20";
+        network::StockResponse content;
+        content.item_code = drinkCode;
+        content.item_num = availability.currentStock;
+        content.coor_x = 20;
+        content.coor_y = 20;
+        response.setContent(content);
         
         responses.push_back(response);
         
@@ -224,10 +239,10 @@ TEST(UC17Test, HandleMultipleStockInquiries) {
     
     // 응답 검증
     EXPECT_EQ(responses.size(), 4);
-    EXPECT_EQ(std::stoi(responses[0].msg_content.at("item_num")), 12); // 사이다
-    EXPECT_EQ(std::stoi(responses[1].msg_content.at("item_num")), 8);  // 캔커피
-    EXPECT_EQ(std::stoi(responses[2].msg_content.at("item_num")), 0);  // 콜라 (재고 없음)
-    EXPECT_EQ(std::stoi(responses[3].msg_content.at("item_num")), 15); // 물
+    EXPECT_EQ(responses[0].contentAs<network::StockResponse>()->item_num, 12); // 사이다
+    EXPECT_EQ(responses[1].contentAs<network::StockResponse>()->item_num, 8);  // 캔커피
+    EXPECT_EQ(responses[2].contentAs<network::StockResponse>()->item_num, 0);  // 콜라 (재고 없음)
+    EXPECT_EQ(responses[3].contentAs<network::StockResponse>()->item_num, 15); // 물
     
     std::cout << "✓ 테스트 4 완료: 여러 음료에 대한 연속 재고 조회 처리" << std::endl;
 }
@@ -249,15 +264,15 @@ TEST(UC17Test, HandleInvalidStockInquiry) {
     invalidRequest1.msg_type = network::Message::Type::REQ_STOCK;
     invalidRequest1.src_id = "T1";
     invalidRequest1.dst_id = "T3";
-    // item_code가 없음
-    invalidRequest1.msg_content["item_num"] = "1";
-    
-    bool processSuccess1 = false;
-    try {
-        std::string drinkCode = invalidRequest1.msg_content.at("item_code"); // 예외 발생 예상
-        processSuccess1 = true;
-    } catch (const std::exception& e) {
-        std::cout << "잘못된 요청 1 (item_code 누락): 예외 발생 - " << e.what() << std::endl;
+    // item_code가 없음 (수신 시 빈 문자열로 채워짐)
+    network::StockRequest invalidContent1;
+    invalidContent1.item_num = 1;
+    invalidRequest1.setContent(invalidContent1);
+    
+    const auto* invalidRequestContent1 = invalidRequest1.contentAs<network::StockRequest>();
+    bool processSuccess1 = invalidRequestContent1 && !invalidRequestContent1->item_code.empty();
+    if (!processSuccess1) {
+        std::cout << "잘못된 요청 1 (item_code 누락): 요청 거부" << std::endl;
     }
     EXPECT_FALSE(processSuccess1);
     
@@ -266,10 +281,12 @@ TEST(UC17Test, HandleInvalidStockInquiry) {
     invalidRequest2.msg_type = network::Message::Type::REQ_STOCK;
     invalidRequest2.src_id = "T2";
     invalidRequest2.dst_id = "T3";
-    invalidRequest2.msg_content["item_code"] = "99"; // 존재하지 않는 음료
-    invalidRequest2.msg_content["item_num"] = "1";
+    network::StockRequest invalidContent2;
+    invalidContent2.item_code = "99"; // 존재하지 않는 음료
+    invalidContent2.item_num = 1;
+    invalidRequest2.setContent(invalidContent2);
     
-    std::string invalidDrinkCode = invalidRequest2.msg_content.at("item_code");
+    std::string invalidDrinkCode = invalidRequest2.contentAs<network::StockRequest>()->item_code;
     auto invalidAvailability = inventoryService.checkDrinkAvailabilityAndPrice(invalidDrinkCode);
     
     // 존재하지 않는 음료는 가격이 0이고 재고도 0
@@ -284,12 +301,14 @@ TEST(UC17Test, HandleInvalidStockInquiry) {
     validRequest.msg_type = network::Message::Type::REQ_STOCK;
     validRequest.src_id = "T4";
     validRequest.dst_id = "T3";
-    validRequest.msg_content["item_code"] = "01"; // 콜라
-    validRequest.msg_content["item_num"] = "1";
+    network::StockRequest validContent;
+    validContent.item_code = "01"; // 콜라
+    validContent.item_num = 1;
+    validRequest.setContent(validContent);
     
     bool validProcessSuccess = false;
     try {
-        std::string validDrinkCode = validRequest.msg_content.at("item_code");
+        std::string validDrinkCode = validRequest.contentAs<network::StockRequest>()->item_code;
         auto validAvailability = inventoryService.checkDrinkAvailabilityAndPrice(validDrinkCode);
         validProcessSuccess = true;
         std::cout << "올바른 요청: 콜라 재고 " << validAvailability.currentStock 